@@ -56,7 +56,7 @@ bool Algorithms::isConnected(const Graph& g) {
     4. If the DFS discovers all the vertices, then the graph is connected. otherwise, the graph is not connected.
    */
     // check if the graph is empty
-    if (g.getGraph().empty()) {
+    if (g.getMatrix().empty()) {
         return true;
     }
 
@@ -72,14 +72,14 @@ bool Algorithms::isConnected(const Graph& g) {
 
     // Perform DFS on the root of the last DFS tree (the first element of the last vector in the firstDfsTree matrix
     size_t firstElementOfLastVector = firstDfsTree.back().front();
-    vector<Color> colors(g.getGraph().size(), WHITE);
+    vector<Color> colors(g.getMatrix().size(), WHITE);
     vector<size_t> secondDfsTree = dfs(g, firstElementOfLastVector, &colors);
-    return secondDfsTree.size() == g.getGraph().size();
+    return secondDfsTree.size() == g.getMatrix().size();
 }
 
 string Algorithms::shortestPath(const Graph& g, size_t src, size_t dest) {
     // check for valid source and destination vertices
-    if (src >= g.getGraph().size() || dest >= g.getGraph().size()) {
+    if (src >= g.getMatrix().size() || dest >= g.getMatrix().size()) {
         throw std::invalid_argument("Invalid source or destination vertex");
     }
 
@@ -168,12 +168,12 @@ string Algorithms::isContainsCycle(const Graph& g) {
 
     so we can perform DFS on the graph and check if we discover a back edge.
     */
-    vector<Color> colors(g.getGraph().size(), WHITE);
-    vector<int> parents(g.getGraph().size(), -1);
+    vector<Color> colors(g.getMatrix().size(), WHITE);
+    vector<int> parents(g.getMatrix().size(), -1);
     vector<int> path;  // to store the sequence of vertices visited during the DFS - used to construct the cycle path
 
     // start DFS on the graph
-    for (size_t i = 0; i < g.getGraph().size(); i++) {
+    for (size_t i = 0; i < g.getMatrix().size(); i++) {
         if (colors[i] == WHITE) {
             string cycle = isContainsCycleUtil(g, i, &colors, &parents, &path);
             if (!cycle.empty()) {  // if a cycle is detected
@@ -193,7 +193,7 @@ string Algorithms::isBipartite(const Graph& g) {
 
     if the graph is directed, we will convert it to an undirected graph and then perform the algorithm.
     */
-    if (g.getGraph().empty()) {
+    if (g.getMatrix().empty()) {
         return "The graph is bipartite: A={}, B={}";
     }
 
@@ -218,7 +218,7 @@ string Algorithms::isBipartite(const Graph& g) {
         return isBipartite(undirectedGraph);
     }
 
-    size_t n = g.getGraph().size();
+    size_t n = g.getMatrix().size();
     // create a list of colors for the vertices
     vector<Color> colors(n, WHITE);
 
@@ -236,7 +236,7 @@ string Algorithms::isBipartite(const Graph& g) {
         size_t u = q.front();
         q.pop();
         for (size_t v = 0; v < n; v++) {  // loop over the neighbors of the vertex
-            if (g.getGraph()[u][v] != NO_EDGE) {
+            if (g.getMatrix()[u][v] != NO_EDGE) {
                 if (colors[v] == colors[u]) {  // if the vertex is colored with the same color as its neighbor
                     return "The graph is not bipartite";
                 }
@@ -287,7 +287,7 @@ string Algorithms::negativeCycle(const Graph& g) {
     because in our graph representation, no edges have a weight of 0, in this function we will change the NO_EDGE value to INFINITY.
     */
 
-    size_t n = g.getGraph().size();
+    size_t n = g.getMatrix().size();
 
     // create a new graph with a new vertex
     Graph newGraph = Graph(true);  // we will build a directed graph, and save if g was directed or not
@@ -296,8 +296,8 @@ string Algorithms::negativeCycle(const Graph& g) {
     vector<vector<int>> newGraphMat(n + 1, vector<int>(n + 1, INF));
     for (size_t i = 0; i < n; i++) {
         for (size_t j = 0; j < n; j++) {
-            if (g.getGraph()[i][j] != NO_EDGE) {
-                newGraphMat[i][j] = g.getGraph()[i][j];
+            if (g.getMatrix()[i][j] != NO_EDGE) {
+                newGraphMat[i][j] = g.getMatrix()[i][j];
             }
         }
     }
@@ -334,7 +334,7 @@ string Algorithms::negativeCycle(const Graph& g) {
   @return a list of vertices in the order they were discovered
 */
 vector<vector<size_t>> dfs(const Graph& g) {
-    size_t n = g.getGraph().size();
+    size_t n = g.getMatrix().size();
     // create a list of colors for the vertices
     vector<Color> colors(n, WHITE);
 
@@ -359,7 +359,7 @@ vector<vector<size_t>> dfs(const Graph& g) {
  * @return a list of vertices in the order they were discovered
  */
 vector<size_t> dfs(const Graph& g, size_t src, vector<Color>* colors) {
-    size_t n = g.getGraph().size();
+    size_t n = g.getMatrix().size();
 
     vector<size_t> dfsOrder;
 
@@ -376,7 +376,7 @@ vector<size_t> dfs(const Graph& g, size_t src, vector<Color>* colors) {
             (*colors)[u] = GRAY;
             dfsOrder.push_back(u);
             for (size_t v = 0; v < n; v++) {
-                if (g.getGraph()[u][v] != NO_EDGE) {  // if there is an edge between u and v
+                if (g.getMatrix()[u][v] != NO_EDGE) {  // if there is an edge between u and v
                     if ((*colors)[v] == WHITE) {      // if we didn't discover v yet
                         stack.push_back(v);           // add v to the stack
                     }
@@ -392,7 +392,7 @@ vector<size_t> dfs(const Graph& g, size_t src, vector<Color>* colors) {
 
 // ~ Shortest Path algorithms ~
 pair<vector<int>, vector<int>> bfs(const Graph& g, size_t src) {
-    size_t n = g.getGraph().size();
+    size_t n = g.getMatrix().size();
 
     // init the distances and parents vectors
     vector<int> distances(n, INF);
@@ -407,7 +407,7 @@ pair<vector<int>, vector<int>> bfs(const Graph& g, size_t src) {
         size_t u = q.front();
         q.pop();
         for (size_t v = 0; v < n; v++) {
-            if (g.getGraph()[u][v] != NO_EDGE) {
+            if (g.getMatrix()[u][v] != NO_EDGE) {
                 if (distances[v] == INF) {  // if the vertex is not discovered yet
                     distances[v] = distances[u] + 1;
                     parents[v] = (int)u;
@@ -425,7 +425,7 @@ pair<vector<int>, vector<int>> bellmanFord(const Graph& g, size_t src) {
 }
 
 pair<vector<int>, vector<int>> bellmanFord(const Graph& g, size_t src, bool isDirected) {
-    size_t n = g.getGraph().size();
+    size_t n = g.getMatrix().size();
     vector<int> distances(n, INF);
     vector<int> parents(n, -1);
 
@@ -437,21 +437,21 @@ pair<vector<int>, vector<int>> bellmanFord(const Graph& g, size_t src, bool isDi
         for (size_t u = 0; u < n; u++) {
             for (size_t v = 0; v < n; v++) {
                 // if there is an edge between u and v
-                if (g.getGraph()[u][v] != NO_EDGE) {
+                if (g.getMatrix()[u][v] != NO_EDGE) {
                     // if the graph is undirected, we should ignore the edge that connects the current vertex to its parent
                     if (!isDirected && parents[u] == (int)v) {
-                        if (distances[u] + g.getGraph()[u][v] < distances[v]) {
+                        if (distances[u] + g.getMatrix()[u][v] < distances[v]) {
                         }
                         continue;
                     }
 
                     // relax the edge (u, v)
-                    if (distances[u] == INF || g.getGraph()[u][v] == INF) {
+                    if (distances[u] == INF || g.getMatrix()[u][v] == INF) {
                         continue;
                     }
 
-                    if (distances[u] + g.getGraph()[u][v] < distances[v]) {
-                        distances[v] = distances[u] + g.getGraph()[u][v];
+                    if (distances[u] + g.getMatrix()[u][v] < distances[v]) {
+                        distances[v] = distances[u] + g.getMatrix()[u][v];
                         parents[v] = (int)u;
                         relaxed = true;
                     }
@@ -466,17 +466,17 @@ pair<vector<int>, vector<int>> bellmanFord(const Graph& g, size_t src, bool isDi
     // check for negative-weight cycles
     for (size_t u = 0; u < n; u++) {
         for (size_t v = 0; v < n; v++) {
-            if (g.getGraph()[u][v] != NO_EDGE) {
+            if (g.getMatrix()[u][v] != NO_EDGE) {
                 // if the graph is undirected, we should ignore the edge that connects the current vertex to its parent
                 if (!isDirected && parents[u] == (int)v) {
                     continue;
                 }
 
-                if (distances[u] == INF || g.getGraph()[u][v] == INF) {
+                if (distances[u] == INF || g.getMatrix()[u][v] == INF) {
                     continue;
                 }
 
-                if (distances[u] + g.getGraph()[u][v] < distances[v]) {
+                if (distances[u] + g.getMatrix()[u][v] < distances[v]) {
                     parents[v] = (int)u;
                     throw Algorithms::NegativeCycleException(v, parents);
                 }
@@ -497,7 +497,7 @@ pair<vector<int>, vector<int>> bellmanFord(const Graph& g, size_t src, bool isDi
  *
  */
 pair<vector<int>, vector<int>> dijkstra(const Graph& g, size_t src) {
-    size_t n = g.getGraph().size();
+    size_t n = g.getMatrix().size();
     vector<int> distances(n, INF);
     vector<int> parents(n, -1);
 
@@ -522,9 +522,9 @@ pair<vector<int>, vector<int>> dijkstra(const Graph& g, size_t src) {
 
         // for each neighbor of u
         for (size_t v = 0; v < n; v++) {
-            if (g.getGraph()[u][v] != NO_EDGE) {
+            if (g.getMatrix()[u][v] != NO_EDGE) {
                 // relax the edge
-                int currDist = distances[u] + g.getGraph()[u][v];
+                int currDist = distances[u] + g.getMatrix()[u][v];
                 if (currDist < distances[v]) {
                     distances[v] = currDist;
                     parents[v] = u;
@@ -561,8 +561,8 @@ string isContainsCycleUtil(const Graph& g, size_t src, vector<Color>* colors, ve
     path->push_back(src);  // add the vertex to the path
 
     // loop over all the neighbors of the vertex
-    for (size_t v = 0; v < g.getGraph().size(); v++) {
-        if (g.getGraph()[src][v] != NO_EDGE) {
+    for (size_t v = 0; v < g.getMatrix().size(); v++) {
+        if (g.getMatrix()[src][v] != NO_EDGE) {
             if ((*colors)[v] == WHITE) {
                 // dfs on the neighbor
                 (*parents)[v] = (int)src;
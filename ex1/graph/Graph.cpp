@@ -4,8 +4,13 @@
  */
 #include "Graph.hpp"
 
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
 #include <iostream>
 #include <stdexcept>
+#include <utility>
 
 using namespace shayg;
 
@@ -20,55 +25,114 @@ Graph::Graph(bool isDirected) {
     this->haveNegativeEdgeWeight = false;
 }
 
-void Graph::loadGraph(const vector<vector<int>> &ajdList) {
+namespace {
 
-    // by default, the graph is not weighted and does not have negative edge weight
-    this->isWeighted = false;
-    this->haveNegativeEdgeWeight = false;
+constexpr size_t RELEASE_CHUNK = size_t{16} << 20U;  // give the freed rows back to the system after every 16MB
 
-    this->ajdList = ajdList;
-    /*
-     * update the isWeighted and haveNegativeEdgeWeight fields.
-     * create an deep copy of the adjacency list.
-     */
+/**
+ * @brief give the free memory of the heap back to the system. small blocks (like the rows of a vector<vector<int>>) stay in the heap after
+ * they are freed, so without this the memory of the rows that were moved into the graph is still counted until the end of the program.
+ */
+void releaseFreedMemory() {
+#if defined(__GLIBC__)
+    malloc_trim(0);
+#endif
+}
 
-    // check if the graph is a square matrix
-    // check if the diagonal of the matrix is 0
-    for (size_t i = 0; i < ajdList.size(); i++) {
-        if (ajdList.size() != ajdList[i].size()) {
-            throw invalid_argument("Invalid graph: The graph is not a square matrix.(" + std::to_string(i) + "th row has " + std::to_string(ajdList[i].size()) + " elements.)");
-        }
-        if (ajdList[i][i] != NO_EDGE) {
+}  // namespace
+
+template <typename GetRow, typename ReleaseRow>
+void Graph::loadRows(Matrix mat, GetRow getRow, ReleaseRow releaseRow) {
+    const Matrix &copied = mat;  // the rows that were already checked (read only - a view is not copied)
+    size_t n = mat.size();
+    bool weighted = false;
+    bool negative = false;
+
+    // check every row, copy it and update the isWeighted and haveNegativeEdgeWeight fields - in one pass over the matrix.
+    // the symmetry of row i is checked with the rows before it, that are already in mat
+    for (size_t i = 0; i < n; i++) {
+        const int *row = getRow(i);
+        if (row[i] != NO_EDGE) {
             throw invalid_argument("The diagonal of the matrix must be NO_EDGE. (the " + std::to_string(i) + "th node is not a NO_EDGE)");
         }
+        if (!mat.isView()) {
+            std::copy(row, row + n, mat[i].data());
+        }
 
-    }
-
-    // update the isWeighted and haveNegativeEdgeWeight fields if needed
-    // check if a directed graph is a symmetric matrix
-    for (size_t i = 0; i < ajdList.size(); i++) {
-        for (size_t j = 0; j < ajdList[i].size(); j++) {
-            if (ajdList[i][j] != NO_EDGE) {
-                if (ajdList[i][j] != 1) {
-                    this->isWeighted = true;
+        for (size_t j = 0; j < n; j++) {
+            if (row[j] != NO_EDGE) {
+                if (row[j] != 1) {
+                    weighted = true;
                 }
-                if (ajdList[i][j] < 0) {
-                    this->haveNegativeEdgeWeight = true;
+                if (row[j] < 0) {
+                    negative = true;
                 }
             }
 
-            if (!this->isDirected && ajdList[i][j] != ajdList[j][i]) {
-                throw invalid_argument("Invalid graph: The graph is not symmetric.(mat[" + std::to_string(i) + "][" + std::to_string(j) + "] = " + std::to_string(ajdList[i][j]) + " and mat[" + std::to_string(j) + "][" + std::to_string(i) + "] = " + std::to_string(ajdList[j][i]) + ")");
+            if (!this->isDirected && j < i && row[j] != copied[j][i]) {
+                throw invalid_argument("Invalid graph: The graph is not symmetric.(mat[" + std::to_string(j) + "][" + std::to_string(i) + "] = " + std::to_string(copied[j][i]) + " and mat[" + std::to_string(i) + "][" + std::to_string(j) + "] = " + std::to_string(row[j]) + ")");
             }
         }
+        releaseRow(i);
     }
+
+    this->isWeighted = weighted;
+    this->haveNegativeEdgeWeight = negative;
+    this->ajdList = std::move(mat);
+}
+
+void Graph::loadGraph(const vector<vector<int>> &ajdList) {
+    // check if the graph is a square matrix when a row is copied
+    loadRows(
+        Matrix::uninitialized(ajdList.size()),
+        [&ajdList](size_t i) {
+            if (ajdList.size() != ajdList[i].size()) {
+                throw invalid_argument("Invalid graph: The graph is not a square matrix.(" + std::to_string(i) + "th row has " + std::to_string(ajdList[i].size()) + " elements.)");
+            }
+            return ajdList[i].data();
+        },
+        [](size_t /*i*/) {});
+}
+
+void Graph::loadGraph(vector<vector<int>> &&ajdList) {
+    // the same, but every row is freed after it is copied (so the peak is one matrix and one row)
+    size_t released = 0;
+    try {
+        loadRows(
+            Matrix::uninitialized(ajdList.size()),
+            [&ajdList](size_t i) {
+                if (ajdList.size() != ajdList[i].size()) {
+                    throw invalid_argument("Invalid graph: The graph is not a square matrix.(" + std::to_string(i) + "th row has " + std::to_string(ajdList[i].size()) + " elements.)");
+                }
+                return ajdList[i].data();
+            },
+            [&ajdList, &released](size_t i) {
+                released += ajdList[i].capacity() * sizeof(int);
+                vector<int>().swap(ajdList[i]);
+                if (released >= RELEASE_CHUNK) {
+                    releaseFreedMemory();
+                    released = 0;
+                }
+            });
+    } catch (...) {
+        ajdList.clear();
+        throw;
+    }
+    ajdList.clear();
+}
+
+void Graph::loadGraph(const int *cells, size_t numVertices) {
+    if (cells == nullptr && numVertices != 0) {
+        throw invalid_argument("Invalid graph: the buffer of the matrix is null.");
+    }
+    loadRows(Matrix::view(cells, numVertices), [cells, numVertices](size_t i) { return cells + i * numVertices; }, [](size_t /*i*/) {});
 }
 
 void Graph::printGraph() const {
     int count_edges = 0;
     for (size_t i = 0; i < ajdList.size(); i++) {
-        for (size_t j = 0; j < ajdList[i].size(); j++) {
-            if (ajdList[i][j] != NO_EDGE) {
+        for (int weight : ajdList[i]) {
+            if (weight != NO_EDGE) {
                 count_edges++;
             }
         }
@@ -82,6 +146,8 @@ void Graph::printGraph() const {
 
 vector<vector<int>> Graph::getGraph() const { return this->ajdList; }
 
+const Matrix& Graph::getMatrix() const { return this->ajdList; }
+
 bool Graph::isDirectedGraph() const { return this->isDirected; }
 bool Graph::isWeightedGraph() const { return this->isWeighted; }
 
@@ -7,6 +7,8 @@
 #include <limits>
 #include <vector>
 
+#include "Matrix.hpp"
+
 using std::vector;
 
 #define INF std::numeric_limits<int>::max()  // represent infinity
@@ -19,11 +21,21 @@ namespace shayg {
  */
 class Graph {
    private:
-    vector<vector<int>> ajdList;
+    Matrix ajdList;
     bool isDirected;
     bool isWeighted;
     bool haveNegativeEdgeWeight;
 
+    /**
+     * @brief the single pass of loadGraph: check every row of the matrix (the diagonal, the weights, and the symmetry of an undirected graph)
+     * and copy it to mat. the graph is changed only if the whole matrix is valid.
+     * @param mat the new matrix of the graph: Matrix::uninitialized(n) that the rows are copied to, or a view over the same cells (nothing is copied)
+     * @param getRow getRow(i) returns the n cells of row i (and throws if the row is not valid)
+     * @param releaseRow releaseRow(i) is called after row i was copied
+     */
+    template <typename GetRow, typename ReleaseRow>
+    void loadRows(Matrix mat, GetRow getRow, ReleaseRow releaseRow);
+
    public:
     /**
      * @brief Construct a new Graph object
@@ -39,6 +51,24 @@ class Graph {
      */
     void loadGraph(const vector<vector<int>> &ajdList);
 
+    /**
+     * @brief Load the graph from an adjacency matrix that is moved in.
+     * every row of the matrix is freed right after it is copied, so loading a big graph takes the memory of one matrix (and not two).
+     * the rows of ajdList are left empty (also if the matrix is not valid).
+     * @throw the same as loadGraph(const vector<vector<int>>&)
+     */
+    void loadGraph(vector<vector<int>> &&ajdList);
+
+    /**
+     * @brief Load the graph from an adjacency matrix in a buffer of the caller, row after row (the cell (u, v) is cells[u * numVertices + v]).
+     * nothing is copied - the graph keeps a read-only view over the buffer, so the buffer must not change or be freed while the graph uses it.
+     * @param cells the numVertices x numVertices cells of the matrix
+     * @param numVertices the number of vertices in the graph (|V|)
+     * @throw invalid_argument if cells is null (and numVertices is not 0) or the diagonal of the matrix is not NO_EDGE
+     * @throw invalid_argument if the graph is undirected and the matrix is not symmetric
+     */
+    void loadGraph(const int *cells, size_t numVertices);
+
     /**
      * @brief Print the graph as an adjacency matrix
      * the output will be like this:
@@ -53,6 +83,12 @@ class Graph {
      */
     vector<vector<int>> getGraph() const;
 
+    /**
+     * @brief return the adjacency matrix without copying it
+     * @return const Matrix& the adjacency matrix. getMatrix()[i] is a view of the i-th row
+     */
+    const Matrix& getMatrix() const;
+
     /**
      * @brief check if the graph is directed
      * @return true if the graph is directed, false otherwise
@@ -0,0 +1,216 @@
+/**
+ * @author Shay Gali
+ * @link shay.gali@msmail.ariel.ac.il
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+using std::vector;
+
+namespace shayg {
+
+/**
+ * @brief an allocator that returns memory aligned to Alignment bytes (used to start every row of the matrix on a cache line)
+ */
+template <typename T, size_t Alignment>
+struct AlignedAllocator {
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() = default;
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>& /*other*/) {}
+
+    T* allocate(size_t count) { return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(Alignment))); }
+    void deallocate(T* ptr, size_t /*count*/) { ::operator delete(ptr, std::align_val_t(Alignment)); }
+
+    // a new element without a value is default-initialized (an int is left uninitialized) and not zeroed,
+    // so a matrix that is filled right after it is created doesn't write (and touch) all of its memory twice
+    template <typename U>
+    void construct(U* ptr) {
+        ::new (static_cast<void*>(ptr)) U;
+    }
+    template <typename U, typename... Args>
+    void construct(U* ptr, Args&&... args) {
+        ::new (static_cast<void*>(ptr)) U(std::forward<Args>(args)...);
+    }
+
+    bool operator==(const AlignedAllocator& /*other*/) const { return true; }
+    bool operator!=(const AlignedAllocator& /*other*/) const { return false; }
+};
+
+/**
+ * @brief a view over one row of the matrix. works like a fixed size vector (operator[], begin, end, size).
+ * the view points into the matrix, so it is valid until the matrix is changed.
+ */
+template <typename T>
+class RowView {
+   private:
+    T* cells;
+    size_t length;
+
+   public:
+    RowView(T* cells, size_t length) : cells(cells), length(length) {}
+
+    T& operator[](size_t j) const { return cells[j]; }
+    T* begin() const { return cells; }
+    T* end() const { return cells + length; }
+    T* data() const { return cells; }
+    size_t size() const { return length; }
+    bool empty() const { return length == 0; }
+};
+
+/**
+ * @brief a square matrix of int, stored in one contiguous row-major buffer.
+ * every row is padded to `stride()` elements so every row starts on a cache line.
+ * the cell (i, j) is in data()[i * stride() + j].
+ *
+ * a matrix can also be a read-only view over a buffer of the caller (Matrix::view) - then the rows are not padded (the stride is n),
+ * and the first non-const access copies the cells to a buffer of the matrix (copy on write), so the buffer of the caller is never changed.
+ */
+class Matrix {
+   public:
+    static constexpr size_t ALIGNMENT = 64;                       // bytes - the size of a cache line
+    static constexpr size_t ROW_ALIGN = ALIGNMENT / sizeof(int);  // the stride is a multiple of this number of cells
+
+   private:
+    size_t n = 0;
+    size_t rowStride = 0;
+    vector<int, AlignedAllocator<int, ALIGNMENT>> cells;
+    const int* borrowed = nullptr;  // the cells of a view (nullptr if the matrix owns its cells)
+
+   public:
+    Matrix() = default;
+
+    /**
+     * @brief create an n x n matrix, all the cells are set to value
+     */
+    explicit Matrix(size_t n, int value = 0) : n(n), rowStride((n + ROW_ALIGN - 1) / ROW_ALIGN * ROW_ALIGN), cells(n * rowStride, value) {}
+
+    /**
+     * @brief copy a square vector<vector<int>> matrix (the rows must have mat.size() elements)
+     */
+    explicit Matrix(const vector<vector<int>>& mat) : Matrix(mat.size()) {
+        for (size_t i = 0; i < n; i++) {
+            std::copy(mat[i].begin(), mat[i].end(), (*this)[i].begin());
+        }
+    }
+
+    /**
+     * @brief create an n x n matrix without setting the cells - only the padding of the rows is set to 0.
+     * the memory of a cell is touched when it is written, so filling the matrix row after row doesn't take all the memory at once.
+     */
+    static Matrix uninitialized(size_t n) {
+        Matrix mat;
+        mat.n = n;
+        mat.rowStride = (n + ROW_ALIGN - 1) / ROW_ALIGN * ROW_ALIGN;
+        mat.cells.resize(n * mat.rowStride);  // default-initialized (see AlignedAllocator::construct)
+        for (size_t i = 0; i < n; i++) {
+            std::fill(mat.cells.data() + i * mat.rowStride + n, mat.cells.data() + (i + 1) * mat.rowStride, 0);
+        }
+        return mat;
+    }
+
+    /**
+     * @brief a view over n x n cells of the caller, row after row (the cell (i, j) is in cells[i * n + j]). nothing is copied.
+     * the buffer must not change or be freed while the matrix (or a copy of it) uses it.
+     */
+    static Matrix view(const int* cells, size_t n) {
+        Matrix mat;
+        mat.n = n;
+        mat.rowStride = n;
+        mat.borrowed = cells;
+        return mat;
+    }
+
+    /**
+     * @brief true if the cells are in a buffer of the caller (see Matrix::view)
+     */
+    bool isView() const { return borrowed != nullptr; }
+
+    /**
+     * @brief copy the cells of a view to a buffer of the matrix (with padded rows). does nothing if the matrix owns its cells.
+     * called by every non-const access, and before threads write to the matrix.
+     */
+    void makeOwned() {
+        if (borrowed == nullptr) {
+            return;
+        }
+        const int* source = borrowed;
+        size_t sourceStride = rowStride;
+        *this = Matrix::uninitialized(n);
+        for (size_t i = 0; i < n; i++) {
+            std::copy(source + i * sourceStride, source + i * sourceStride + n, cells.data() + i * rowStride);
+        }
+    }
+
+    size_t size() const { return n; }
+    bool empty() const { return n == 0; }
+
+    /**
+     * @brief the distance (in cells) between the start of two following rows
+     */
+    size_t stride() const { return rowStride; }
+
+    int* data() {
+        makeOwned();
+        return cells.data();
+    }
+    const int* data() const { return borrowed != nullptr ? borrowed : cells.data(); }
+
+    RowView<int> operator[](size_t i) {
+        makeOwned();
+        return {cells.data() + i * rowStride, n};
+    }
+    RowView<const int> operator[](size_t i) const { return {data() + i * rowStride, n}; }
+
+    /**
+     * @brief copy the matrix to a vector<vector<int>>
+     */
+    operator vector<vector<int>>() const {
+        vector<vector<int>> mat(n);
+        for (size_t i = 0; i < n; i++) {
+            mat[i].assign((*this)[i].begin(), (*this)[i].end());
+        }
+        return mat;
+    }
+
+    bool operator==(const Matrix& other) const {
+        if (n != other.n) {
+            return false;
+        }
+        for (size_t i = 0; i < n; i++) {
+            if (!std::equal((*this)[i].begin(), (*this)[i].end(), other[i].begin())) {
+                return false;
+            }
+        }
+        return true;
+    }
+    bool operator!=(const Matrix& other) const { return !(*this == other); }
+
+    friend bool operator==(const Matrix& mat, const vector<vector<int>>& other) {
+        if (mat.size() != other.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < mat.size(); i++) {
+            if (other[i].size() != mat.size() || !std::equal(mat[i].begin(), mat[i].end(), other[i].begin())) {
+                return false;
+            }
+        }
+        return true;
+    }
+    friend bool operator==(const vector<vector<int>>& other, const Matrix& mat) { return mat == other; }
+    friend bool operator!=(const Matrix& mat, const vector<vector<int>>& other) { return !(mat == other); }
+    friend bool operator!=(const vector<vector<int>>& other, const Matrix& mat) { return !(mat == other); }
+};
+
+}  // namespace shayg
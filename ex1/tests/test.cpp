@@ -99,6 +99,46 @@ TEST_CASE("Test loadGraph for undirected graph") {
     CHECK_THROWS_AS(g.loadGraph(graph4), std::invalid_argument);
 }
 
+TEST_CASE("Test loadGraph without a copy") {
+    Graph g(false);
+    vector<vector<int>> graph = {
+        // clang-format off
+            {NO_EDGE, 2,       NO_EDGE},
+            {2,       NO_EDGE, -1     },
+            {NO_EDGE, -1,      NO_EDGE}
+        // clang-format on
+    };
+
+    // move the matrix in - the rows are freed after they are copied
+    vector<vector<int>> moved = graph;
+    g.loadGraph(std::move(moved));
+    CHECK(g.getGraph() == graph);
+    CHECK(g.isWeightedGraph() == true);
+    CHECK(g.isHaveNegativeEdgeWeight() == true);
+    CHECK(moved.empty());  // NOLINT(bugprone-use-after-move)
+
+    // a view over a buffer of the caller
+    vector<int> cells = {NO_EDGE, 1, 1, 1, NO_EDGE, NO_EDGE, 1, NO_EDGE, NO_EDGE};
+    g.loadGraph(cells.data(), 3);
+    CHECK(g.getMatrix().isView() == true);
+    CHECK(g.getMatrix().data() == cells.data());
+    CHECK(g.getGraph() == vector<vector<int>>{{NO_EDGE, 1, 1}, {1, NO_EDGE, NO_EDGE}, {1, NO_EDGE, NO_EDGE}});
+    CHECK(g.isWeightedGraph() == false);
+    CHECK(Algorithms::isBipartite(g) == "The graph is bipartite: A={0}, B={1,2}");
+
+    // not valid matrices - the graph is not changed
+    cells[1] = 5;  // not symmetric
+    CHECK_THROWS_AS(g.loadGraph(cells.data(), 3), std::invalid_argument);
+    CHECK_THROWS_AS(g.loadGraph(nullptr, 3), std::invalid_argument);
+    vector<vector<int>> notSymmetric = {{NO_EDGE, 1}, {2, NO_EDGE}};
+    CHECK_THROWS_AS(g.loadGraph(std::move(notSymmetric)), std::invalid_argument);
+    CHECK(g.isWeightedGraph() == false);
+    Graph directed(true);
+    vector<vector<int>> asymmetric = {{NO_EDGE, 1}, {2, NO_EDGE}};
+    directed.loadGraph(std::move(asymmetric));
+    CHECK(directed.getGraph() == vector<vector<int>>{{NO_EDGE, 1}, {2, NO_EDGE}});
+}
+
 TEST_CASE("Test printGraph") {
     std::stringstream buffer;
     std::streambuf* prevcoutbuf = std::cout.rdbuf(buffer.rdbuf());
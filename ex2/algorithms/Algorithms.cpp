@@ -6,22 +6,26 @@
 #include "Algorithms.hpp"
 
 #include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cmath>
 #include <functional>
 #include <iostream>
+#include <limits>
+#include <memory>
 #include <queue>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
+#include "PriorityQueues.hpp"
+
 enum Color {
     // for DFS
     WHITE,
     GRAY,
-    BLACK,
-
-    // for bipartite
-    BLUE,
-    RED
+    BLACK
 };
 
 using namespace shayg;
@@ -30,255 +34,551 @@ using std::queue;
 using std::string;
 using std::vector;
 
+// Dijkstra uses Dial's buckets when all the weights are at most this number (see dijkstra)
+constexpr int DIAL_MAX_WEIGHT = 4096;
+
+// the dest of BFS/Dijkstra when the search has to reach all the vertices
+constexpr size_t NO_TARGET = std::numeric_limits<size_t>::max();
+
+// the src of Bellman-Ford for a virtual vertex with an edge of weight 0 to every vertex (all the vertices start at distance 0)
+constexpr size_t SUPER_SOURCE = std::numeric_limits<size_t>::max();
+
+// a loop over edges (a BFS level, the unions of connectedComponents) is split between the cores when it has at least this many edges
+// for every thread (a thread costs more than a small loop)
+constexpr size_t MIN_PARALLEL_EDGES = 1 << 16;
+
+// the number of items (vertices or edges) that a thread takes at a time in a parallel loop
+constexpr size_t PARALLEL_BLOCK = 1024;
+
+// direction optimization of BFS (Beamer, Asanovic and Patterson): a level is bottom-up when the frontier has more than 1/BFS_ALPHA
+// of the edges of the vertices that are not reached yet, and goes back to top-down when the frontier has less than 1/BFS_BETA of the vertices
+constexpr size_t BFS_ALPHA = 14;
+constexpr size_t BFS_BETA = 24;
+
 // ~~~ declare the helper functions ~~~
 
-string constructCyclePath(vector<int>& path, int start);
+/**
+ * @brief level synchronous BFS for Storage::DENSE and Storage::SPARSE. every level is one step over the whole frontier, in one of two directions:
+ * - top-down: every vertex of the frontier checks its out edges and claims the neighbors that are not reached yet
+ * - bottom-up: every vertex that is not reached yet checks its in edges, and stops at the first one that comes from the frontier
+ * top-down is cheap when the frontier is small, bottom-up when the frontier is a big part of the graph (most of the vertices stop after
+ * a few edges). a big level is split between the cores in blocks of vertices, and every thread keeps its own part of the next frontier.
+ *
+ * the parent of a vertex is the smallest vertex of the previous level that has an edge to it - the same for any number of threads and
+ * any direction, so the paths don't depend on the machine. the state is kept between searches, so the next search only reaches the
+ * vertices that the previous ones didn't reach (like a DFS forest).
+ */
+class LevelBfs {
+   private:
+    const Graph& g;
+    bool undirected;  // follow the in edges too (only for directed graphs - in undirected graph they are the out edges)
+    size_t maxThreads;
+    vector<int> distances;
+    vector<std::atomic<int>> parents;  // the top-down threads keep the smallest parent with compare and swap
+    size_t unreachedEdges;             // the edges of the vertices that were not reached yet
+    vector<size_t> frontier;
+    vector<vector<size_t>> next;  // the next frontier, a part for every thread
+
+    size_t degree(size_t u) const;
+    int firstInFrontier(size_t v, int level) const;
+    void topDown(size_t numThreads);
+    void bottomUp(int level, size_t numThreads);
+
+   public:
+    /**
+     * @param undirected - treat the graph as undirected (the neighbors of a vertex are its out neighbors and its in neighbors)
+     */
+    LevelBfs(const Graph& g, bool undirected);
+
+    /**
+     * @brief reach all the vertices from src that no search reached yet, level by level. stops after the level of dest (if it's not NO_TARGET)
+     * @return the number of vertices that were reached (including src)
+     */
+    size_t search(size_t src, size_t dest = NO_TARGET);
+
+    const vector<int>& getDistances() const { return distances; }
+    vector<int> getParents() const;
+};
+size_t hardwareThreads();
+size_t threadsFor(size_t edges);
+template <typename Next>
+vector<size_t> tarjan(size_t n, Next next, size_t* count);
+template <typename Func>
+void forEachBlock(size_t count, size_t numThreads, Func func);
 
-vector<vector<size_t>> dfs(const Graph& g);
-vector<size_t> dfs(const Graph& g, size_t src, vector<Color>* colors);
+/**
+ * @brief the out neighbors of the vertices one at a time (any storage), for the DFS loops without recursion.
+ * next(u, &cursor) returns the neighbor of u at the cursor and moves the cursor after it, or |V| if there are no more (the cursor starts at 0)
+ */
+class NeighborCursor {
+   private:
+    const CSR* csr = nullptr;
+    const BitMatrix* bits = nullptr;
+    size_t n;
+
+   public:
+    explicit NeighborCursor(const Graph& g);
+    size_t operator()(size_t u, size_t* cursor) const;
+};
+vector<size_t> cyclePath(const vector<pair<size_t, size_t>>& frames, size_t start);
 
-pair<vector<int>, vector<int>> bfs(const Graph& g, size_t src);
+pair<vector<int>, vector<int>> bfs(const Graph& g, size_t src, size_t dest = NO_TARGET);
 pair<vector<int>, vector<int>> bellmanFord(const Graph& g, size_t src);
 pair<vector<int>, vector<int>> bellmanFord(const Graph& g, size_t src, bool isDirected);
-pair<vector<int>, vector<int>> dijkstra(const Graph& g, size_t src);
-
-string isContainsCycleUtil(const Graph& g, size_t src, vector<Color>* colors, vector<int>* parents, vector<int>* path);
+pair<vector<int>, vector<int>> spfa(const Graph& g, size_t src);
+int findParentCycle(const vector<int>& parents);
+std::shared_ptr<const vector<int>> johnsonPotentials(const Graph& g);
+pair<vector<int>, vector<int>> reducedDijkstra(const Graph& g, size_t src, size_t dest, const vector<int>& potentials);
+pair<vector<int>, vector<int>> dijkstra(const Graph& g, size_t src, size_t dest = NO_TARGET);
+template <typename Weight>
+pair<vector<int>, vector<int>> dialDijkstra(const Graph& g, size_t src, int maxWeight, size_t dest, Weight weightOf);
+template <typename Weight>
+pair<vector<int>, vector<int>> heapDijkstra(const Graph& g, size_t src, size_t dest, Weight weightOf);
+vector<size_t> bidirectionalBfs(const Graph& g, size_t src, size_t dest);
+vector<size_t> bidirectionalDijkstra(const Graph& g, size_t src, size_t dest);
+vector<size_t> joinPaths(const vector<int>& parentsFromSrc, const vector<int>& nextToDest, size_t from, size_t to);
+vector<size_t> treePath(const vector<int>& parents, size_t dest);
+Algorithms::Path pathOf(const Graph& g, vector<size_t> vertices);
+void appendNumber(string* out, size_t value);
+string pathString(const vector<size_t>& vertices);
+void checkNegativeCycle(const Graph& g);
+
+string bipartiteString(const vector<size_t>& setA, const vector<size_t>& setB);
+
+// ~ word level versions of the algorithms, for graphs stored as Storage::BITSET ~
+size_t reachBits(const BitMatrix& bits, size_t src, vector<uint64_t>* visited);
+size_t nextBit(const uint64_t* words, size_t n, size_t from);
+bool isConnectedBits(const Graph& g);
+pair<vector<int>, vector<int>> bfsBits(const Graph& g, size_t src, size_t dest = NO_TARGET);
+vector<size_t> findCycleBits(const Graph& g);
+bool colorBits(const Graph& g, vector<size_t>* setB, vector<size_t>* setR);
 
 // ~~~ implement the functions ~~~
 bool Algorithms::isConnected(const Graph& g) {
     /*
-    to check if undirected graph is connected, we can perform DFS on the graph and check if all the vertices are discovered.
+    to check if undirected graph is connected, we unite the vertices of every edge in a union-find (on all the cores),
+    and check if only one set is left.
 
-    The way to check if a directed graph is connected is to perform DFS twice:
-    1. Perform DFS on the graph.
-    2. If the DFS discovers all the vertices, then the graph is connected. (if we got only one DFS tree)
-    3. Perform DFS on the root of the last DFS tree.
-    4. If the DFS discovers all the vertices, then the graph is connected. otherwise, the graph is not connected.
+    a directed graph is connected if some vertex reaches all the vertices. the vertices of a strongly connected component reach each other,
+    so we check the condensation of the graph (the DAG of the components): every vertex of a DAG is reached from one of its sources
+    (the components without in edges), so some vertex reaches all the vertices iff the condensation has only one source.
    */
     // check if the graph is empty
-    if (g.getGraph().empty()) {
+    if (g.getNumVertices() == 0) {
         return true;
     }
 
-    vector<vector<size_t>> firstDfsTree = dfs(g);
-    if (firstDfsTree.size() == 1) {
-        return true;
+    if (!g.isDirectedGraph()) {
+        if (g.getStorage() == Storage::BITSET) {
+            return isConnectedBits(g);
+        }
+        return IncrementalComponents(g).count() == 1;
     }
 
-    // if the graph is undirected, the second DFS is not needed
-    if (!g.isDirectedGraph()) {
-        return false;
+    // the ids are in topological order, so the component 0 is a source - the graph is connected iff all the other components have in edges
+    Components components = stronglyConnectedComponents(g);
+    vector<bool> hasInEdge(components.count(), false);
+    for (size_t c : components.condensation.targets) {
+        hasInEdge[c] = true;
+    }
+    return std::count(hasInEdge.begin(), hasInEdge.end(), false) == 1;
+}
+
+Algorithms::Components Algorithms::stronglyConnectedComponents(const Graph& g) {
+    size_t n = g.getNumVertices();
+    NeighborCursor next(g);
+
+    Components result;
+    size_t count = 0;
+    result.component = tarjan(n, next, &count);
+    result.sizes.assign(count, 0);
+    for (size_t c : result.component) {
+        result.sizes[c]++;
+    }
+
+    // the vertices sorted by component (counting sort), so the edges out of every component are read together
+    vector<size_t> firstOf(count + 1, 0);
+    for (size_t c = 0; c < count; c++) {
+        firstOf[c + 1] = firstOf[c] + result.sizes[c];
+    }
+    vector<size_t> byComponent(n);
+    vector<size_t> fill(firstOf.begin(), firstOf.end() - 1);
+    for (size_t v = 0; v < n; v++) {
+        byComponent[fill[result.component[v]]++] = v;
+    }
+
+    // the edges of the condensation, one row at a time. position[d] is the index of the edge c->d if it was already added to the row of c
+    CSR& dag = result.condensation;
+    dag.offsets.assign(count + 1, 0);
+    vector<size_t> position(count, NO_TARGET);
+    vector<pair<size_t, int>> row;
+    for (size_t c = 0; c < count; c++) {
+        row.clear();
+        for (size_t i = firstOf[c]; i < firstOf[c + 1]; i++) {
+            size_t u = byComponent[i];
+            size_t cursor = 0;
+            for (size_t v = next(u, &cursor); v != n; v = next(u, &cursor)) {
+                size_t d = result.component[v];
+                if (d == c) {
+                    continue;
+                }
+                if (position[d] == NO_TARGET) {
+                    position[d] = row.size();
+                    row.emplace_back(d, 0);
+                }
+                row[position[d]].second++;
+            }
+        }
+        std::sort(row.begin(), row.end());
+        for (const pair<size_t, int>& edge : row) {
+            position[edge.first] = NO_TARGET;
+            dag.targets.push_back(edge.first);
+            dag.weights.push_back(edge.second);
+        }
+        dag.offsets[c + 1] = dag.targets.size();
     }
+    return result;
+}
 
-    // Perform DFS on the root of the last DFS tree (the first element of the last vector in the firstDfsTree matrix
-    size_t firstElementOfLastVector = firstDfsTree.back().front();
-    vector<Color> colors(g.getGraph().size(), WHITE);
-    vector<size_t> secondDfsTree = dfs(g, firstElementOfLastVector, &colors);
-    return secondDfsTree.size() == g.getGraph().size();
+string Algorithms::shortestPath(const Graph& g, size_t src, size_t dest, SearchMode mode) {
+    try {
+        return pathString(findShortestPath(g, src, dest, mode).vertices);
+    } catch (Algorithms::NegativeCycleException& e) {
+        return e.what();
+    }
 }
 
-string Algorithms::shortestPath(const Graph& g, size_t src, size_t dest) {
+Algorithms::Path Algorithms::findShortestPath(const Graph& g, size_t src, size_t dest, SearchMode mode) {
     // check for valid source and destination vertices
-    if (src >= g.getGraph().size() || dest >= g.getGraph().size()) {
+    if (src >= g.getNumVertices() || dest >= g.getNumVertices()) {
         throw std::invalid_argument("Invalid source or destination vertex");
     }
 
     if (src == dest) {
-        return std::to_string(src);
+        return {{src}, 0};
     }
 
     pair<vector<int>, vector<int>> shortestPathResult;
+    size_t target = mode == SearchMode::FULL ? NO_TARGET : dest;  // BFS and Dijkstra can stop when they reach the target
 
     // if the graph is not weighted, we can use BFS to find the shortest path
     if (!g.isWeightedGraph()) {
-        shortestPathResult = bfs(g, src);
+        if (mode == SearchMode::BIDIRECTIONAL && g.getStorage() != Storage::BITSET) {  // the word level BFS only stops early
+            return pathOf(g, bidirectionalBfs(g, src, dest));
+        }
+        shortestPathResult = bfs(g, src, target);
     } else if (g.isHaveNegativeEdgeWeight()) {  // if the graph has negative edge weights, we can use Bellman-Ford algorithm
-        try {
+        // a directed graph: Dijkstra on the weights after Johnson's reweighting, if the graph has no negative cycle
+        // (with a negative cycle, the path is defined if src can't reach the cycle - SPFA from src tells)
+        std::shared_ptr<const vector<int>> potentials = g.isDirectedGraph() ? johnsonPotentials(g) : nullptr;
+        if (potentials && !potentials->empty()) {
+            shortestPathResult = reducedDijkstra(g, src, target, *potentials);
+        } else {
             shortestPathResult = bellmanFord(g, src);
-            if (!g.isDirectedGraph()) {  // if the graph is undirected, we can try to find the shortest path from the destination to the source
-                pair<vector<int>, vector<int>> bellmanResult2 = bellmanFord(g, dest);
-
-                // choose the correct result (the longer path)
-                vector<int> parents1 = shortestPathResult.second;
-                size_t path1Length = 0;
-                int parent = parents1[dest];
-                while (parent != -1) {
-                    path1Length++;
-                    parent = parents1[(size_t)parent];
-                }
+        }
+        if (!g.isDirectedGraph()) {  // if the graph is undirected, we can try to find the shortest path from the destination to the source
+            pair<vector<int>, vector<int>> bellmanResult2 = bellmanFord(g, dest);
+
+            // choose the correct result (the longer path)
+            const vector<int>& parents1 = shortestPathResult.second;
+            size_t path1Length = 0;
+            for (int parent = parents1[dest]; parent != -1; parent = parents1[(size_t)parent]) {
+                path1Length++;
+            }
 
-                vector<int> parents2 = bellmanResult2.second;
-                size_t path2Length = 0;
-                parent = parents2[src];
-                while (parent != -1) {
-                    path2Length++;
-                    parent = parents2[(size_t)parent];
-                }
+            const vector<int>& parents2 = bellmanResult2.second;
+            size_t path2Length = 0;
+            for (int parent = parents2[src]; parent != -1; parent = parents2[(size_t)parent]) {
+                path2Length++;
+            }
 
-                if (path1Length < path2Length) {  // update the result if needed
-                    shortestPathResult = bellmanResult2;
-
-                    // swap the source and destination vertices
-                    dest = src;
-                    // create the path from the source to the destination
-                    vector<int> parents = shortestPathResult.second;
-                    string path = std::to_string(dest);
-                    reverse(path.begin(), path.end());
-                    int parent = parents[dest];
-                    while (parent != -1) {
-                        string temp = std::to_string(parent);
-                        reverse(temp.begin(), temp.end());
-                        path.insert(0, temp + ">-");
-                        parent = parents[(size_t)parent];
-                    }
-                    // reverse the path
-                    reverse(path.begin(), path.end());
-                    return path;
+            if (path1Length < path2Length) {
+                // the tree of the second search is rooted at dest, so its parents lead from src to dest - no need to reverse
+                vector<size_t> path;
+                path.reserve(path2Length + 1);
+                for (int v = (int)src; v != -1; v = parents2[(size_t)v]) {
+                    path.push_back((size_t)v);
                 }
+                return pathOf(g, std::move(path));
             }
-        } catch (Algorithms::NegativeCycleException& e) {
-            return e.what();
         }
     } else {  // if the graph has non-negative edge weights, we can use Dijkstra's algorithm
-        shortestPathResult = dijkstra(g, src);
+        if (mode == SearchMode::BIDIRECTIONAL) {
+            return pathOf(g, bidirectionalDijkstra(g, src, dest));
+        }
+        shortestPathResult = dijkstra(g, src, target);
     }
 
-    // get the shortest path from the src to the dest
-    vector<int> distances = shortestPathResult.first;
-    vector<int> parents = shortestPathResult.second;
-
     // if the distance to the destination vertex is infinity, then there is no path between the source and destination vertices
-    if (distances[dest] == INF) {
-        return "-1";
+    if (shortestPathResult.first[dest] == INF) {
+        return {};
     }
 
     // create the path from the source to the destination
-    string path = std::to_string(dest);
-    int parent = parents[dest];
-    while (parent != -1) {
-        path.insert(0, std::to_string(parent) + "->");
-        parent = parents[(size_t)parent];
+    return pathOf(g, treePath(shortestPathResult.second, dest));
+}
+
+string Algorithms::aStar(const Graph& g, size_t src, size_t dest, const Heuristic& heuristic) {
+    return pathString(findShortestPathAStar(g, src, dest, heuristic).vertices);
+}
+
+Algorithms::Path Algorithms::findShortestPathAStar(const Graph& g, size_t src, size_t dest, const Heuristic& heuristic) {
+    if (src >= g.getNumVertices() || dest >= g.getNumVertices()) {
+        throw std::invalid_argument("Invalid source or destination vertex");
     }
-    return path;
+    if (g.isHaveNegativeEdgeWeight()) {
+        throw std::invalid_argument("A* needs a graph without negative edge weights");
+    }
+    if (src == dest) {
+        return {{src}, 0};
+    }
+    if (g.getStorage() == Storage::BITSET) {  // no weights and no neighbors index - the word level BFS is faster than any heuristic
+        return findShortestPath(g, src, dest);
+    }
+
+    size_t n = g.getNumVertices();
+    vector<int> distances(n, INF);
+    vector<int> parents(n, -1);
+
+    // the key of a vertex is its distance + the heuristic. a vertex can be settled again if a shorter distance is found after it was settled
+    // (only when the heuristic is not consistent), and dest is final when it is settled because the heuristic is a lower bound
+    IndexedHeap<4> heap(n);
+    distances[src] = 0;
+    heap.push(src, heuristic(src, dest));
+    while (!heap.empty()) {
+        size_t u = heap.pop();
+        if (u == dest) {
+            return {treePath(parents, dest), distances[dest]};
+        }
+        for (auto [v, weight] : g.neighbors(u)) {
+            int currDist = distances[u] + weight;
+            if (currDist < distances[v]) {
+                distances[v] = currDist;
+                parents[v] = (int)u;
+                heap.push(v, currDist + heuristic(v, dest));
+            }
+        }
+    }
+    return {};
+}
+
+Algorithms::Heuristic Algorithms::euclideanHeuristic(vector<Point> points) {
+    return [points = std::move(points)](size_t v, size_t dest) {
+        return (int)std::floor(std::hypot(points[v].x - points[dest].x, points[v].y - points[dest].y));
+    };
 }
 
-string Algorithms::isContainsCycle(const Graph& g) {
+Algorithms::Heuristic Algorithms::manhattanHeuristic(vector<Point> points) {
+    return [points = std::move(points)](size_t v, size_t dest) {
+        return (int)std::floor(std::abs(points[v].x - points[dest].x) + std::abs(points[v].y - points[dest].y));
+    };
+}
+
+string Algorithms::isContainsCycle(const Graph& g) { return pathString(findCycle(g)); }
+
+vector<size_t> Algorithms::findCycle(const Graph& g) {
     /*
     a graph contains a cycle if has a back edge.
 
     so we can perform DFS on the graph and check if we discover a back edge.
+    the DFS path is a stack of (vertex, cursor) frames - the gray vertices from the root to the current vertex, so when we find a back edge
+    to v, the cycle is the path from v to the current vertex.
     */
-    vector<Color> colors(g.getGraph().size(), WHITE);
-    vector<int> parents(g.getGraph().size(), -1);
-    vector<int> path;  // to store the sequence of vertices visited during the DFS - used to construct the cycle path
+    if (g.getStorage() == Storage::BITSET) {
+        return findCycleBits(g);
+    }
 
-    // start DFS on the graph
-    for (size_t i = 0; i < g.getGraph().size(); i++) {
-        if (colors[i] == WHITE) {
-            string cycle = isContainsCycleUtil(g, i, &colors, &parents, &path);
-            if (!cycle.empty()) {  // if a cycle is detected
-                return cycle;
+    size_t n = g.getNumVertices();
+    const CSR& csr = g.getCSR();
+    bool directed = g.isDirectedGraph();
+    vector<Color> colors(n, WHITE);
+    vector<size_t> parents(n, n);
+    vector<pair<size_t, size_t>> frames;  // (vertex, the index of its next edge in csr)
+
+    for (size_t root = 0; root < n; root++) {
+        if (colors[root] != WHITE) {
+            continue;
+        }
+        colors[root] = GRAY;
+        frames.emplace_back(root, csr.offsets[root]);
+        while (!frames.empty()) {
+            size_t u = frames.back().first;
+            size_t end = csr.offsets[u + 1];
+            size_t i = frames.back().second;
+            // skip the black vertices in one loop, until a new vertex or a back edge
+            while (i < end && colors[csr.targets[i]] == BLACK) {
+                i++;
+            }
+            if (i == end) {  // the vertex is done, mark it as black
+                colors[u] = BLACK;
+                frames.pop_back();
+                continue;
+            }
+            size_t v = csr.targets[i];
+            frames.back().second = i + 1;
+            if (colors[v] == WHITE) {
+                colors[v] = GRAY;
+                parents[v] = u;
+                frames.emplace_back(v, csr.offsets[v]);
+            } else if (directed || parents[u] != v) {
+                // a back edge (in undirected graph, the edge to the parent is not a cycle)
+                return cyclePath(frames, v);
             }
         }
     }
-    return "-1";
+    return {};
+}
+
+vector<size_t> Algorithms::findCycleParallel(const Graph& g) {
+    if (!g.isDirectedGraph() || g.getStorage() == Storage::BITSET) {
+        return findCycle(g);
+    }
+
+    size_t n = g.getNumVertices();
+    size_t edges = g.getCSR().targets.size();
+    vector<vector<size_t>> found(hardwareThreads());  // the next level, a part for every thread
+
+    // the number of in edges of every vertex from the vertices that are not removed yet. the first level is the vertices without in edges
+    vector<std::atomic<size_t>> inDegree(n);
+    forEachBlock(n, threadsFor(edges), [&](size_t thread, size_t begin, size_t end) {
+        for (size_t v = begin; v < end; v++) {
+            inDegree[v].store(g.inNeighbors(v).size(), std::memory_order_relaxed);
+            if (g.inNeighbors(v).empty()) {
+                found[thread].push_back(v);
+            }
+        }
+    });
+
+    // remove a level, the vertices that lost their last in edge are the next level
+    vector<size_t> level;
+    size_t removed = 0;
+    while (true) {
+        level.clear();
+        for (vector<size_t>& part : found) {
+            level.insert(level.end(), part.begin(), part.end());
+            part.clear();
+        }
+        if (level.empty()) {
+            break;
+        }
+        removed += level.size();
+        size_t levelEdges = level.size() * (edges / n);  // about - the average out degree of the level
+        forEachBlock(level.size(), threadsFor(levelEdges), [&](size_t thread, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                for (Neighbor neighbor : g.neighbors(level[i])) {
+                    if (inDegree[neighbor.vertex].fetch_sub(1, std::memory_order_relaxed) == 1) {
+                        found[thread].push_back(neighbor.vertex);
+                    }
+                }
+            }
+        });
+    }
+    if (removed == n) {
+        return {};
+    }
+
+    // walk back from the smallest vertex that is left, always to its smallest in neighbor that is left, until a vertex repeats
+    auto isLeft = [&](size_t v) { return inDegree[v].load(std::memory_order_relaxed) > 0; };
+    vector<size_t> step(n, NO_TARGET);  // step[v] - the index of v in the walk
+    vector<size_t> walk;
+    size_t v = 0;
+    while (!isLeft(v)) {
+        v++;
+    }
+    while (step[v] == NO_TARGET) {
+        step[v] = walk.size();
+        walk.push_back(v);
+        for (Neighbor neighbor : g.inNeighbors(v)) {
+            if (isLeft(neighbor.vertex)) {
+                v = neighbor.vertex;
+                break;
+            }
+        }
+    }
+
+    // the walk goes against the edges, so the cycle is the end of the walk (from the repeated vertex) in reverse
+    vector<size_t> cycle(walk.begin() + (std::ptrdiff_t)step[v], walk.end());
+    cycle.push_back(v);
+    std::reverse(cycle.begin(), cycle.end());
+    return cycle;
 }
 
 string Algorithms::isBipartite(const Graph& g) {
+    Bipartition result = findBipartition(g);
+    if (!result.bipartite) {
+        return "The graph is not bipartite";
+    }
+    return bipartiteString(result.setA, result.setB);
+}
+
+Algorithms::Bipartition Algorithms::findBipartition(const Graph& g) {
     /*
     To check if a graph is bipartite, we will perform BFS on the graph and color the vertices in two colors.
     If in some point we discover a vertex that is colored with the same color as its parent, then the graph is not bipartite.
 
     in the end, we will return the two sets of vertices, according to the colors of the vertices.
 
-    if the graph is directed, we will convert it to an undirected graph and then perform the algorithm.
+    if the graph is directed, we will treat it as an undirected graph - the neighbors of a vertex are its out neighbors and its in neighbors.
     */
-    if (g.getGraph().empty()) {
-        return "The graph is bipartite: A={}, B={}";
+    Bipartition result;
+    if (g.getNumVertices() == 0) {
+        result.bipartite = true;
+        return result;
     }
 
-    // if the graph is directed, convert it to an undirected graph
-    if (g.isDirectedGraph()) {
-        Graph undirectedGraph;
-        // convert the directed graph to an undirected graph
-        vector<vector<int>> adjMatrix = g.getGraph();
-
-        // make the graph symmetric (we don't care about the edge weights, we just need to know if there is an edge or not)
-        for (size_t i = 0; i < adjMatrix.size(); i++) {
-            for (size_t j = 0; j < adjMatrix.size(); j++) {
-                if (adjMatrix[i][j] != NO_EDGE) {
-                    adjMatrix[j][i] = adjMatrix[i][j];
-                }
-            }
+    if (g.getStorage() == Storage::BITSET) {
+        result.bipartite = colorBits(g, &result.setA, &result.setB);
+        if (!result.bipartite) {
+            return Bipartition();
         }
-
-        undirectedGraph.loadGraph(adjMatrix);
-
-        // perform the algorithm on the undirected graph
-        return isBipartite(undirectedGraph);
+        std::sort(result.setA.begin(), result.setA.end());
+        std::sort(result.setB.begin(), result.setB.end());
+        return result;
     }
 
-    size_t n = g.getGraph().size();
-    // create a list of colors for the vertices
-    vector<Color> colors(n, WHITE);
-
-    // create two sets of vertices (A and B)
-    vector<size_t> setB;
-    vector<size_t> setR;
-
-    // start BFS from the first vertex (and color the graph with two colors)
-    queue<size_t> q;
-    q.push(0);
-    colors[0] = BLUE;
-    setB.push_back(0);  // add the first vertex to the blue set
-
-    while (!q.empty()) {
-        size_t u = q.front();
-        q.pop();
-        for (size_t v = 0; v < n; v++) {  // loop over the neighbors of the vertex
-            if (g.getGraph()[u][v] != NO_EDGE) {
-                if (colors[v] == colors[u]) {  // if the vertex is colored with the same color as its neighbor
-                    return "The graph is not bipartite";
-                }
-
-                if (colors[v] == WHITE) {  // if the vertex is not discovered yet
-                                           // color the vertex with the opposite color of its parent
-                    if (colors[u] == BLUE) {
-                        colors[v] = RED;
-                        setR.push_back(v);
-                    } else {
-                        colors[v] = BLUE;
-                        setB.push_back(v);
-                    }
-                    q.push(v);  // add the vertex to the queue (this is the first time we discover it)
+    // BFS from the first vertex, the color of a vertex is the parity of its level (so every edge between two levels has two colors)
+    LevelBfs levels(g, true);
+    levels.search(0);
+    const vector<int>& distances = levels.getDistances();
+
+    // the edges of a BFS tree only go between the same level or the next one, so the graph is bipartite iff no edge is inside a level
+    std::atomic<bool> sameColor{false};
+    forEachBlock(g.getNumVertices(), threadsFor(g.getCSR().targets.size()), [&](size_t /*thread*/, size_t begin, size_t end) {
+        for (size_t u = begin; u < end && !sameColor.load(std::memory_order_relaxed); u++) {
+            if (distances[u] == INF) {
+                continue;
+            }
+            for (Neighbor neighbor : g.neighbors(u)) {
+                if (distances[neighbor.vertex] == distances[u]) {
+                    sameColor.store(true, std::memory_order_relaxed);
+                    break;
                 }
             }
         }
+    });
+    if (sameColor) {
+        return result;
     }
 
-    // create the result string
-    string result = "The graph is bipartite: A={";
-    for (size_t i = 0; i < setB.size() - 1; i++) {
-        result += std::to_string(setB[i]);
-        if (i != setB.size() - 1) {
-            result += ",";
-        }
-    }
-    result += std::to_string(setB.back()) + "}, B={";
-    for (size_t i = 0; i < setR.size() - 1; i++) {
-        result += std::to_string(setR[i]);
-        if (i != setR.size() - 1) {
-            result += ",";
+    // the vertices are added in increasing order, so the sets are sorted
+    result.bipartite = true;
+    for (size_t v = 0; v < distances.size(); v++) {
+        if (distances[v] != INF) {
+            (distances[v] % 2 == 0 ? result.setA : result.setB).push_back(v);
         }
     }
-    result += std::to_string(setR.back()) + "}";
     return result;
 }
 
 string Algorithms::negativeCycle(const Graph& g) {
+    vector<size_t> cycle = findNegativeCycle(g);
+    return cycle.empty() ? "No negative cycle" : pathString(cycle);
+}
+
+vector<size_t> Algorithms::findNegativeCycle(const Graph& g) {
     /*
     To find a negative cycle in the graph, we will add a new vertex to the graph and connect it to all the other vertices with an edge of weight 0.
-    Then we will perform Bellman-Ford algorithm from the new vertex.
+    Then we will perform Bellman-Ford algorithm from the new vertex. (the vertex is virtual - all the vertices start at distance 0)
 
     on the last part on the Bellman-Ford algorithm, if we can relax an edge, then the graph contains a negative cycle.
 
@@ -287,142 +587,479 @@ string Algorithms::negativeCycle(const Graph& g) {
     because in our graph representation, no edges have a weight of 0, in this function we will change the NO_EDGE value to INFINITY.
     */
 
-    size_t n = g.getGraph().size();
+    // without negative edges there is no negative cycle
+    if (!g.isHaveNegativeEdgeWeight()) {
+        return {};
+    }
 
-    // create a new graph with a new vertex
-    Graph newGraph;  // we will build a directed graph, and save if g was directed or not
-    bool isDirected = g.isDirectedGraph();
+    // start Bellman-Ford algorithm from a virtual new vertex
+    try {
+        checkNegativeCycle(g);
+    } catch (Algorithms::NegativeCycleException& e) {  // if the graph contains a negative cycle
+        return std::move(e.cycle);
+    }
+    return {};
+}
 
-    vector<vector<int>> newGraphMat(n + 1, vector<int>(n + 1, INF));
-    // copy the graph to the new graph
-    for (size_t i = 0; i < n; i++) {
-        for (size_t j = 0; j < n; j++) {
-            if (i == j) {
-                newGraphMat[i][j] = NO_EDGE;
-            }
-            if (g.getGraph()[i][j] != NO_EDGE) {
-                newGraphMat[i][j] = g.getGraph()[i][j];
-            }
+Algorithms::DistanceTable Algorithms::allPairsShortestPaths(const Graph& g) {
+    /*
+    the distance matrix starts with the weights of the edges (INF if there is no edge, 0 on the diagonal),
+    and the next-hop matrix with the target of every edge. Floyd-Warshall updates both (see floydWarshall in Matrix.cpp).
+
+    Floyd-Warshall can't run on a graph with a negative cycle (the distances keep getting smaller), so if there are negative edges
+    we first look for a negative cycle with Bellman-Ford (O(VE), less than the O(V^3) of Floyd-Warshall).
+    */
+    static_assert(INF == Matrix::NO_PATH, "the distance table uses INF for no path");
+
+    if (g.isHaveNegativeEdgeWeight()) {
+        if (!g.isDirectedGraph()) {
+            throw std::invalid_argument("All pairs shortest paths is not defined on an undirected graph with negative edges");
         }
+        checkNegativeCycle(g);  // throws NegativeCycleException if there is a negative cycle
     }
 
-    // connect the new vertex to all the other vertices with an edge of weight 0 (if NO_EDGE = 0 we will put -1)
-    for (size_t i = 0; i < n; i++) {
-        newGraphMat[n][i] = NO_EDGE != 0 ? 0 : -1;
+    size_t n = g.getNumVertices();
+    Matrix dist(n, INF);
+    Matrix next(n, -1);
+    for (size_t u = 0; u < n; u++) {
+        dist[u][u] = 0;
+        next[u][u] = (int)u;
+        if (g.getStorage() == Storage::BITSET) {
+            forEachBit(g.getBits().row(u), g.getBits().wordsPerRow(), [&](size_t v) {
+                dist[u][v] = 1;
+                next[u][v] = (int)v;
+            });
+        } else {
+            for (auto [v, weight] : g.neighbors(u)) {
+                dist[u][v] = weight;
+                next[u][v] = (int)v;
+            }
+        }
     }
-    newGraphMat[n][n] = NO_EDGE;
 
-    newGraph.loadGraph(newGraphMat);
+    floydWarshall(&dist, &next);
+    return DistanceTable(std::move(dist), std::move(next));
+}
 
-    // start Bellman-Ford algorithm from the new vertex`
-    try {
-        bellmanFord(newGraph, n, isDirected);
-    } catch (Algorithms::NegativeCycleException e) {  // if the graph contains a negative cycle
-        // get the negative cycle
-        vector<size_t> cycle = e.cycle;
-        string cycleStr = std::to_string(cycle[0]);
-        for (size_t i = 1; i < cycle.size(); i++) {
-            cycleStr += "->" + std::to_string(cycle[i]);
-        }
-        return cycleStr;
+vector<size_t> Algorithms::DistanceTable::pathVertices(size_t src, size_t dest) const {
+    requireVertices(src, dest);
+    vector<size_t> path;
+    if (dist[src][dest] == INF) {
+        return path;
+    }
+
+    // follow the next hops from src to dest
+    path.push_back(src);
+    for (size_t v = src; v != dest;) {
+        v = (size_t)next[v][dest];
+        path.push_back(v);
     }
-    return "No negative cycle";
+    return path;
+}
+
+string Algorithms::DistanceTable::path(size_t src, size_t dest) const {
+    return pathString(pathVertices(src, dest));
 }
 
 // ~~~ implement the helper functions ~~~
 
-// ~ DFS ~
+// ~ parallel loops ~
 
 /**
-  @brief Perform DFS on the graph
-  @param g - the graph to perform DFS on
-  @return a list of vertices in the order they were discovered
-*/
-vector<vector<size_t>> dfs(const Graph& g) {
-    size_t n = g.getGraph().size();
-    // create a list of colors for the vertices
-    vector<Color> colors(n, WHITE);
+ * @brief the number of cores. hardware_concurrency reads it from the system on every call (microseconds), so it is read once
+ */
+size_t hardwareThreads() {
+    static const size_t threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    return threads;
+}
+
+/**
+ * @brief the number of threads for a loop that checks the given number of edges (1 for a small loop)
+ */
+size_t threadsFor(size_t edges) { return std::max<size_t>(1, std::min(hardwareThreads(), edges / MIN_PARALLEL_EDGES)); }
 
-    // create result dfs "tree" (we will return it as a matrix of edges)
-    vector<vector<size_t>> dfsTree;
+/**
+ * @brief call func(thread, begin, end) on blocks of PARALLEL_BLOCK items that cover [0, count), on numThreads threads.
+ * thread is the index of the thread that calls func (0..numThreads-1), so func can keep a part of its result for every thread.
+ */
+template <typename Func>
+void forEachBlock(size_t count, size_t numThreads, Func func) {
+    numThreads = std::min(numThreads, (count + PARALLEL_BLOCK - 1) / PARALLEL_BLOCK);
+    if (numThreads <= 1) {
+        func(0, 0, count);
+        return;
+    }
 
-    // start loop over all vertices
-    for (size_t i = 0; i < n; i++) {
-        if (colors[i] == WHITE) {
-            // do DFS from vertex i
-            dfsTree.push_back(dfs(g, i, &colors));
+    // the only shared state is the next block to take
+    std::atomic<size_t> nextBlock{0};
+    auto worker = [&](size_t thread) {
+        for (size_t begin = nextBlock.fetch_add(PARALLEL_BLOCK); begin < count; begin = nextBlock.fetch_add(PARALLEL_BLOCK)) {
+            func(thread, begin, std::min(begin + PARALLEL_BLOCK, count));
         }
+    };
+
+    vector<std::thread> threads;
+    threads.reserve(numThreads - 1);
+    for (size_t t = 1; t < numThreads; t++) {
+        threads.emplace_back(worker, t);
+    }
+    worker(0);  // the current thread works too
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+// ~ level synchronous BFS ~
+
+LevelBfs::LevelBfs(const Graph& g, bool undirected)
+    : g(g),
+      undirected(undirected && g.isDirectedGraph()),
+      maxThreads(hardwareThreads()),
+      distances(g.getNumVertices(), INF),
+      parents(g.getNumVertices()),
+      unreachedEdges(g.getCSR().targets.size() * (this->undirected ? 2 : 1)),
+      next(maxThreads) {
+    for (std::atomic<int>& parent : parents) {
+        parent.store(-1, std::memory_order_relaxed);
+    }
+    if (this->undirected && g.getNumVertices() > 0) {
+        g.inNeighbors(0);  // build the in edges index now, and not in all the threads at once
     }
-    return dfsTree;
 }
 
 /**
- * @brief Perform DFS from a given source vertex
- * @param g - the graph to perform DFS on
- * @param src - the source vertex to start DFS from
- * @param colors - colors of the vertices
- * @return a list of vertices in the order they were discovered
+ * @brief the number of edges that the search checks from u
  */
-vector<size_t> dfs(const Graph& g, size_t src, vector<Color>* colors) {
-    size_t n = g.getGraph().size();
+size_t LevelBfs::degree(size_t u) const { return g.neighbors(u).size() + (undirected ? g.inNeighbors(u).size() : 0); }
 
-    vector<size_t> dfsOrder;
+/**
+ * @brief the smallest neighbor of v in the given level (the in neighbors are sorted, so it's the first one), -1 if there is none
+ */
+int LevelBfs::firstInFrontier(size_t v, int level) const {
+    int first = -1;
+    for (Neighbor neighbor : g.inNeighbors(v)) {
+        if (distances[neighbor.vertex] == level) {
+            first = (int)neighbor.vertex;
+            break;
+        }
+    }
+    if (undirected) {
+        for (Neighbor neighbor : g.neighbors(v)) {
+            if (first != -1 && neighbor.vertex >= (size_t)first) {
+                break;
+            }
+            if (distances[neighbor.vertex] == level) {
+                first = (int)neighbor.vertex;
+                break;
+            }
+        }
+    }
+    return first;
+}
 
-    // create a stack to store the vertices (instead of recursion)
-    vector<size_t> stack;
+void LevelBfs::topDown(size_t numThreads) {
+    forEachBlock(frontier.size(), numThreads, [&](size_t thread, size_t begin, size_t end) {
+        vector<size_t>& found = next[thread];
+        for (size_t i = begin; i < end; i++) {
+            int u = (int)frontier[i];
+            auto visit = [&](size_t v) {
+                if (distances[v] != INF) {
+                    return;
+                }
+                // the first thread that claims v adds it to the next frontier, and every thread leaves the smallest parent
+                int old = parents[v].load(std::memory_order_relaxed);
+                while ((old == -1 || u < old) && !parents[v].compare_exchange_weak(old, u, std::memory_order_relaxed)) {
+                }
+                if (old == -1) {
+                    found.push_back(v);
+                }
+            };
+            for (Neighbor neighbor : g.neighbors((size_t)u)) {
+                visit(neighbor.vertex);
+            }
+            if (undirected) {
+                for (Neighbor neighbor : g.inNeighbors((size_t)u)) {
+                    visit(neighbor.vertex);
+                }
+            }
+        }
+    });
+}
 
-    stack.push_back(src);
-    while (!stack.empty()) {
-        // get the last vertex from the stack
-        size_t u = stack.back();
-        stack.pop_back();
-        if ((*colors)[u] == WHITE) {  // if the vertex is white - we just discovered it
-            // discover the vertex and loop over its neighbors
-            (*colors)[u] = GRAY;
-            dfsOrder.push_back(u);
-            for (size_t v = 0; v < n; v++) {
-                if (g.getGraph()[u][v] != NO_EDGE) {  // if there is an edge between u and v
-                    if ((*colors)[v] == WHITE) {      // if we didn't discover v yet
-                        stack.push_back(v);           // add v to the stack
-                    }
+void LevelBfs::bottomUp(int level, size_t numThreads) {
+    forEachBlock(distances.size(), numThreads, [&](size_t thread, size_t begin, size_t end) {
+        vector<size_t>& found = next[thread];
+        for (size_t v = begin; v < end; v++) {
+            if (distances[v] != INF) {
+                continue;
+            }
+            // a vertex of an earlier search can't be a neighbor of v in the current level - that search would have reached v
+            int parent = firstInFrontier(v, level);
+            if (parent != -1) {
+                parents[v].store(parent, std::memory_order_relaxed);
+                found.push_back(v);
+            }
+        }
+    });
+}
+
+size_t LevelBfs::search(size_t src, size_t dest) {
+    size_t n = distances.size();
+    distances[src] = 0;
+    frontier.assign(1, src);
+    size_t frontierEdges = degree(src);
+    unreachedEdges -= frontierEdges;
+    size_t count = 1;
+
+    bool isBottomUp = false;
+    for (int level = 0; !frontier.empty() && (dest == NO_TARGET || distances[dest] == INF); level++) {
+        if (!isBottomUp && frontierEdges > unreachedEdges / BFS_ALPHA) {
+            isBottomUp = true;
+        } else if (isBottomUp && frontier.size() < n / BFS_BETA) {
+            isBottomUp = false;
+        }
+
+        if (isBottomUp) {
+            bottomUp(level, threadsFor(unreachedEdges + n));
+        } else {
+            topDown(threadsFor(frontierEdges));
+        }
+
+        // the distances are only written between the levels (the threads read them)
+        frontier.clear();
+        frontierEdges = 0;
+        for (vector<size_t>& found : next) {
+            for (size_t v : found) {
+                distances[v] = level + 1;
+                frontierEdges += degree(v);
+            }
+            frontier.insert(frontier.end(), found.begin(), found.end());
+            found.clear();
+        }
+        unreachedEdges -= frontierEdges;
+        count += frontier.size();
+    }
+    return count;
+}
+
+vector<int> LevelBfs::getParents() const {
+    vector<int> result(parents.size());
+    for (size_t v = 0; v < parents.size(); v++) {
+        result[v] = parents[v].load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+// ~ connected components ~
+
+Algorithms::Components Algorithms::connectedComponents(const Graph& g) { return IncrementalComponents(g).components(); }
+
+Algorithms::IncrementalComponents::IncrementalComponents(const Graph& g) : sets(g.getNumVertices()), numComponents(g.getNumVertices()) {
+    size_t n = g.getNumVertices();
+    bool isBits = g.getStorage() == Storage::BITSET;
+    size_t edges = isBits ? n * g.getBits().wordsPerRow() : g.getCSR().targets.size();
+
+    // every thread unites the edges of its blocks of vertices. in an undirected graph every edge is in the rows of both of its vertices,
+    // so only the edges (u, v) with u < v are needed
+    bool both = !g.isDirectedGraph();
+    std::atomic<size_t> unions{0};
+    forEachBlock(n, threadsFor(edges), [&](size_t /*thread*/, size_t begin, size_t end) {
+        size_t merged = 0;
+        for (size_t u = begin; u < end; u++) {
+            auto unite = [&](size_t v) {
+                if ((!both || u < v) && sets.unite(u, v)) {
+                    merged++;
+                }
+            };
+            if (isBits) {
+                forEachBit(g.getBits().row(u), g.getBits().wordsPerRow(), unite);
+            } else {
+                for (Neighbor neighbor : g.neighbors(u)) {
+                    unite(neighbor.vertex);
                 }
             }
-        } else if ((*colors)[u] == GRAY) {
-            (*colors)[u] = BLACK;
         }
+        unions.fetch_add(merged, std::memory_order_relaxed);
+    });
+    numComponents -= unions.load();
+}
+
+void Algorithms::IncrementalComponents::addEdges(const vector<Edge>& edges) {
+    for (const Edge& e : edges) {
+        requireVertex(e.from);
+        requireVertex(e.to);
     }
 
-    return dfsOrder;
-};
+    std::atomic<size_t> unions{0};
+    forEachBlock(edges.size(), threadsFor(edges.size()), [&](size_t /*thread*/, size_t begin, size_t end) {
+        size_t merged = 0;
+        for (size_t i = begin; i < end; i++) {
+            if (sets.unite(edges[i].from, edges[i].to)) {
+                merged++;
+            }
+        }
+        unions.fetch_add(merged, std::memory_order_relaxed);
+    });
+    numComponents -= unions.load();
+}
 
-// ~ Shortest Path algorithms ~
-pair<vector<int>, vector<int>> bfs(const Graph& g, size_t src) {
-    size_t n = g.getGraph().size();
+Algorithms::Components Algorithms::IncrementalComponents::components() const {
+    size_t n = sets.size();
+    Components result;
+    result.component.resize(n);
+    result.sizes.reserve(numComponents);
+
+    // the root of a set is its smallest vertex, so the root of v gets its number before v
+    for (size_t v = 0; v < n; v++) {
+        size_t root = sets.find(v);
+        if (root == v) {
+            result.component[v] = result.sizes.size();
+            result.sizes.push_back(0);
+        } else {
+            result.component[v] = result.component[root];
+        }
+        result.sizes[result.component[v]]++;
+    }
+    result.condensation.offsets.assign(result.count() + 1, 0);
+    return result;
+}
 
-    // init the distances and parents vectors
-    vector<int> distances(n, INF);
-    vector<int> parents(n, -1);
+// ~ strongly connected components ~
 
-    // add the source vertex to the queue and set its distance to 0
-    distances[src] = 0;
-    std::queue<size_t> q;
-    q.push(src);
+/**
+ * @brief Tarjan's strongly connected components without recursion, with the one array of Pearce ("A space-efficient algorithm for finding
+ * strongly connected components"): rindex[v] is the discovery time of v (the lowest time it reaches while it is on the stack), and
+ * when the component of v is finished it becomes the id of the component. the ids count down from n and the times count up from 1,
+ * so a finished vertex never lowers the time of another vertex. every edge reads one number, instead of the index, low and
+ * on stack of every vertex. the call stack is a vector of (vertex, cursor) frames, so a path of millions of vertices doesn't overflow
+ * the stack of the thread.
+ * @param n - the number of vertices
+ * @param next - next(u, &cursor) returns the neighbor of u at the cursor and moves the cursor after it, or n if there are no more
+ * neighbors (the cursor starts at 0)
+ * @param count - the number of components (will be set)
+ * @return the component of every vertex, in topological order (every edge between two components goes from the smaller id to the bigger one)
+ */
+template <typename Next>
+vector<size_t> tarjan(size_t n, Next next, size_t* count) {
+    constexpr size_t UNVISITED = 0;
+    vector<size_t> rindex(n, UNVISITED);
+    vector<bool> isRoot(n, false);        // v is the first vertex of its component so far
+    vector<size_t> stack;                 // the finished vertices of the components that are not finished
+    vector<pair<size_t, size_t>> frames;  // the DFS path: (vertex, cursor)
+    size_t time = 1;
+    size_t id = n;  // the id of the next component
+
+    auto discover = [&](size_t v) {
+        rindex[v] = time++;
+        isRoot[v] = true;
+        frames.emplace_back(v, 0);
+    };
+    auto lower = [&](size_t u, size_t low) {  // u reaches a vertex with the time low
+        if (low < rindex[u]) {
+            rindex[u] = low;
+            isRoot[u] = false;
+        }
+    };
 
-    while (!q.empty()) {
-        size_t u = q.front();
-        q.pop();
-        for (size_t v = 0; v < n; v++) {
-            if (g.getGraph()[u][v] != NO_EDGE) {
-                if (distances[v] == INF) {  // if the vertex is not discovered yet
-                    distances[v] = distances[u] + 1;
-                    parents[v] = (int)u;
-                    q.push(v);
+    for (size_t root = 0; root < n; root++) {
+        if (rindex[root] != UNVISITED) {
+            continue;
+        }
+        discover(root);
+        while (!frames.empty()) {
+            // go over the neighbors of u until a new vertex is found (the low time of u is kept in a register meanwhile)
+            size_t u = frames.back().first;
+            size_t* cursor = &frames.back().second;
+            size_t low = rindex[u];
+            size_t v = next(u, cursor);
+            for (; v != n && rindex[v] != UNVISITED; v = next(u, cursor)) {
+                low = std::min(low, rindex[v]);
+            }
+            lower(u, low);
+            if (v != n) {
+                discover(v);
+                continue;
+            }
+
+            // all the neighbors of u are done - return to its parent
+            frames.pop_back();
+            if (!isRoot[u]) {
+                stack.push_back(u);
+            } else {  // u is the root of a component - the component is u and the top of the stack down to the vertices before u
+                time--;
+                while (!stack.empty() && rindex[u] <= rindex[stack.back()]) {
+                    rindex[stack.back()] = id;
+                    stack.pop_back();
+                    time--;
                 }
+                rindex[u] = id--;
+            }
+            if (!frames.empty()) {
+                lower(frames.back().first, rindex[u]);
             }
         }
     }
 
-    return {distances, parents};
+    // the first component that is finished reaches no other component (it got the id n), so the ids are already in topological order
+    *count = n - id;
+    for (size_t& c : rindex) {
+        c -= id + 1;
+    }
+    return rindex;
+}
+
+// ~ Shortest Path algorithms ~
+pair<vector<int>, vector<int>> bfs(const Graph& g, size_t src, size_t dest) {
+    if (g.getStorage() == Storage::BITSET) {
+        return bfsBits(g, src, dest);
+    }
+
+    // the search stops after the level of dest - the parent of a vertex doesn't change after its level, so the path to dest is ready
+    LevelBfs levels(g, false);
+    levels.search(src, dest);
+    return {levels.getDistances(), levels.getParents()};
+}
+
+/**
+ * @brief Find a negative cycle in the graph: perform Bellman-Ford from a virtual new vertex with an edge of weight 0 to all the other vertices
+ * (SUPER_SOURCE - every vertex starts at distance 0, so there is no need to build a graph with one more vertex).
+ * in a directed graph the distances are kept on the graph as the potentials of Johnson's reweighting (see johnsonPotentials),
+ * and if they are already there the graph has no negative cycle.
+ * @param g - the graph to search in
+ * @throws NegativeCycleException if the graph contains a negative cycle (with the cycle)
+ */
+void checkNegativeCycle(const Graph& g) {
+    if (!g.isDirectedGraph()) {
+        bellmanFord(g, SUPER_SOURCE, false);
+        return;
+    }
+
+    std::shared_ptr<const vector<int>> potentials = g.getPotentials();
+    if (potentials && !potentials->empty()) {
+        return;
+    }
+    try {
+        g.setPotentials(std::make_shared<const vector<int>>(spfa(g, SUPER_SOURCE).first));
+    } catch (Algorithms::NegativeCycleException&) {
+        g.setPotentials(std::make_shared<const vector<int>>());  // empty - the graph has a negative cycle
+        throw;
+    }
+}
+
+/**
+ * @brief The potentials of Johnson's reweighting of a directed graph: p(v) is the distance from the virtual vertex of checkNegativeCycle to v,
+ * so w(u, v) + p(u) - p(v) >= 0 for every edge and Dijkstra can run on these weights (the shortest paths are the same).
+ * Bellman-Ford runs once, and the potentials are kept on the graph until it changes.
+ * @return the potentials, empty if the graph has a negative cycle
+ */
+std::shared_ptr<const vector<int>> johnsonPotentials(const Graph& g) {
+    if (!g.getPotentials()) {
+        try {
+            checkNegativeCycle(g);
+        } catch (Algorithms::NegativeCycleException&) {  // the empty potentials are kept
+        }
+    }
+    return g.getPotentials();
 }
 
 pair<vector<int>, vector<int>> bellmanFord(const Graph& g, size_t src) {
@@ -430,34 +1067,39 @@ pair<vector<int>, vector<int>> bellmanFord(const Graph& g, size_t src) {
 }
 
 pair<vector<int>, vector<int>> bellmanFord(const Graph& g, size_t src, bool isDirected) {
-    size_t n = g.getGraph().size();
-    vector<int> distances(n, INF);
+    if (isDirected) {
+        return spfa(g, src);
+    }
+
+    // in an undirected graph the edge back to the parent is skipped, and the result depends on the order of the relaxations in every round,
+    // so it keeps the rounds over all the edges
+    size_t n = g.getNumVertices();
+    vector<int> distances(n, src == SUPER_SOURCE ? 0 : INF);
     vector<int> parents(n, -1);
 
-    distances[src] = 0;
+    if (src != SUPER_SOURCE) {
+        distances[src] = 0;
+    }
     // relax all edges n-1 times
     for (size_t i = 0; i < n - 1; i++) {
         bool relaxed = false;  // if we dont relax any edge in the current iteration, then we can break the loop
         // for each edge (u, v) in the graph
         for (size_t u = 0; u < n; u++) {
-            for (size_t v = 0; v < n; v++) {
-                // if there is an edge between u and v
-                if (g.getGraph()[u][v] != NO_EDGE) {
-                    // if the graph is undirected, we should ignore the edge that connects the current vertex to its parent
-                    if (!isDirected && parents[u] == (int)v) {
-                        continue;
-                    }
+            // relax the edges (u, v)
+            if (distances[u] == INF) {
+                continue;
+            }
 
-                    // relax the edge (u, v)
-                    if (distances[u] == INF || g.getGraph()[u][v] == NO_EDGE) {
-                        continue;
-                    }
+            for (auto [v, weight] : g.neighbors(u)) {
+                // if the graph is undirected, we should ignore the edge that connects the current vertex to its parent
+                if (!isDirected && parents[u] == (int)v) {
+                    continue;
+                }
 
-                    if (distances[u] + g.getGraph()[u][v] < distances[v]) {
-                        distances[v] = distances[u] + g.getGraph()[u][v];
-                        parents[v] = (int)u;
-                        relaxed = true;
-                    }
+                if (distances[u] + weight < distances[v]) {
+                    distances[v] = distances[u] + weight;
+                    parents[v] = (int)u;
+                    relaxed = true;
                 }
             }
         }
@@ -468,21 +1110,23 @@ pair<vector<int>, vector<int>> bellmanFord(const Graph& g, size_t src, bool isDi
 
     // check for negative-weight cycles
     for (size_t u = 0; u < n; u++) {
-        for (size_t v = 0; v < n; v++) {
-            if (g.getGraph()[u][v] != NO_EDGE) {
-                // if the graph is undirected, we should ignore the edge that connects the current vertex to its parent
-                if (!isDirected && parents[u] == (int)v) {
-                    continue;
-                }
+        if (distances[u] == INF) {
+            continue;
+        }
 
-                if (distances[u] == INF || g.getGraph()[u][v] == INF) {
-                    continue;
-                }
+        for (auto [v, weight] : g.neighbors(u)) {
+            // if the graph is undirected, we should ignore the edge that connects the current vertex to its parent
+            if (!isDirected && parents[u] == (int)v) {
+                continue;
+            }
 
-                if (distances[u] + g.getGraph()[u][v] < distances[v]) {
-                    parents[v] = (int)u;
-                    throw Algorithms::NegativeCycleException(v, parents);
-                }
+            if (weight == INF) {
+                continue;
+            }
+
+            if (distances[u] + weight < distances[v]) {
+                parents[v] = (int)u;
+                throw Algorithms::NegativeCycleException(v, parents);
             }
         }
     }
@@ -491,123 +1135,705 @@ pair<vector<int>, vector<int>> bellmanFord(const Graph& g, size_t src, bool isDi
 }
 
 /**
- * @brief Perform Dijkstra's algorithm from a given source vertex
+ * @brief Bellman-Ford with a queue (SPFA): only the edges out of the vertices whose distance changed are relaxed, so on a graph with a few
+ * negative edges every vertex is relaxed a few times and not in V - 1 rounds over all the edges.
+ * a negative cycle never lets the queue empty, so every |V| relaxations the parents are checked for a cycle - a cycle of parents is
+ * always a negative cycle, and it shows up long before the V - 1 rounds of Bellman-Ford are over.
+ * @param src - the source vertex, or SUPER_SOURCE
+ * @return the distances and the parents, like bellmanFord
+ * @throws NegativeCycleException if there is a negative cycle that can be reached from src
+ */
+pair<vector<int>, vector<int>> spfa(const Graph& g, size_t src) {
+    size_t n = g.getNumVertices();
+    vector<int> distances(n, src == SUPER_SOURCE ? 0 : INF);
+    vector<int> parents(n, -1);
+
+    // a vertex is at most once in the queue, so a circular buffer of n vertices is enough
+    vector<size_t> queue(n);
+    vector<bool> inQueue(n, false);
+    size_t head = 0;
+    size_t count = 0;
+    auto push = [&](size_t v) {
+        queue[(head + count) % n] = v;
+        inQueue[v] = true;
+        count++;
+    };
+
+    if (src == SUPER_SOURCE) {
+        for (size_t v = 0; v < n; v++) {
+            push(v);
+        }
+    } else {
+        distances[src] = 0;
+        push(src);
+    }
+    size_t relaxations = 0;
+    while (count > 0) {
+        size_t u = queue[head];
+        head = (head + 1) % n;
+        count--;
+        inQueue[u] = false;
+
+        for (auto [v, weight] : g.neighbors(u)) {
+            if (distances[u] + weight < distances[v]) {
+                distances[v] = distances[u] + weight;
+                parents[v] = (int)u;
+                if (++relaxations % n == 0) {
+                    int cycleVertex = findParentCycle(parents);
+                    if (cycleVertex != -1) {
+                        throw Algorithms::NegativeCycleException((size_t)cycleVertex, parents);
+                    }
+                }
+                if (!inQueue[v]) {
+                    push(v);
+                }
+            }
+        }
+    }
+
+    return {distances, parents};
+}
+
+/**
+ * @brief Find a cycle in the graph of the parents (every vertex has at most one parent, so it is a walk from every vertex). O(V)
+ * @return a vertex on the cycle, -1 if there is no cycle
+ */
+int findParentCycle(const vector<int>& parents) {
+    size_t n = parents.size();
+    vector<size_t> walk(n, n);  // walk[v] - the first vertex of the walk that visited v (n if v was not visited)
+    for (size_t start = 0; start < n; start++) {
+        int v = (int)start;
+        while (v != -1 && walk[(size_t)v] == n) {
+            walk[(size_t)v] = start;
+            v = parents[(size_t)v];
+        }
+        if (v != -1 && walk[(size_t)v] == start) {  // this walk came back to one of its own vertices
+            return v;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Dijkstra on the weights of Johnson's reweighting, w(u, v) + p(u) - p(v) (they are not negative, but may be 0).
+ * a path is shorter than another path between the same vertices in the new weights iff it is shorter in the real weights,
+ * and at the end the distances are moved back to the real weights.
+ * @param dest - stop when this vertex is settled (NO_TARGET to reach all the vertices)
+ */
+pair<vector<int>, vector<int>> reducedDijkstra(const Graph& g, size_t src, size_t dest, const vector<int>& potentials) {
+    size_t n = g.getNumVertices();
+    auto reducedWeight = [&potentials](size_t u, size_t v, int weight) { return weight + potentials[u] - potentials[v]; };
+
+    // the biggest new weight decides the queue, like in dijkstra
+    const CSR& csr = g.getCSR();
+    int maxWeight = 0;
+    for (size_t u = 0; u < n; u++) {
+        for (size_t i = csr.offsets[u]; i < csr.offsets[u + 1]; i++) {
+            maxWeight = std::max(maxWeight, reducedWeight(u, csr.targets[i], csr.weights[i]));
+        }
+    }
+    pair<vector<int>, vector<int>> result =
+        maxWeight <= DIAL_MAX_WEIGHT ? dialDijkstra(g, src, maxWeight, dest, reducedWeight) : heapDijkstra(g, src, dest, reducedWeight);
+
+    vector<int>& distances = result.first;
+    for (size_t v = 0; v < n; v++) {
+        if (distances[v] != INF) {
+            distances[v] += potentials[v] - potentials[src];
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Perform Dijkstra's algorithm from a given source vertex.
+ * the weights are positive (NO_EDGE is 0), so when all of them are small (at most DIAL_MAX_WEIGHT) the queue is Dial's buckets,
+ * otherwise it is a 4-ary lazy heap. both settle the vertices in the order of (distance, vertex), so the paths are the same.
  * @param g - the graph to perform Dijkstra's algorithm on (must be a non-negative weighted graph)
  * @param src - the source vertex to start Dijkstra's algorithm from
+ * @param dest - stop when this vertex is settled (the distances of the vertices that are not settled yet are not final)
  * @return a pair of two vectors:
  * 1. the first vector contains the distance from the source vertex to each vertex in the graph
  * 2. the second vector contains the parent of each vertex in the graph in the BFS tree
  *
  */
-pair<vector<int>, vector<int>> dijkstra(const Graph& g, size_t src) {
-    size_t n = g.getGraph().size();
+pair<vector<int>, vector<int>> dijkstra(const Graph& g, size_t src, size_t dest) {
+    const vector<int>& weights = g.getCSR().weights;
+    int maxWeight = weights.empty() ? 1 : *std::max_element(weights.begin(), weights.end());  // one pass over an int array, much less than the search
+    auto weightOf = [](size_t, size_t, int weight) { return weight; };
+    if (maxWeight <= DIAL_MAX_WEIGHT) {
+        return dialDijkstra(g, src, maxWeight, dest, weightOf);
+    }
+    return heapDijkstra(g, src, dest, weightOf);
+}
+
+/**
+ * @brief Dijkstra with Dial's buckets (BucketQueue): every bucket is the list of the vertices with one distance, and with weights in
+ * [0, maxWeight] only maxWeight + 1 buckets are in use at a time. O(E + V + the longest distance) - no heap at all.
+ * in the graph itself no edge has weight 0, so the vertices of the current bucket can't add to it: the bucket is settled in increasing order
+ * of the vertices (the same order as a heap of (distance, vertex)). an edge of weight 0 (after Johnson's reweighting) adds to the current
+ * bucket, and the bucket is taken again after it.
+ * @param weightOf weightOf(u, v, weight) - the weight that the search uses for the edge (u, v)
+ */
+template <typename Weight>
+pair<vector<int>, vector<int>> dialDijkstra(const Graph& g, size_t src, int maxWeight, size_t dest, Weight weightOf) {
+    size_t n = g.getNumVertices();
     vector<int> distances(n, INF);
     vector<int> parents(n, -1);
 
-    // create priority queue - min heap
-    /* in here:
-    1. pair<int, size_t> - first int is the distance from the source vertex to the vertex, second int is the vertex
-    2. vector<pair<int, size_t>> - the type of the container (what is the container that holds the elements)
-    3. greater<pair<int, int>> - the comparator (how to compare the elements in the container)
-        greater is a functor that compares two elements and returns true if the first element is greater than the second element
-        when we pass pair<int, int> to the priority_queue, it will compare the first element of the pair
-    */
-    std::priority_queue<pair<int, size_t>, vector<pair<int, size_t>>, std::greater<pair<int, int>>> pq;
-
-    // initialize source vertex
+    BucketQueue queue((size_t)maxWeight);
     distances[src] = 0;
-    pq.push(std::make_pair(0, src));
-
-    while (!pq.empty()) {
-        // get the vertex with the smallest distance
-        size_t u = pq.top().second;
-        pq.pop();
+    queue.push(src, 0);
+
+    vector<size_t> bucket;
+    while (!queue.empty()) {
+        int distance = (int)queue.popBucket(&bucket);
+        // the entries of vertices that got a shorter distance after they were pushed are not up to date
+        bucket.erase(std::remove_if(bucket.begin(), bucket.end(), [&](size_t u) { return distances[u] != distance; }), bucket.end());
+        std::sort(bucket.begin(), bucket.end());
+        if (dest != NO_TARGET && distances[dest] == distance) {  // dest is in this bucket, so it is settled
+            break;
+        }
 
-        // for each neighbor of u
-        for (size_t v = 0; v < n; v++) {
-            if (g.getGraph()[u][v] != NO_EDGE) {
-                // relax the edge
-                int currDist = distances[u] + g.getGraph()[u][v];
+        for (size_t u : bucket) {
+            for (auto [v, weight] : g.neighbors(u)) {
+                int currDist = distance + weightOf(u, v, weight);
                 if (currDist < distances[v]) {
                     distances[v] = currDist;
-                    parents[v] = u;
-                    pq.push(std::make_pair(distances[v], v));
+                    parents[v] = (int)u;
+                    queue.push(v, (size_t)currDist);
                 }
             }
         }
     }
 
-    return make_pair(distances, parents);
+    return {distances, parents};
 }
 
-// ~ Cycle detection ~
-
 /**
- * @brief Check if the graph contains a cycle
- * @param g - the graph to check
- * @param src - the source vertex to start the DFS from
- * @param colors - colors of the vertices
- * @param parents - the parent of each vertex in the DFS tree
- * @param path - a vector to store sequence of vertices visited in during the DFS.
- * @return the cycle path in the format "v1->v2->...->v1" if a cycle is detected, otherwise return an empty string
+ * @brief Dijkstra with a 4-ary lazy heap (LazyHeap): a shorter distance pushes a new entry, and an entry whose distance is not the
+ * distance of its vertex anymore is skipped when it is popped. the entries are popped in the order of (distance, vertex), so the vertices
+ * are settled in the same order as with decrease-key. the heap has up to E entries instead of V, but a step of the heap is cheaper than
+ * in IndexedHeap (no position array to update), and on grids with big weights it is ~10% faster. O(E log E)
+ * @param weightOf weightOf(u, v, weight) - the weight that the search uses for the edge (u, v)
  */
-string isContainsCycleUtil(const Graph& g, size_t src, vector<Color>* colors, vector<int>* parents, vector<int>* path) {
-    /*
-    the path vector is used to store the sequence of vertices visited during the DFS.
-    when  a vertex is visited, it is added to the path.
-    when all the adjacent vertices of a vertex have been visited, the vertex is removed from the path.
-    if a cycle is detected, the path at that point in time represents the cycle.
-    the end of the cycle is the vertex that is being visited when the cycle is detected. (start of the cycle is the same as the end of the cycle)
-    */
+template <typename Weight>
+pair<vector<int>, vector<int>> heapDijkstra(const Graph& g, size_t src, size_t dest, Weight weightOf) {
+    size_t n = g.getNumVertices();
+    vector<int> distances(n, INF);
+    vector<int> parents(n, -1);
 
-    (*colors)[src] = GRAY;
-    path->push_back(src);  // add the vertex to the path
-
-    // loop over all the neighbors of the vertex
-    for (size_t v = 0; v < g.getGraph().size(); v++) {
-        if (g.getGraph()[src][v] != NO_EDGE) {
-            if ((*colors)[v] == WHITE) {
-                // dfs on the neighbor
-                (*parents)[v] = (int)src;
-                string cycle = isContainsCycleUtil(g, v, colors, parents, path);
-                if (!cycle.empty()) {  // if a cycle is detected
-                    return cycle;
+    LazyHeap<4> heap;
+    distances[src] = 0;
+    heap.push(src, 0);
+
+    while (!heap.empty()) {
+        int distance;
+        size_t u = heap.pop(&distance);
+        if (distance != distances[u]) {  // u got a shorter distance after this entry was pushed, and it is already settled
+            continue;
+        }
+        if (u == dest) {
+            break;
+        }
+        for (auto [v, weight] : g.neighbors(u)) {
+            int currDist = distance + weightOf(u, v, weight);
+            if (currDist < distances[v]) {
+                distances[v] = currDist;
+                parents[v] = (int)u;
+                heap.push(v, currDist);
+            }
+        }
+    }
+
+    return {distances, parents};
+}
+
+/**
+ * @brief BFS from src on the out edges and from dest on the in edges at the same time. every step expands a whole level of the smaller
+ * frontier, and the search stops after the level where the two searches meet (the shortest path is the best edge between them in this level).
+ * when the levels grow fast (like in a random graph) the two searches together see much less vertices than one BFS to the same depth.
+ * @return the vertices of a shortest path from src to dest, empty if there is no path
+ */
+vector<size_t> bidirectionalBfs(const Graph& g, size_t src, size_t dest) {
+    size_t n = g.getNumVertices();
+    vector<int> distancesFromSrc(n, INF);
+    vector<int> distancesToDest(n, INF);
+    vector<int> parentsFromSrc(n, -1);  // the parent of v in the BFS tree of src
+    vector<int> nextToDest(n, -1);      // the parent of v in the BFS tree of dest on the in edges - the vertex after v on the path to dest
+
+    distancesFromSrc[src] = 0;
+    distancesToDest[dest] = 0;
+    vector<size_t> frontierFromSrc = {src};
+    vector<size_t> frontierToDest = {dest};
+    vector<size_t> nextFrontier;
+
+    int best = INF;  // the length of the shortest path that was found, through the edge (from, to)
+    size_t from = 0;
+    size_t to = 0;
+    while (best == INF && !frontierFromSrc.empty() && !frontierToDest.empty()) {
+        bool forward = frontierFromSrc.size() <= frontierToDest.size();
+        vector<size_t>& frontier = forward ? frontierFromSrc : frontierToDest;
+        vector<int>& distances = forward ? distancesFromSrc : distancesToDest;
+        vector<int>& parents = forward ? parentsFromSrc : nextToDest;
+        const vector<int>& otherDistances = forward ? distancesToDest : distancesFromSrc;
+
+        nextFrontier.clear();
+        for (size_t u : frontier) {
+            for (Neighbor neighbor : forward ? g.neighbors(u) : g.inNeighbors(u)) {
+                size_t v = neighbor.vertex;
+                if (otherDistances[v] != INF && distances[u] + 1 + otherDistances[v] < best) {
+                    best = distances[u] + 1 + otherDistances[v];
+                    from = forward ? u : v;
+                    to = forward ? v : u;
                 }
-            } else if ((*colors)[v] == GRAY) {  // if the neighbor is gray, then we have a cycle
-                // if the graph is undirected, we should ignore the edge that connects the current vertex to its parent
-                if (!g.isDirectedGraph() && (*parents)[src] == (int)v) {
-                    continue;
+                if (distances[v] == INF) {
+                    distances[v] = distances[u] + 1;
+                    parents[v] = (int)u;
+                    nextFrontier.push_back(v);
                 }
-                // construct the cycle path
-                return constructCyclePath(*path, v);
             }
         }
+        frontier.swap(nextFrontier);
     }
-    (*colors)[src] = BLACK;  // the vertex is done, mark it as black
-    path->pop_back();        // remove the vertex from the path because we are done with it
-    return "";
+
+    if (best == INF) {
+        return {};
+    }
+    return joinPaths(parentsFromSrc, nextToDest, from, to);
 }
 
 /**
- * @brief Build the cycle path from the path vector
- * @param path - the path vector - used to store the sequence of vertices visited during the DFS when a cycle is detected
- * @param start - the start/end of the cycle (start == end)
- * @return the cycle path in the format "v1->v2->...->v1"
+ * @brief Dijkstra from src on the out edges and from dest on the in edges, every step settles the vertex with the smaller distance of the two.
+ * when an edge (u, v) connects the two searches, dist(src, u) + w(u, v) + dist(v, dest) is the length of a path. the search stops when
+ * the smallest distances of the two heaps together are not less than the best path, because every path that was not seen is longer.
+ * @return the vertices of a shortest path from src to dest, empty if there is no path
  */
-string constructCyclePath(vector<int>& path, int start) {
-    string cycle;
-    size_t v = 0;
-    // find the start of the cycle in the path
-    for (v = 0; v < path.size(); v++) {
-        if (path[v] == start) {
+vector<size_t> bidirectionalDijkstra(const Graph& g, size_t src, size_t dest) {
+    size_t n = g.getNumVertices();
+    vector<int> distancesFromSrc(n, INF);
+    vector<int> distancesToDest(n, INF);
+    vector<int> parentsFromSrc(n, -1);
+    vector<int> nextToDest(n, -1);
+
+    IndexedHeap<4> heapFromSrc(n);
+    IndexedHeap<4> heapToDest(n);
+    distancesFromSrc[src] = 0;
+    distancesToDest[dest] = 0;
+    heapFromSrc.push(src, 0);
+    heapToDest.push(dest, 0);
+
+    int best = INF;  // the length of the shortest path that was found, through the edge (from, to)
+    size_t from = 0;
+    size_t to = 0;
+    while (!heapFromSrc.empty() && !heapToDest.empty()) {
+        int topFromSrc = distancesFromSrc[heapFromSrc.top()];
+        int topToDest = distancesToDest[heapToDest.top()];
+        if (best != INF && topFromSrc + topToDest >= best) {
             break;
         }
+
+        bool forward = topFromSrc <= topToDest;
+        vector<int>& distances = forward ? distancesFromSrc : distancesToDest;
+        vector<int>& parents = forward ? parentsFromSrc : nextToDest;
+        const vector<int>& otherDistances = forward ? distancesToDest : distancesFromSrc;
+        IndexedHeap<4>& heap = forward ? heapFromSrc : heapToDest;
+
+        size_t u = heap.pop();
+        for (auto [v, weight] : forward ? g.neighbors(u) : g.inNeighbors(u)) {
+            int currDist = distances[u] + weight;
+            if (otherDistances[v] != INF && currDist + otherDistances[v] < best) {
+                best = currDist + otherDistances[v];
+                from = forward ? u : v;
+                to = forward ? v : u;
+            }
+            if (currDist < distances[v]) {
+                distances[v] = currDist;
+                parents[v] = (int)u;
+                heap.push(v, currDist);
+            }
+        }
     }
-    // we start from the start of the cycle, until the end of the path (when the cycle is detected)
-    for (size_t i = v; i < path.size(); i++) {
-        cycle += std::to_string(path[i]) + "->";
+
+    if (best == INF) {
+        return {};
     }
+    return joinPaths(parentsFromSrc, nextToDest, from, to);
+}
 
-    cycle += std::to_string(start);  // to complete the cycle
+/**
+ * @brief the path of a bidirectional search: src -> ... -> from (the tree of src), then to -> ... -> dest (the tree of dest on the in edges)
+ */
+vector<size_t> joinPaths(const vector<int>& parentsFromSrc, const vector<int>& nextToDest, size_t from, size_t to) {
+    vector<size_t> path = treePath(parentsFromSrc, from);
+    for (int v = (int)to; v != -1; v = nextToDest[(size_t)v]) {
+        path.push_back((size_t)v);
+    }
+    return path;
+}
+
+/**
+ * @brief the path from the root of a shortest paths tree to dest: follow the parents from dest and reverse
+ */
+vector<size_t> treePath(const vector<int>& parents, size_t dest) {
+    vector<size_t> path;
+    for (int v = (int)dest; v != -1; v = parents[(size_t)v]) {
+        path.push_back((size_t)v);
+    }
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+/**
+ * @brief a path with its length - the sum of the weights of its edges (INF if there are no vertices). O(path length) lookups of edges
+ */
+Algorithms::Path pathOf(const Graph& g, vector<size_t> vertices) {
+    Algorithms::Path path{std::move(vertices), 0};
+    if (path.vertices.empty()) {
+        path.length = INF;
+    }
+    for (size_t i = 1; i < path.vertices.size(); i++) {
+        path.length += g.getEdgeWeight(path.vertices[i - 1], path.vertices[i]);
+    }
+    return path;
+}
+
+/**
+ * @brief append a number to the string with std::to_chars (no temporary string for every number)
+ */
+void appendNumber(string* out, size_t value) {
+    char text[20];  // the longest size_t
+    out->append(text, std::to_chars(text, text + sizeof(text), value).ptr);
+}
+
+/**
+ * @brief the vertices in the format "v1->v2->...->vk", or "-1" if there are no vertices. O(number of vertices)
+ */
+string pathString(const vector<size_t>& vertices) {
+    if (vertices.empty()) {
+        return "-1";
+    }
+
+    string result;
+    result.reserve(vertices.size() * 8);
+    appendNumber(&result, vertices[0]);
+    for (size_t i = 1; i < vertices.size(); i++) {
+        result += "->";
+        appendNumber(&result, vertices[i]);
+    }
+    return result;
+}
+
+// ~ Cycle detection ~
+
+/**
+ * @brief Build the cycle from the DFS path when a back edge to start is found
+ * @param frames - the DFS path (vertex, cursor), from the root to the vertex of the back edge
+ * @param start - the start/end of the cycle (start == end), a vertex on the path
+ * @return the vertices of the path from start to its end, and start again
+ */
+vector<size_t> cyclePath(const vector<pair<size_t, size_t>>& frames, size_t start) {
+    // find the start of the cycle in the path (from the end - the cycles are usually short)
+    size_t first = frames.size() - 1;
+    while (frames[first].first != start) {
+        first--;
+    }
+    vector<size_t> cycle;
+    cycle.reserve(frames.size() - first + 1);
+    for (size_t i = first; i < frames.size(); i++) {
+        cycle.push_back(frames[i].first);
+    }
+    cycle.push_back(start);  // to complete the cycle
     return cycle;
 }
+
+NeighborCursor::NeighborCursor(const Graph& g) : n(g.getNumVertices()) {
+    if (g.getStorage() == Storage::BITSET) {
+        bits = &g.getBits();
+    } else {
+        csr = &g.getCSR();
+    }
+}
+
+size_t NeighborCursor::operator()(size_t u, size_t* cursor) const {
+    if (bits != nullptr) {
+        size_t v = nextBit(bits->row(u), n, *cursor);
+        *cursor = v + 1;
+        return v;
+    }
+    size_t i = csr->offsets[u] + *cursor;
+    if (i == csr->offsets[u + 1]) {
+        return n;
+    }
+    (*cursor)++;
+    return csr->targets[i];
+}
+
+/**
+ * @brief Build the result string of isBipartite
+ * @param setA - the vertices in the first set
+ * @param setB - the vertices in the second set
+ * @return "The graph is bipartite: A={...}, B={...}"
+ */
+string bipartiteString(const vector<size_t>& setA, const vector<size_t>& setB) {
+    string result = "The graph is bipartite: A={";
+    result.reserve(result.size() + (setA.size() + setB.size()) * 8 + 8);
+    auto appendSet = [&result](const vector<size_t>& set) {
+        for (size_t i = 0; i < set.size(); i++) {
+            if (i > 0) {
+                result += ',';
+            }
+            appendNumber(&result, set[i]);
+        }
+    };
+    appendSet(setA);
+    result += "}, B={";
+    appendSet(setB);
+    result += '}';
+    return result;
+}
+
+// ~ Storage::BITSET ~
+/*
+in a bitset graph, row u of the matrix is the set of the neighbors of u (64 vertices in every word).
+so instead of checking the neighbors one by one, we work on 64 vertices at once:
+- the new vertices that we discover from u are: row(u) AND NOT visited
+- the number of vertices in a set is the popcount of its words
+*/
+
+bool testBit(const vector<uint64_t>& words, size_t i) { return ((words[i / 64] >> (i % 64)) & 1U) != 0; }
+void setBit(vector<uint64_t>* words, size_t i) { (*words)[i / 64] |= uint64_t{1} << (i % 64); }
+void clearBit(vector<uint64_t>* words, size_t i) { (*words)[i / 64] &= ~(uint64_t{1} << (i % 64)); }
+
+/**
+ * @brief Mark all the vertices that are reachable from src and are not visited yet (level by level, a whole frontier at a time)
+ * @param bits - the adjacency matrix
+ * @param src - the source vertex (must not be visited)
+ * @param visited - the visited vertices, will be updated
+ * @return the number of vertices that were marked (including src)
+ */
+size_t reachBits(const BitMatrix& bits, size_t src, vector<uint64_t>* visited) {
+    size_t words = bits.wordsPerRow();
+    vector<uint64_t> frontier(words, 0);
+    vector<uint64_t> next(words, 0);
+
+    setBit(&frontier, src);
+    setBit(visited, src);
+    size_t count = 1;
+
+    bool empty = false;
+    while (!empty) {
+        // next = (OR of the rows of the frontier) AND NOT visited
+        std::fill(next.begin(), next.end(), 0);
+        forEachBit(frontier.data(), words, [&](size_t u) {
+            const uint64_t* row = bits.row(u);
+            for (size_t w = 0; w < words; w++) {
+                next[w] |= row[w];
+            }
+        });
+
+        empty = true;
+        for (size_t w = 0; w < words; w++) {
+            next[w] &= ~(*visited)[w];
+            (*visited)[w] |= next[w];
+            count += (size_t)__builtin_popcountll(next[w]);
+            empty = empty && next[w] == 0;
+        }
+        frontier.swap(next);
+    }
+    return count;
+}
+
+/**
+ * @brief isConnected for undirected Storage::BITSET graphs - check if the vertex 0 reaches all the vertices
+ */
+bool isConnectedBits(const Graph& g) {
+    const BitMatrix& bits = g.getBits();
+    vector<uint64_t> visited(bits.wordsPerRow(), 0);
+    return reachBits(bits, 0, &visited) == g.getNumVertices();
+}
+
+/**
+ * @brief the first set bit in words that is not before from, or n if there is none
+ */
+size_t nextBit(const uint64_t* words, size_t n, size_t from) {
+    if (from >= n) {
+        return n;
+    }
+    size_t w = from / 64;
+    uint64_t word = words[w] & (~uint64_t{0} << (from % 64));
+    size_t wordCount = (n + 63) / 64;
+    while (word == 0) {
+        if (++w == wordCount) {
+            return n;
+        }
+        word = words[w];
+    }
+    return w * 64 + (size_t)__builtin_ctzll(word);
+}
+
+/**
+ * @brief BFS for Storage::BITSET. every level is visited in increasing order, so the parent of a vertex is the smallest vertex of the previous
+ * level that has an edge to it (the same as LevelBfs), but the new neighbors of u are found 64 at a time.
+ */
+pair<vector<int>, vector<int>> bfsBits(const Graph& g, size_t src, size_t dest) {
+    const BitMatrix& bits = g.getBits();
+    size_t n = g.getNumVertices();
+    size_t words = bits.wordsPerRow();
+
+    vector<int> distances(n, INF);
+    vector<int> parents(n, -1);
+    vector<uint64_t> visited(words, 0);
+
+    // the queue is a vector, so we don't need to allocate on every push
+    vector<size_t> queue;
+    queue.reserve(n);
+    queue.push_back(src);
+    setBit(&visited, src);
+    distances[src] = 0;
+
+    size_t levelEnd = 1;
+    for (size_t head = 0; head < queue.size(); head++) {
+        if (head == levelEnd) {  // the next level starts - sort it
+            std::sort(queue.begin() + (std::ptrdiff_t)head, queue.end());
+            levelEnd = queue.size();
+        }
+        size_t u = queue[head];
+        const uint64_t* row = bits.row(u);
+        for (size_t w = 0; w < words; w++) {
+            uint64_t discovered = row[w] & ~visited[w];
+            if (discovered == 0) {
+                continue;
+            }
+            visited[w] |= discovered;
+            forEachBit(&discovered, 1, [&](size_t bit) {
+                size_t v = w * 64 + bit;
+                distances[v] = distances[u] + 1;
+                parents[v] = (int)u;
+                queue.push_back(v);
+            });
+            if (dest != NO_TARGET && distances[dest] != INF) {
+                return {distances, parents};
+            }
+        }
+    }
+
+    return {distances, parents};
+}
+
+/**
+ * @brief findCycle for Storage::BITSET - DFS with an explicit stack.
+ * in every step we check the back edges of the top vertex with row(u) AND gray, and find the next vertex to visit with row(u) AND white.
+ * @return the vertices of the cycle v1, v2, ..., v1, empty if there is no cycle
+ */
+vector<size_t> findCycleBits(const Graph& g) {
+    const BitMatrix& bits = g.getBits();
+    size_t n = g.getNumVertices();
+    size_t words = bits.wordsPerRow();
+
+    vector<uint64_t> white(words, 0);
+    vector<uint64_t> gray(words, 0);
+    for (size_t v = 0; v < n; v++) {
+        setBit(&white, v);
+    }
+
+    vector<size_t> path;  // the gray vertices, from the root of the DFS tree to the current vertex
+    vector<size_t> parents(n, n);
+
+    for (size_t root = 0; root < n; root++) {
+        if (!testBit(white, root)) {
+            continue;
+        }
+        clearBit(&white, root);
+        setBit(&gray, root);
+        path.push_back(root);
+
+        while (!path.empty()) {
+            size_t u = path.back();
+            const uint64_t* row = bits.row(u);
+
+            // an edge to a gray vertex is a back edge (in undirected graph, the edge to the parent is not a cycle)
+            for (size_t w = 0; w < words; w++) {
+                uint64_t back = row[w] & gray[w];
+                if (!g.isDirectedGraph() && parents[u] != n && parents[u] / 64 == w) {
+                    back &= ~(uint64_t{1} << (parents[u] % 64));
+                }
+                if (back != 0) {
+                    size_t start = w * 64 + (size_t)__builtin_ctzll(back);
+                    vector<size_t> cycle(std::find(path.begin(), path.end(), start), path.end());
+                    cycle.push_back(start);
+                    return cycle;
+                }
+            }
+
+            // visit the first white neighbor, if there is no such neighbor - we are done with u
+            size_t next = n;
+            for (size_t w = 0; w < words && next == n; w++) {
+                uint64_t fresh = row[w] & white[w];
+                if (fresh != 0) {
+                    next = w * 64 + (size_t)__builtin_ctzll(fresh);
+                }
+            }
+
+            if (next == n) {
+                clearBit(&gray, u);
+                path.pop_back();
+            } else {
+                clearBit(&white, next);
+                setBit(&gray, next);
+                parents[next] = u;
+                path.push_back(next);
+            }
+        }
+    }
+    return {};
+}
+
+/**
+ * @brief the BFS coloring of isBipartite for Storage::BITSET. the neighbors of u are row(u) OR column(u) (the out and in edges),
+ * and u has a neighbor with its own color iff (neighbors AND color(u)) is not empty.
+ * @param g - the graph
+ * @param setB - the blue vertices (will be filled)
+ * @param setR - the red vertices (will be filled)
+ * @return true if the coloring succeeded, false if the graph is not bipartite
+ */
+bool colorBits(const Graph& g, vector<size_t>* setB, vector<size_t>* setR) {
+    const BitMatrix& bits = g.getBits();
+    const BitMatrix& inBits = g.getInBits();
+    size_t words = bits.wordsPerRow();
+
+    vector<uint64_t> blue(words, 0);
+    vector<uint64_t> red(words, 0);
+
+    // start BFS from the first vertex
+    vector<size_t> queue;
+    queue.push_back(0);
+    setBit(&blue, 0);
+    setB->push_back(0);
+
+    for (size_t head = 0; head < queue.size(); head++) {
+        size_t u = queue[head];
+        bool isBlue = testBit(blue, u);
+        const uint64_t* out = bits.row(u);
+        const uint64_t* in = inBits.row(u);
+
+        for (size_t w = 0; w < words; w++) {
+            uint64_t neighbors = out[w] | in[w];
+            if ((neighbors & (isBlue ? blue[w] : red[w])) != 0) {
+                return false;
+            }
+
+            // color the new vertices with the opposite color of u
+            uint64_t discovered = neighbors & ~(blue[w] | red[w]);
+            if (discovered == 0) {
+                continue;
+            }
+            (isBlue ? red : blue)[w] |= discovered;
+            forEachBit(&discovered, 1, [&](size_t bit) {
+                size_t v = w * 64 + bit;
+                (isBlue ? setR : setB)->push_back(v);
+                queue.push_back(v);
+            });
+        }
+    }
+    return true;
+}
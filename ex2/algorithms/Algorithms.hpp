@@ -3,33 +3,151 @@
  * @link shay.gali@msmail.ariel.ac.il
  */
 #include <algorithm>
+#include <functional>
 #include <iostream>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "../graph/Graph.hpp"
+#include "DisjointSets.hpp"
 
 using std::string;
 namespace shayg {
 class Algorithms {
    public:
     /**
-     * @brief Check if the graph is connected
+     * @brief Check if the graph is connected (a directed graph is connected if some vertex reaches all the vertices)
      * @param g - the graph to check
      * @return true if the graph is connected, false otherwise
      */
     static bool isConnected(const Graph& g);
 
+    /**
+     * @brief The components of a graph (see stronglyConnectedComponents and connectedComponents)
+     */
+    struct Components {
+        vector<size_t> component;  // component[v] - the id of the component of v. the ids are in topological order of the condensation
+                                   // (every edge between two components goes from the smaller id to the bigger one)
+        vector<size_t> sizes;      // sizes[c] - the number of vertices in the component c
+        CSR condensation;          // the DAG of the components: the out edges of c are the components that the vertices of c have edges to,
+                                   // and the weight of an edge is the number of edges of the graph between the two components
+                                   // (only stronglyConnectedComponents - there are no edges between connected components)
+
+        size_t count() const { return sizes.size(); }
+    };
+
+    /**
+     * @brief Find the strongly connected components of the graph with an iterative Tarjan (O(V+E) time, no recursion - a path of
+     * millions of vertices is fine). in an undirected graph these are the connected components, and the condensation has no edges.
+     * @param g - the graph (any storage)
+     * @return the component of every vertex, the size of every component and the condensation DAG
+     */
+    static Components stronglyConnectedComponents(const Graph& g);
+
+    /**
+     * @brief Find the connected components of the graph with a concurrent union-find (see DisjointSets): the vertices are split between
+     * all the cores, and every thread unites the vertices of its edges. in a directed graph the direction of the edges is ignored
+     * (the weakly connected components).
+     * @param g - the graph (any storage)
+     * @return the component of every vertex and the size of every component. the components are numbered by their smallest vertex
+     * (the component of 0 is 0, and so on), and the condensation has no edges
+     */
+    static Components connectedComponents(const Graph& g);
+
+    class IncrementalComponents;
+
+    /**
+     * @brief How shortestPath searches for the path (BFS and Dijkstra only - with negative weights Bellman-Ford always computes all the distances)
+     */
+    enum class SearchMode {
+        FULL,           // compute the distances from src to all the vertices
+        EARLY_EXIT,     // stop as soon as the distance to dest is final - the same path as FULL
+        BIDIRECTIONAL,  // search from src on the out edges and from dest on the in edges until the searches meet - much less vertices
+                        // on big graphs, but when there are a few shortest paths it may return another one than FULL
+    };
+
     /**
      * @brief Find the shortest path between two vertices
      * @param g - the graph to search in
      * @param src - the source vertex
      * @param dest - the destination vertex
+     * @param mode - how to search (see SearchMode). Default is SearchMode::EARLY_EXIT
      * @return the shortest path between the source and destination vertices in the format "src->...->dest".
      *  if there is no path between the source and destination vertices, return "-1"
      * @throws NegativeCycleException if the graph contains a negative-weight cycle
      * @throws std::invalid_argument if the source or destination vertices are not in the graph
      */
-    static string shortestPath(const Graph& g, size_t src, size_t dest);
+    static string shortestPath(const Graph& g, size_t src, size_t dest, SearchMode mode = SearchMode::EARLY_EXIT);
+
+    /**
+     * @brief A path in the graph
+     */
+    struct Path {
+        vector<size_t> vertices;  // src, ..., dest. empty if there is no path
+        int length = INF;         // the sum of the weights of the edges on the path (the number of edges in an unweighted graph), INF if there is no path
+
+        bool exists() const { return !vertices.empty(); }
+    };
+
+    /**
+     * @brief Find the shortest path between two vertices, like shortestPath but without the string (O(path length) to build the path)
+     * @param g - the graph to search in
+     * @param src - the source vertex
+     * @param dest - the destination vertex
+     * @param mode - how to search (see SearchMode). Default is SearchMode::EARLY_EXIT
+     * @return the vertices of the path (the same path as shortestPath) and its length. an empty path if there is no path
+     * @throws NegativeCycleException if src can reach a negative-weight cycle (shortestPath returns the message of the exception)
+     * @throws std::invalid_argument if the source or destination vertices are not in the graph
+     */
+    static Path findShortestPath(const Graph& g, size_t src, size_t dest, SearchMode mode = SearchMode::EARLY_EXIT);
+
+    /**
+     * @brief A heuristic for aStar: heuristic(v, dest) is a lower bound on the distance from v to dest (it must never be more than the distance)
+     */
+    using Heuristic = std::function<int(size_t v, size_t dest)>;
+
+    /**
+     * @brief The coordinates of a vertex, for euclideanHeuristic and manhattanHeuristic
+     */
+    struct Point {
+        double x;
+        double y;
+    };
+
+    /**
+     * @brief Find the shortest path between two vertices with A*: Dijkstra that settles the vertices by distance + heuristic,
+     * so the vertices in the direction of dest are settled first. with a good heuristic (like the straight line distance in a grid)
+     * it settles much less vertices than Dijkstra.
+     * @param g - the graph to search in (the weights must be non-negative)
+     * @param src - the source vertex
+     * @param dest - the destination vertex
+     * @param heuristic - a lower bound on the distance to dest (see Heuristic). with a heuristic that is always 0 this is Dijkstra
+     * @return the shortest path in the same format as shortestPath: "src->...->dest", or "-1" if there is no path
+     * @throws std::invalid_argument if the source or destination vertices are not in the graph, or the graph has a negative edge
+     */
+    static string aStar(const Graph& g, size_t src, size_t dest, const Heuristic& heuristic);
+
+    /**
+     * @brief aStar without the string
+     * @return the vertices of the path (the same path as aStar) and its length. an empty path if there is no path
+     * @throws std::invalid_argument if the source or destination vertices are not in the graph, or the graph has a negative edge
+     */
+    static Path findShortestPathAStar(const Graph& g, size_t src, size_t dest, const Heuristic& heuristic);
+
+    /**
+     * @brief The straight line distance between the points of the vertices (rounded down). a lower bound when the weight of every edge
+     * is at least the distance between the points of its vertices
+     * @param points - the point of every vertex (copied into the heuristic)
+     */
+    static Heuristic euclideanHeuristic(vector<Point> points);
+
+    /**
+     * @brief |dx| + |dy| between the points of the vertices (rounded down). a lower bound when the edges are between the neighbors
+     * in a grid and the weight of every edge is at least the distance between the points of its vertices
+     * @param points - the point of every vertex (copied into the heuristic)
+     */
+    static Heuristic manhattanHeuristic(vector<Point> points);
 
     /**
      * @brief Check if the graph contains a cycle. If the graph contains a cycle, return the cycle in the format "v1->v2->...->v1".
@@ -38,6 +156,23 @@ class Algorithms {
      */
     static string isContainsCycle(const Graph& g);
 
+    /**
+     * @brief Find a cycle in the graph with DFS (an explicit stack instead of recursion, so a path of millions of vertices is fine). O(V+E)
+     * @param g - the graph to check (any storage)
+     * @return the vertices of the cycle v1, v2, ..., v1 (the same cycle as isContainsCycle), empty if there is no cycle
+     */
+    static vector<size_t> findCycle(const Graph& g);
+
+    /**
+     * @brief Find a cycle in a directed graph on all the cores. the vertices without in edges can't be on a cycle, so they are removed
+     * level by level (the trim step of the parallel strongly connected components algorithms) until no such vertex is left.
+     * if some vertices are left, each of them has an in edge from another one, so walking back on these edges closes a cycle.
+     * O(V+E), but it may find another cycle than findCycle. undirected graphs and Storage::BITSET use findCycle.
+     * @param g - the graph to check
+     * @return the vertices of the cycle v1, v2, ..., v1, empty if there is no cycle
+     */
+    static vector<size_t> findCycleParallel(const Graph& g);
+
     /**
      * @brief Check if the graph is bipartite
      * @param g - the graph to check
@@ -46,6 +181,22 @@ class Algorithms {
      */
     static string isBipartite(const Graph& g);
 
+    /**
+     * @brief The two sets of a bipartite graph
+     */
+    struct Bipartition {
+        bool bipartite = false;
+        vector<size_t> setA;  // the vertices of every set in increasing order (both are empty if the graph is not bipartite)
+        vector<size_t> setB;
+    };
+
+    /**
+     * @brief Split the graph into two sets with no edge inside a set, like isBipartite but without the string
+     * @param g - the graph to check
+     * @return the two sets (the same sets as isBipartite), or bipartite == false
+     */
+    static Bipartition findBipartition(const Graph& g);
+
     /**
      * @brief Find the negative cycle in the graph
      * @param g - the graph to search in
@@ -55,6 +206,137 @@ class Algorithms {
      */
     static string negativeCycle(const Graph& g);
 
+    /**
+     * @brief Find a negative cycle in the graph, like negativeCycle but without the string
+     * @param g - the graph to search in
+     * @return the vertices of the cycle v1, v2, ..., v1 (the same cycle as negativeCycle), empty if there is no negative cycle
+     */
+    static vector<size_t> findNegativeCycle(const Graph& g);
+
+    class DistanceTable;
+
+    /**
+     * @brief Find the shortest paths between all the pairs of vertices (blocked and multithreaded Floyd-Warshall, O(V^3) time and O(V^2) memory).
+     * After this call, every query on the table takes O(1) time for the distance and O(path length) for the path.
+     * @param g - the graph (any storage)
+     * @return the distance and next-hop table of the graph
+     * @throws NegativeCycleException if the graph contains a negative-weight cycle
+     * @throws std::invalid_argument if the graph is undirected and has a negative edge
+     *  (every negative undirected edge is a negative cycle of two edges, so the shortest walks are not defined)
+     */
+    static DistanceTable allPairsShortestPaths(const Graph& g);
+
+    /**
+     * @brief The result of allPairsShortestPaths: the distance between every two vertices, and the vertex after u on a shortest path from u to v.
+     */
+    class DistanceTable {
+       private:
+        Matrix dist;  // dist[u][v] - the distance from u to v (INF if there is no path)
+        Matrix next;  // next[u][v] - the vertex after u on a shortest path from u to v (-1 if there is no path)
+
+        void requireVertices(size_t src, size_t dest) const {
+            if (src >= size() || dest >= size()) {
+                throw std::invalid_argument("Invalid source or destination vertex");
+            }
+        }
+
+       public:
+        DistanceTable(Matrix dist, Matrix next) : dist(std::move(dist)), next(std::move(next)) {}
+
+        /**
+         * @brief the number of vertices in the graph
+         */
+        size_t size() const { return dist.size(); }
+
+        /**
+         * @return the distance from src to dest, INF if there is no path
+         * @throws std::invalid_argument if one of the vertices is not in the graph
+         */
+        int distance(size_t src, size_t dest) const {
+            requireVertices(src, dest);
+            return dist[src][dest];
+        }
+
+        /**
+         * @return true if there is a path from src to dest
+         * @throws std::invalid_argument if one of the vertices is not in the graph
+         */
+        bool hasPath(size_t src, size_t dest) const { return distance(src, dest) != INF; }
+
+        /**
+         * @brief The vertices of a shortest path from src to dest - O(path length)
+         * @return the vertices src, ..., dest. empty if there is no path
+         * @throws std::invalid_argument if one of the vertices is not in the graph
+         */
+        vector<size_t> pathVertices(size_t src, size_t dest) const;
+
+        /**
+         * @brief A shortest path from src to dest, in the same format as Algorithms::shortestPath - O(path length)
+         * @return the path in the format "src->...->dest", or "-1" if there is no path
+         * @throws std::invalid_argument if one of the vertices is not in the graph
+         */
+        string path(size_t src, size_t dest) const;
+    };
+
+    /**
+     * @brief The connected components of a graph that only gets new edges. the union-find is kept between the batches, so adding a batch
+     * of edges only unites their vertices (on all the cores) - the components of the old edges are not computed again.
+     * the direction of the edges is ignored, like in connectedComponents.
+     */
+    class IncrementalComponents {
+       private:
+        mutable DisjointSets sets;  // find moves the vertices up the trees, also in the queries
+        size_t numComponents;
+
+        void requireVertex(size_t v) const {
+            if (v >= sets.size()) {
+                throw std::invalid_argument("Invalid vertex: " + std::to_string(v) + " is not in a graph with " + std::to_string(sets.size()) + " vertices.");
+            }
+        }
+
+       public:
+        /**
+         * @brief n vertices without edges (n components)
+         */
+        explicit IncrementalComponents(size_t n) : sets(n), numComponents(n) {}
+
+        /**
+         * @brief the components of the edges of g (any storage)
+         */
+        explicit IncrementalComponents(const Graph& g);
+
+        /**
+         * @brief add a batch of edges (the weights are ignored). a big batch is split between all the cores
+         * @throws std::invalid_argument if a vertex of an edge is not in the graph (then none of the edges is added)
+         */
+        void addEdges(const vector<Edge>& edges);
+
+        /**
+         * @brief the number of vertices
+         */
+        size_t size() const { return sets.size(); }
+
+        /**
+         * @brief the number of components
+         */
+        size_t count() const { return numComponents; }
+
+        /**
+         * @return true if there is a path between u and v (ignoring the direction of the edges). O(1) amortized
+         * @throws std::invalid_argument if one of the vertices is not in the graph
+         */
+        bool connected(size_t u, size_t v) const {
+            requireVertex(u);
+            requireVertex(v);
+            return sets.find(u) == sets.find(v);
+        }
+
+        /**
+         * @brief the component of every vertex and the size of every component, numbered like in connectedComponents. O(V)
+         */
+        Components components() const;
+    };
+
     class NegativeCycleException : public std::exception {
        public:
         vector<size_t> cycle;
@@ -78,6 +360,11 @@ class Algorithms {
 
             reverse(cycle.begin(), cycle.end());
 
+            // start the cycle at its smallest vertex, so the same cycle is reported the same way whatever vertex found it
+            cycle.pop_back();
+            std::rotate(cycle.begin(), std::min_element(cycle.begin(), cycle.end()), cycle.end());
+            cycle.push_back(cycle.front());
+
             this->cycle = cycle;
         }
 
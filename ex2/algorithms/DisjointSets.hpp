@@ -0,0 +1,78 @@
+/**
+ * @author Shay Gali
+ * @link shay.gali@msmail.ariel.ac.il
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+using std::vector;
+
+namespace shayg {
+
+/**
+ * @brief a union-find of the vertices 0..n-1 that many threads can use at once, without locks.
+ * - find halves the path: every vertex on the way is pointed to its grandparent with compare and swap (a failed swap only means
+ *   that another thread already moved it up), so the trees stay flat.
+ * - unite links the root with the bigger id under the root with the smaller id, with compare and swap on the parent of the bigger root.
+ *   if another thread linked that root first, the roots are found again and the link is tried again.
+ * the parents only move towards smaller ids, so the root of a set is always its smallest vertex (whatever the order of the unions).
+ */
+class DisjointSets {
+   private:
+    vector<std::atomic<size_t>> parent;
+
+   public:
+    /**
+     * @brief n sets of one vertex
+     */
+    explicit DisjointSets(size_t n) : parent(n) {
+        for (size_t v = 0; v < n; v++) {
+            parent[v].store(v, std::memory_order_relaxed);
+        }
+    }
+
+    size_t size() const { return parent.size(); }
+
+    /**
+     * @brief the root of the set of v (its smallest vertex). safe to call from many threads, also while other threads unite
+     */
+    size_t find(size_t v) {
+        while (true) {
+            size_t p = parent[v].load(std::memory_order_acquire);
+            if (p == v) {
+                return v;
+            }
+            size_t grandparent = parent[p].load(std::memory_order_acquire);
+            if (grandparent != p) {
+                parent[v].compare_exchange_weak(p, grandparent, std::memory_order_release, std::memory_order_relaxed);
+            }
+            v = grandparent;
+        }
+    }
+
+    /**
+     * @brief merge the sets of a and b. safe to call from many threads
+     * @return true if a and b were in different sets
+     */
+    bool unite(size_t a, size_t b) {
+        while (true) {
+            a = find(a);
+            b = find(b);
+            if (a == b) {
+                return false;
+            }
+            if (a > b) {
+                std::swap(a, b);
+            }
+            size_t expected = b;
+            if (parent[b].compare_exchange_strong(expected, a, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+    }
+};
+
+}  // namespace shayg
@@ -0,0 +1,218 @@
+/**
+ * @author Shay Gali
+ * @link shay.gali@msmail.ariel.ac.il
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+using std::vector;
+
+namespace shayg {
+
+/**
+ * @brief a D-ary min heap of the vertices 0..n-1 with decrease-key. every vertex is in the heap at most once
+ * (a position array keeps its index in the heap), so the heap never has more than |V| elements and there are no stale entries.
+ * the vertices are ordered by (key, vertex), so vertices with the same key come out in increasing order.
+ * a 4-ary heap is half as deep as a binary heap, and the children of a node are next to each other in memory.
+ */
+template <size_t D = 4>
+class IndexedHeap {
+   private:
+    static constexpr size_t NOT_IN_HEAP = std::numeric_limits<size_t>::max();
+
+    vector<size_t> heap;      // the vertices, heap[0] is the minimum
+    vector<size_t> position;  // position[v] - the index of v in heap (NOT_IN_HEAP if v is not in the heap)
+    vector<int> keys;         // keys[v] - the key of v (valid while v is in the heap)
+
+    bool less(size_t a, size_t b) const { return keys[a] < keys[b] || (keys[a] == keys[b] && a < b); }
+
+    void place(size_t i, size_t v) {
+        heap[i] = v;
+        position[v] = i;
+    }
+
+    void siftUp(size_t i) {
+        size_t v = heap[i];
+        while (i > 0 && less(v, heap[(i - 1) / D])) {
+            place(i, heap[(i - 1) / D]);
+            i = (i - 1) / D;
+        }
+        place(i, v);
+    }
+
+    void siftDown(size_t i) {
+        size_t v = heap[i];
+        while (true) {
+            size_t first = i * D + 1;
+            if (first >= heap.size()) {
+                break;
+            }
+            size_t best = first;
+            for (size_t c = first + 1; c < first + D && c < heap.size(); c++) {
+                if (less(heap[c], heap[best])) {
+                    best = c;
+                }
+            }
+            if (!less(heap[best], v)) {
+                break;
+            }
+            place(i, heap[best]);
+            i = best;
+        }
+        place(i, v);
+    }
+
+   public:
+    /**
+     * @brief an empty heap for the vertices 0..n-1
+     */
+    explicit IndexedHeap(size_t n) : position(n, NOT_IN_HEAP), keys(n) {}
+
+    bool empty() const { return heap.empty(); }
+    size_t size() const { return heap.size(); }
+    bool contains(size_t v) const { return position[v] != NOT_IN_HEAP; }
+
+    /**
+     * @brief add v with the given key, or decrease the key of v if it is already in the heap (a bigger key is ignored). O(log_D |V|)
+     */
+    void push(size_t v, int key) {
+        if (contains(v)) {
+            if (key < keys[v]) {
+                keys[v] = key;
+                siftUp(position[v]);
+            }
+            return;
+        }
+        keys[v] = key;
+        heap.push_back(v);
+        siftUp(heap.size() - 1);
+    }
+
+    /**
+     * @brief the vertex with the smallest key
+     */
+    size_t top() const { return heap.front(); }
+
+    /**
+     * @brief remove the vertex with the smallest key and return it. O(D log_D |V|)
+     */
+    size_t pop() {
+        size_t v = heap.front();
+        position[v] = NOT_IN_HEAP;
+        size_t last = heap.back();
+        heap.pop_back();
+        if (!heap.empty()) {
+            place(0, last);
+            siftDown(0);
+        }
+        return v;
+    }
+};
+
+/**
+ * @brief a D-ary min heap of (key, vertex) entries without decrease-key: a vertex is pushed again when its key decreases, and the caller
+ * skips the entries that are not up to date (like BucketQueue). an entry is one 64 bit number, the key in the high half and the vertex
+ * in the low half, so the order (key, vertex) is one integer comparison and a sift moves 8 bytes - less work per step than IndexedHeap,
+ * which also updates the position array on every move. the keys must be non-negative and the vertices must fit in 32 bits.
+ */
+template <size_t D = 4>
+class LazyHeap {
+   private:
+    vector<uint64_t> heap;  // heap[0] is the minimum
+
+   public:
+    bool empty() const { return heap.empty(); }
+    size_t size() const { return heap.size(); }
+
+    /**
+     * @brief add an entry for v with the given key. O(log_D E)
+     */
+    void push(size_t v, int key) {
+        uint64_t entry = (uint64_t)(uint32_t)key << 32U | (uint64_t)v;
+        size_t i = heap.size();
+        heap.push_back(entry);
+        while (i > 0 && entry < heap[(i - 1) / D]) {
+            heap[i] = heap[(i - 1) / D];
+            i = (i - 1) / D;
+        }
+        heap[i] = entry;
+    }
+
+    /**
+     * @brief remove the entry with the smallest (key, vertex) and return its vertex. O(D log_D E)
+     * @param key the key of the entry
+     */
+    size_t pop(int* key) {
+        uint64_t top = heap.front();
+        uint64_t entry = heap.back();
+        heap.pop_back();
+        size_t n = heap.size();
+        size_t i = 0;
+        while (true) {
+            size_t first = i * D + 1;
+            if (first >= n) {
+                break;
+            }
+            size_t best = first;
+            for (size_t c = first + 1; c < first + D && c < n; c++) {
+                if (heap[c] < heap[best]) {
+                    best = c;
+                }
+            }
+            if (heap[best] >= entry) {
+                break;
+            }
+            heap[i] = heap[best];
+            i = best;
+        }
+        if (n > 0) {
+            heap[i] = entry;
+        }
+        *key = (int)(top >> 32U);
+        return (size_t)(uint32_t)top;
+    }
+};
+
+/**
+ * @brief Dial's bucket queue for integer keys, when every key that is pushed is at most maxStep more than the last key that was popped
+ * (like the distances in Dijkstra with weights in [1, maxStep]). the buckets are a circular array of maxStep + 1 lists, the list of the key k
+ * is buckets[k % (maxStep + 1)], so push is O(1) and finding the next key scans at most maxStep buckets.
+ * a vertex can be pushed more than once (when its key decreases) - the caller skips the entries that are not up to date.
+ */
+class BucketQueue {
+   private:
+    vector<vector<size_t>> buckets;
+    size_t current = 0;  // the key of the current bucket - all the keys in the queue are in [current, current + maxStep]
+    size_t count = 0;    // the number of entries in all the buckets
+
+   public:
+    explicit BucketQueue(size_t maxStep) : buckets(maxStep + 1) {}
+
+    bool empty() const { return count == 0; }
+
+    void push(size_t v, size_t key) {
+        buckets[key % buckets.size()].push_back(v);
+        count++;
+    }
+
+    /**
+     * @brief take all the entries with the smallest key
+     * @param vertices the entries of the bucket are swapped into it (the old content is cleared)
+     * @return the key of the entries
+     */
+    size_t popBucket(vector<size_t>* vertices) {
+        while (buckets[current % buckets.size()].empty()) {
+            current++;
+        }
+        vertices->clear();
+        vertices->swap(buckets[current % buckets.size()]);
+        count -= vertices->size();
+        return current;
+    }
+};
+
+}  // namespace shayg
@@ -0,0 +1,104 @@
+/**
+ * @author Shay Gali
+ * @link shay.gali@msmail.ariel.ac.il
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using std::vector;
+
+namespace shayg {
+
+/**
+ * @brief Call func(i) for every set bit i in the words array (in increasing order)
+ * @param words the bits, bit i is bit (i % 64) of words[i / 64]
+ * @param count the number of words
+ * @param func the function to call on every set bit
+ */
+template <typename Func>
+void forEachBit(const uint64_t* words, size_t count, Func func) {
+    for (size_t w = 0; w < count; w++) {
+        uint64_t word = words[w];
+        while (word != 0) {
+            func(w * 64 + (size_t)__builtin_ctzll(word));
+            word &= word - 1;  // clear the lowest set bit
+        }
+    }
+}
+
+/**
+ * @brief a square matrix of bits (an unweighted adjacency matrix), every row is packed into 64 bit words.
+ * the cell (i, j) is bit (j % 64) of row(i)[j / 64].
+ */
+class BitMatrix {
+   public:
+    static constexpr size_t WORD_BITS = 64;
+
+   private:
+    size_t n = 0;
+    size_t rowWords = 0;
+    vector<uint64_t> words;
+
+   public:
+    BitMatrix() = default;
+
+    /**
+     * @brief create an n x n matrix with all the bits cleared
+     */
+    explicit BitMatrix(size_t n) : n(n), rowWords((n + WORD_BITS - 1) / WORD_BITS), words(n * rowWords, 0) {}
+
+    size_t size() const { return n; }
+
+    /**
+     * @brief the number of words in every row
+     */
+    size_t wordsPerRow() const { return rowWords; }
+
+    const uint64_t* row(size_t i) const { return words.data() + i * rowWords; }
+    uint64_t* row(size_t i) { return words.data() + i * rowWords; }
+
+    bool test(size_t i, size_t j) const { return ((row(i)[j / WORD_BITS] >> (j % WORD_BITS)) & 1U) != 0; }
+    void set(size_t i, size_t j) { row(i)[j / WORD_BITS] |= uint64_t{1} << (j % WORD_BITS); }
+    void reset(size_t i, size_t j) { row(i)[j / WORD_BITS] &= ~(uint64_t{1} << (j % WORD_BITS)); }
+
+    /**
+     * @brief count the set bits in the matrix (with popcount on every word)
+     */
+    size_t count() const {
+        size_t total = 0;
+        for (uint64_t word : words) {
+            total += (size_t)__builtin_popcountll(word);
+        }
+        return total;
+    }
+
+    /**
+     * @brief create the transposed matrix - (i, j) is set iff (j, i) is set in this matrix
+     */
+    BitMatrix transposed() const {
+        BitMatrix result(n);
+        for (size_t i = 0; i < n; i++) {
+            forEachBit(row(i), rowWords, [&](size_t j) { result.set(j, i); });
+        }
+        return result;
+    }
+
+    bool operator==(const BitMatrix& other) const { return n == other.n && words == other.words; }
+    bool operator!=(const BitMatrix& other) const { return !(*this == other); }
+};
+
+/**
+ * @brief the boolean matrix product result = a * b - (i, j) is set iff there is a k with (i, k) set in a and (k, j) set in b.
+ * row i of the result is the OR of the rows k of b (64 cells in every instruction), and big matrices are split between all the cores.
+ * @param a the left matrix
+ * @param b the right matrix (must be the same size as a)
+ * @param result the matrix to write the product to (resized if needed). must not be a or b
+ * @throws invalid_argument if the sizes are different or result is one of the operands
+ * (implemented in Matrix.cpp, next to the int product)
+ */
+void multiply(const BitMatrix& a, const BitMatrix& b, BitMatrix* result);
+
+}  // namespace shayg
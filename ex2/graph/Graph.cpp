@@ -4,31 +4,339 @@
  */
 #include "Graph.hpp"
 
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include <algorithm>
+#include <charconv>
 #include <iostream>
 #include <stdexcept>
+#include <thread>
+#include <utility>
 
 using namespace shayg;
 
 using std::invalid_argument;
+using std::pair;
+
+namespace {
+
+constexpr size_t RELEASE_CHUNK = size_t{16} << 20U;  // give the freed rows back to the system after every 16MB
+
+/**
+ * @brief give the free memory of the heap back to the system. small blocks (like the rows of a vector<vector<int>>) stay in the heap after
+ * they are freed, so without this the memory of the rows that were moved into the graph is still counted until the end of the program.
+ */
+void releaseFreedMemory() {
+#if defined(__GLIBC__)
+    malloc_trim(0);
+#endif
+}
+
+constexpr size_t BLOCK_CHARS = size_t{1} << 20U;  // the printing functions format about 1MB of text before every write to the stream
+constexpr size_t INT_CHARS = 11;                   // the longest int is "-2147483648"
+constexpr size_t SIZE_CHARS = 20;                  // the longest size_t
+
+/**
+ * @brief write a number with std::to_chars (no locale and no stream) and return the end of the text. out must have room for it
+ */
+template <typename T>
+char* writeNumber(char* out, T value) {
+    return std::to_chars(out, out + SIZE_CHARS, value).ptr;
+}
+
+/**
+ * @brief write one row of the adjacency matrix like printAdjMat: "[w, X, w]" (X for NO_EDGE), then ",\n" if it is not the last row.
+ * out must have room for n * (INT_CHARS + 2) + 4 chars
+ */
+char* formatMatrixRow(const int* row, size_t n, bool lastRow, char* out) {
+    *out++ = '[';
+    for (size_t j = 0; j < n; j++) {
+        if (row[j] != NO_EDGE) {
+            out = writeNumber(out, row[j]);
+        } else {
+            *out++ = 'X';
+        }
+        if (j != n - 1) {
+            *out++ = ',';
+            *out++ = ' ';
+        }
+    }
+    *out++ = ']';
+    if (!lastRow) {
+        *out++ = ',';
+        *out++ = '\n';
+    }
+    return out;
+}
+
+/**
+ * @brief write the text of the rows [0, n) to the stream: the rows are split to blocks of rowsPerBlock rows, every block is formatted into a
+ * buffer (that is reused) and written to the stream in one call. when there are enough blocks, the blocks are formatted by all the cores
+ * (one block for every thread at a time) and written in order.
+ * @param maxChars maxChars(begin, end) is an upper bound on the length of the text of the rows [begin, end)
+ * @param formatRows formatRows(begin, end, out) writes the text of the rows [begin, end) to out and returns the end of the text
+ */
+template <typename MaxChars, typename FormatRows>
+void writeRowBlocks(std::ostream& os, size_t n, size_t rowsPerBlock, MaxChars maxChars, FormatRows formatRows) {
+    size_t numBlocks = (n + rowsPerBlock - 1) / rowsPerBlock;
+    size_t numThreads = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), numBlocks));
+    vector<vector<char>> buffers(numThreads);
+    vector<size_t> lengths(numThreads, 0);
+
+    auto format = [&](size_t t, size_t begin) {
+        size_t end = std::min(begin + rowsPerBlock, n);
+        size_t size = maxChars(begin, end);
+        if (buffers[t].size() < size) {
+            buffers[t].resize(size);
+        }
+        lengths[t] = (size_t)(formatRows(begin, end, buffers[t].data()) - buffers[t].data());
+    };
+
+    for (size_t first = 0; first < n; first += numThreads * rowsPerBlock) {
+        vector<std::thread> threads;
+        for (size_t t = 1; t < numThreads && first + t * rowsPerBlock < n; t++) {
+            threads.emplace_back(format, t, first + t * rowsPerBlock);
+        }
+        format(0, first);  // the current thread formats the first block
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        for (size_t t = 0; t <= threads.size(); t++) {
+            os.write(buffers[t].data(), (std::streamsize)lengths[t]);
+        }
+    }
+}
 
-void Graph::loadGraph(const vector<vector<int>>& adjMat) {
-    this->adjMat = adjMat;
-    /*
-     * update the isWeighted and haveNegativeEdgeWeight fields.
-     * create an deep copy of the adjacency list.
-     */
-
-    // check if the graph is a square matrix
-    // check if the diagonal of the matrix is 0
-    for (size_t i = 0; i < adjMat.size(); i++) {
-        if (adjMat.size() != adjMat[i].size()) {
-            throw invalid_argument("Invalid graph: The graph is not a square matrix.(" + std::to_string(i) + "th row has " + std::to_string(adjMat[i].size()) + " elements.)");
+}  // namespace
+
+template <typename GetRow, typename ReleaseRow>
+void Graph::loadRows(size_t n, Storage storage, GetRow getRow, ReleaseRow releaseRow) {
+    // the new storage is built aside, so the graph is not changed if the matrix is not valid
+    Matrix newMat;
+    BitMatrix newBits;
+    CSR index;
+    if (storage == Storage::DENSE) {
+        newMat = Matrix::uninitialized(n);  // every row is written once, when it is copied
+    } else if (storage == Storage::BITSET) {
+        newBits = BitMatrix(n);
+    }
+    index.offsets.assign(n + 1, 0);
+
+    for (size_t u = 0; u < n; u++) {
+        const int* row = getRow(u);
+        if (row[u] != NO_EDGE) {
+            throw invalid_argument("The diagonal of the matrix must be NO_EDGE. (the " + std::to_string(u) + "th node is not a NO_EDGE)");
         }
-        if (adjMat[i][i] != NO_EDGE) {
-            throw invalid_argument("The diagonal of the matrix must be NO_EDGE. (the " + std::to_string(i) + "th node is not a NO_EDGE)");
+
+        if (storage == Storage::DENSE) {
+            int* out = newMat[u].data();
+            std::copy(row, row + n, out);
+            indexRow(out, n, &index);
+            index.offsets[u + 1] = index.targets.size();
+        } else if (storage == Storage::SPARSE) {
+            indexRow(row, n, &index);  // keep only the edges of the matrix
+            index.offsets[u + 1] = index.targets.size();
+        } else {
+            for (size_t v = 0; v < n; v++) {
+                if (row[v] != NO_EDGE) {
+                    if (row[v] != 1) {
+                        throw invalid_argument("Storage::BITSET requires an unweighted graph. (mat[" + std::to_string(u) + "][" + std::to_string(v) + "] = " + std::to_string(row[v]) + ")");
+                    }
+                    newBits.set(u, v);
+                }
+            }
         }
+        releaseRow(u);
+    }
+
+    this->storage = storage;
+    this->numVertices = n;
+    this->adjMat = std::move(newMat);
+    this->mapping.reset();
+    this->bits = std::move(newBits);
+    if (storage == Storage::BITSET) {
+        updateData();
+    } else {
+        this->csr = std::move(index);
+        updateFromIndex();
+    }
+}
+
+void Graph::loadGraph(const vector<vector<int>>& adjMat, Storage storage) {
+    // every row is checked when it is copied - one pass over the matrix
+    loadRows(
+        adjMat.size(), storage,
+        [&adjMat](size_t u) {
+            if (adjMat.size() != adjMat[u].size()) {
+                throw invalid_argument("Invalid graph: The graph is not a square matrix.(" + std::to_string(u) + "th row has " + std::to_string(adjMat[u].size()) + " elements.)");
+            }
+            return adjMat[u].data();
+        },
+        [](size_t /*u*/) {});
+}
+
+void Graph::loadGraph(vector<vector<int>>&& adjMat, Storage storage) {
+    // the same, but every row is freed after it is copied (so the peak is one matrix and one row)
+    size_t n = adjMat.size();
+    size_t released = 0;
+    try {
+        loadRows(
+            n, storage,
+            [&adjMat](size_t u) {
+                if (adjMat.size() != adjMat[u].size()) {
+                    throw invalid_argument("Invalid graph: The graph is not a square matrix.(" + std::to_string(u) + "th row has " + std::to_string(adjMat[u].size()) + " elements.)");
+                }
+                return adjMat[u].data();
+            },
+            [&adjMat, &released](size_t u) {
+                released += adjMat[u].capacity() * sizeof(int);
+                vector<int>().swap(adjMat[u]);
+                if (released >= RELEASE_CHUNK) {
+                    releaseFreedMemory();
+                    released = 0;
+                }
+            });
+    } catch (...) {
+        adjMat.clear();
+        throw;
+    }
+    adjMat.clear();
+}
+
+void Graph::loadGraph(const int* cells, size_t numVertices, Storage storage) {
+    if (cells == nullptr && numVertices != 0) {
+        throw invalid_argument("Invalid graph: the buffer of the matrix is null.");
+    }
+
+    if (storage != Storage::DENSE) {
+        loadRows(numVertices, storage, [cells, numVertices](size_t u) { return cells + u * numVertices; }, [](size_t /*u*/) {});
+        return;
     }
 
+    // Storage::DENSE - the graph keeps a view over the buffer, and only the index of the edges is built
+    CSR index;
+    index.offsets.assign(numVertices + 1, 0);
+    for (size_t u = 0; u < numVertices; u++) {
+        const int* row = cells + u * numVertices;
+        if (row[u] != NO_EDGE) {
+            throw invalid_argument("The diagonal of the matrix must be NO_EDGE. (the " + std::to_string(u) + "th node is not a NO_EDGE)");
+        }
+        indexRow(row, numVertices, &index);
+        index.offsets[u + 1] = index.targets.size();
+    }
+
+    this->storage = Storage::DENSE;
+    this->numVertices = numVertices;
+    this->adjMat = Matrix::view(cells, numVertices);
+    this->mapping.reset();
+    this->bits = BitMatrix();
+    this->csr = std::move(index);
+    updateFromIndex();
+}
+
+void Graph::loadEdges(size_t numVertices, const vector<Edge>& edges, Storage storage) {
+    for (const Edge& e : edges) {
+        if (e.from >= numVertices || e.to >= numVertices) {
+            throw invalid_argument("Invalid edge: (" + std::to_string(e.from) + ", " + std::to_string(e.to) + ") is not in a graph with " + std::to_string(numVertices) + " vertices.");
+        }
+        if (e.from == e.to && e.weight != NO_EDGE) {
+            throw invalid_argument("The diagonal of the matrix must be NO_EDGE. (the " + std::to_string(e.from) + "th node is not a NO_EDGE)");
+        }
+    }
+    loadEdgeChunks(numVertices, {&edges}, storage);
+}
+
+void Graph::loadEdgeChunks(size_t numVertices, const vector<const vector<Edge>*>& chunks, Storage storage) {
+    auto forEachEdge = [&chunks](auto func) {
+        for (const vector<Edge>* chunk : chunks) {
+            for (const Edge& e : *chunk) {
+                if (e.weight != NO_EDGE) {
+                    func(e);
+                }
+            }
+        }
+    };
+    auto duplicate = [](size_t u, size_t v) {
+        return invalid_argument("Invalid edge: the edge (" + std::to_string(u) + ", " + std::to_string(v) + ") appears more than once.");
+    };
+
+    if (storage == Storage::BITSET) {
+        BitMatrix newBits(numVertices);
+        forEachEdge([&](const Edge& e) {
+            if (e.weight != 1) {
+                throw invalid_argument("Storage::BITSET requires an unweighted graph. (the edge (" + std::to_string(e.from) + ", " + std::to_string(e.to) + ") has weight " + std::to_string(e.weight) + ")");
+            }
+            if (newBits.test(e.from, e.to)) {
+                throw duplicate(e.from, e.to);
+            }
+            newBits.set(e.from, e.to);
+        });
+        this->bits = std::move(newBits);
+        this->adjMat = Matrix();
+        this->csr = CSR();
+    } else if (storage == Storage::DENSE) {
+        Matrix mat(numVertices, NO_EDGE);
+        forEachEdge([&](const Edge& e) {
+            if (mat[e.from][e.to] != NO_EDGE) {
+                throw duplicate(e.from, e.to);
+            }
+            mat[e.from][e.to] = e.weight;
+        });
+        this->adjMat = std::move(mat);
+        this->bits = BitMatrix();
+    } else {
+        // counting sort of the edges by the source vertex, straight into the CSR arrays, then sort every row by the target vertex
+        CSR newCsr;
+        newCsr.offsets.assign(numVertices + 1, 0);
+        forEachEdge([&](const Edge& e) { newCsr.offsets[e.from + 1]++; });
+        for (size_t u = 0; u < numVertices; u++) {
+            newCsr.offsets[u + 1] += newCsr.offsets[u];
+        }
+
+        newCsr.targets.resize(newCsr.offsets[numVertices]);
+        newCsr.weights.resize(newCsr.offsets[numVertices]);
+        vector<size_t> next(newCsr.offsets.begin(), newCsr.offsets.end() - 1);
+        forEachEdge([&](const Edge& e) {
+            size_t i = next[e.from]++;
+            newCsr.targets[i] = e.to;
+            newCsr.weights[i] = e.weight;
+        });
+
+        vector<pair<size_t, int>> row;  // one row at a time, so the extra memory is the largest degree and not |E|
+        for (size_t u = 0; u < numVertices; u++) {
+            size_t first = newCsr.offsets[u];
+            size_t last = newCsr.offsets[u + 1];
+            if (std::is_sorted(newCsr.targets.begin() + (std::ptrdiff_t)first, newCsr.targets.begin() + (std::ptrdiff_t)last)) {
+                for (size_t i = first + 1; i < last; i++) {
+                    if (newCsr.targets[i] == newCsr.targets[i - 1]) {
+                        throw duplicate(u, newCsr.targets[i]);
+                    }
+                }
+                continue;  // the edges of the row were given in order (like in most files)
+            }
+            row.clear();
+            for (size_t i = first; i < last; i++) {
+                row.emplace_back(newCsr.targets[i], newCsr.weights[i]);
+            }
+            std::sort(row.begin(), row.end(), [](const pair<size_t, int>& a, const pair<size_t, int>& b) { return a.first < b.first; });
+            for (size_t i = first; i < last; i++) {
+                if (i > first && row[i - first].first == row[i - first - 1].first) {
+                    throw duplicate(u, row[i - first].first);
+                }
+                newCsr.targets[i] = row[i - first].first;
+                newCsr.weights[i] = row[i - first].second;
+            }
+        }
+        this->csr = std::move(newCsr);
+        this->adjMat = Matrix();
+        this->bits = BitMatrix();
+    }
+
+    this->storage = storage;
+    this->numVertices = numVertices;
+    this->mapping.reset();
     updateData();
 }
 
@@ -41,115 +349,382 @@ void Graph::printGraph(std::ostream& out) const {
 }
 
 void Graph::printAdjMat(std::ostream& out) const {
-    for (size_t i = 0; i < getNumVertices() - 1; i++) {
-        out << "[";
-        for (size_t j = 0; j < getNumVertices() - 1; j++) {
-            if (adjMat[i][j] != NO_EDGE) {
-                out << adjMat[i][j] << ", ";
-            } else {
-                out << "X, ";
+    size_t n = getNumVertices();
+    syncIndex();
+
+    size_t rowChars = n * (INT_CHARS + 2) + 4;
+    writeRowBlocks(
+        out, n, std::max<size_t>(1, BLOCK_CHARS / (n * 3 + 3)), [rowChars](size_t begin, size_t end) { return (end - begin) * rowChars; },
+        [&](size_t begin, size_t end, char* text) {
+            vector<int> sparseRow;  // the current row of the matrix, when the graph is stored as CSR or as bits
+            for (size_t i = begin; i < end; i++) {
+                const int* row = nullptr;
+                if (storage == Storage::BITSET) {
+                    sparseRow.assign(n, NO_EDGE);
+                    forEachBit(bits.row(i), bits.wordsPerRow(), [&](size_t j) { sparseRow[j] = 1; });
+                    row = sparseRow.data();
+                } else if (storage == Storage::SPARSE) {
+                    sparseRow.assign(n, NO_EDGE);
+                    for (size_t e = csr.offsets[i]; e < csr.offsets[i + 1]; e++) {
+                        sparseRow[csr.targets[e]] = csr.weights[e];
+                    }
+                    row = sparseRow.data();
+                } else {
+                    row = adjMat[i].data();
+                }
+                text = formatMatrixRow(row, n, i == n - 1, text);
             }
+            return text;
+        });
+}
+
+void Graph::printEdges(std::ostream& out) const {
+    size_t n = getNumVertices();
+    syncIndex();
+
+    constexpr size_t EDGE_CHARS = 2 * SIZE_CHARS + INT_CHARS + 3;  // "u v w\n"
+    auto degree = [this](size_t u) {
+        if (storage != Storage::BITSET) {
+            return csr.offsets[u + 1] - csr.offsets[u];
         }
-        if (adjMat[i][getNumVertices() - 1] != NO_EDGE) {
-            out << adjMat[i][getNumVertices() - 1] << "]," << '\n';
-        } else {
-            out << "X]," << '\n';
+        size_t count = 0;
+        for (size_t w = 0; w < bits.wordsPerRow(); w++) {
+            count += (size_t)__builtin_popcountll(bits.row(u)[w]);
         }
-    }
+        return count;
+    };
+    auto writeEdge = [](char* text, size_t u, size_t v, int weight) {
+        text = writeNumber(text, u);
+        *text++ = ' ';
+        text = writeNumber(text, v);
+        *text++ = ' ';
+        text = writeNumber(text, weight);
+        *text++ = '\n';
+        return text;
+    };
+
+    size_t averageDegree = n == 0 ? 0 : edgeCells / n;
+    writeRowBlocks(
+        out, n, std::max<size_t>(1, BLOCK_CHARS / (averageDegree * EDGE_CHARS / 2 + 1)),
+        [&](size_t begin, size_t end) {
+            size_t edges = 0;
+            for (size_t u = begin; u < end; u++) {
+                edges += degree(u);
+            }
+            return edges * EDGE_CHARS;
+        },
+        [&](size_t begin, size_t end, char* text) {
+            for (size_t u = begin; u < end; u++) {
+                if (storage == Storage::BITSET) {
+                    forEachBit(bits.row(u), bits.wordsPerRow(), [&](size_t v) { text = writeEdge(text, u, v, 1); });
+                    continue;
+                }
+                for (size_t e = csr.offsets[u]; e < csr.offsets[u + 1]; e++) {
+                    text = writeEdge(text, u, csr.targets[e], csr.weights[e]);
+                }
+            }
+            return text;
+        });
+}
 
-    out << "[";
-    for (size_t j = 0; j < getNumVertices() - 1; j++) {
-        if (adjMat[getNumVertices() - 1][j] != NO_EDGE) {
-            out << adjMat[getNumVertices() - 1][j] << ", ";
-        } else {
-            out << "X, ";
+void Graph::updateData() {
+    size_t n = getNumVertices();
+
+    // in Storage::BITSET there is no neighbors index - count the edges with popcount, and compare the matrix to its transpose
+    if (storage == Storage::BITSET) {
+        this->pending.clear();
+        this->nonUnitWeights = 0;
+        this->negativeWeights = 0;
+        this->edgeCells = bits.count();
+        this->inBits = bits.transposed();
+
+        // every different pair {u, v} is counted in row u and in row v
+        size_t different = 0;
+        for (size_t u = 0; u < n; u++) {
+            for (size_t w = 0; w < bits.wordsPerRow(); w++) {
+                different += (size_t)__builtin_popcountll(bits.row(u)[w] ^ inBits.row(u)[w]);
+            }
+        }
+        this->asymmetricPairs = different / 2;
+
+        updateFlags();
+        if (!this->isDirected) {
+            this->inBits = BitMatrix();
         }
+        this->csr = CSR();
+        this->inCsr = CSR();
+        return;
     }
-    if (adjMat[getNumVertices() - 1][getNumVertices() - 1] != NO_EDGE) {
-        out << adjMat[getNumVertices() - 1][getNumVertices() - 1] << "]";
-    } else {
-        out << "X]";
+
+    // in Storage::DENSE, rebuild the index of the out edges from the matrix
+    if (storage == Storage::DENSE) {
+        csr.offsets.assign(n + 1, 0);
+        csr.targets.clear();
+        csr.weights.clear();
+        for (size_t i = 0; i < n; i++) {
+            const int* row = adjMat[i].data();
+            for (size_t j = 0; j < n; j++) {
+                if (row[j] != NO_EDGE) {
+                    csr.targets.push_back(j);
+                    csr.weights.push_back(row[j]);
+                }
+            }
+            csr.offsets[i + 1] = csr.targets.size();
+        }
     }
+
+    updateFromIndex();
 }
 
-void Graph::updateData() {
-    this->isDirected = false;
-    this->isWeighted = false;
-    this->haveNegativeEdgeWeight = false;
-    this->numEdges = 0;
-
-    for (size_t i = 0; i < getNumVertices(); i++) {
-        for (size_t j = 0; j < getNumVertices(); j++) {
-            if (adjMat[i][j] != NO_EDGE) {
-                this->numEdges++;
-
-                if (adjMat[i][j] != 1) {
-                    this->isWeighted = true;
-                }
+void Graph::updateFromIndex() {
+    size_t n = getNumVertices();
+    this->pending.clear();  // the index was built from the matrix (or it is the graph itself)
 
-                if (adjMat[i][j] < 0) {
-                    this->haveNegativeEdgeWeight = true;
-                }
+    this->edgeCells = csr.targets.size();
+    this->nonUnitWeights = 0;
+    this->negativeWeights = 0;
+    for (int weight : csr.weights) {
+        this->nonUnitWeights += (size_t)(weight != 1);
+        this->negativeWeights += (size_t)(weight < 0);
+    }
 
-                if (adjMat[i][j] != adjMat[j][i]) {
-                    this->isDirected = true;
-                }
+    buildInIndex();
+
+    // the graph is undirected iff the matrix is symmetric - iff the in edges of every vertex are the same as its out edges.
+    // merge the out edges and the in edges of every vertex, every different pair {u, v} is counted in row u and in row v
+    size_t different = 0;
+    for (size_t u = 0; u < n; u++) {
+        size_t out = csr.offsets[u];
+        size_t in = inCsr.offsets[u];
+        while (out < csr.offsets[u + 1] || in < inCsr.offsets[u + 1]) {
+            if (in == inCsr.offsets[u + 1] || (out < csr.offsets[u + 1] && csr.targets[out] < inCsr.targets[in])) {
+                different++;  // (u, v) without (v, u)
+                out++;
+            } else if (out == csr.offsets[u + 1] || inCsr.targets[in] < csr.targets[out]) {
+                different++;  // (v, u) without (u, v)
+                in++;
+            } else {
+                different += (size_t)(csr.weights[out] != inCsr.weights[in]);
+                out++;
+                in++;
             }
         }
     }
+    this->asymmetricPairs = different / 2;
 
+    updateFlags();
     if (!this->isDirected) {
-        this->numEdges /= 2;
+        inCsr = CSR();  // inNeighbors will use the out edges
     }
 }
 
-// ~~~ helper functions for the operators ~~~
+void Graph::updateFlags() {
+    this->isDirected = asymmetricPairs != 0;
+    this->isWeighted = nonUnitWeights != 0;
+    this->haveNegativeEdgeWeight = negativeWeights != 0;
+    this->numEdges = isDirected ? edgeCells : edgeCells / 2;
+    this->potentials.set(nullptr);
+}
 
-void Graph::modifyEdgeWeights(const function<int(int)>& func) {
-    for (size_t u = 0; u < getNumVertices(); u++) {
-        for (size_t v = 0; v < getNumVertices(); v++) {
-            if (adjMat[u][v] != NO_EDGE) {
-                int res = func(adjMat[u][v]);
-                if (res == 0) {
-                    adjMat[u][v] = NO_EDGE;
-                } else {
-                    adjMat[u][v] = res;
-                }
-            }
+void Graph::buildInIndex() const {
+    size_t n = getNumVertices();
+
+    // counting sort of the edges by the target vertex, so every row is sorted by the source
+    inCsr.offsets.assign(n + 1, 0);
+    for (size_t v : csr.targets) {
+        inCsr.offsets[v + 1]++;
+    }
+    for (size_t v = 0; v < n; v++) {
+        inCsr.offsets[v + 1] += inCsr.offsets[v];
+    }
+    inCsr.targets.resize(csr.targets.size());
+    inCsr.weights.resize(csr.weights.size());
+    vector<size_t> next(inCsr.offsets.begin(), inCsr.offsets.end() - 1);
+    for (size_t u = 0; u < n; u++) {
+        for (size_t e = csr.offsets[u]; e < csr.offsets[u + 1]; e++) {
+            size_t pos = next[csr.targets[e]]++;
+            inCsr.targets[pos] = u;
+            inCsr.weights[pos] = csr.weights[e];
         }
     }
+}
 
-    updateData();
+// ~~~ single edge changes ~~~
+
+void Graph::checkEdge(size_t u, size_t v, int weight) const {
+    if (u >= numVertices || v >= numVertices) {
+        throw invalid_argument("Invalid edge: (" + std::to_string(u) + ", " + std::to_string(v) + ") is not in a graph with " + std::to_string(numVertices) + " vertices.");
+    }
+    if (u == v && weight != NO_EDGE) {
+        throw invalid_argument("The diagonal of the matrix must be NO_EDGE. (the " + std::to_string(u) + "th node is not a NO_EDGE)");
+    }
+    if (storage == Storage::BITSET && weight != NO_EDGE && weight != 1) {
+        throw invalid_argument("Storage::BITSET requires an unweighted graph. (the edge (" + std::to_string(u) + ", " + std::to_string(v) + ") has weight " + std::to_string(weight) + ")");
+    }
 }
 
-void Graph::modifyEdgeWeights(const Graph& other, const function<int(int, int)>& func) {
-    if (this->getNumVertices() != other.getNumVertices()) {
-        throw std::invalid_argument("The two graphs have different number of vertices.");
+int Graph::weightOf(size_t u, size_t v) const {
+    if (storage == Storage::DENSE) {
+        return adjMat[u][v];
+    }
+    if (storage == Storage::BITSET) {
+        return bits.test(u, v) ? 1 : NO_EDGE;
     }
 
-    for (size_t u = 0; u < getNumVertices(); u++) {
-        for (size_t v = 0; v < getNumVertices(); v++) {
-            if (adjMat[u][v] == NO_EDGE && other.adjMat[u][v] == NO_EDGE) {  // if they are both NO_EDGE - the result edge is NO_EDGE
-                adjMat[u][v] = NO_EDGE;
-            } else if (adjMat[u][v] == NO_EDGE && other.adjMat[u][v] != NO_EDGE) {  // if one of them is NO_EDGE - the result edge is the other one
-                adjMat[u][v] = func(0, other.adjMat[u][v]);
-            } else if (adjMat[u][v] != NO_EDGE && other.adjMat[u][v] == NO_EDGE) {
-                adjMat[u][v] = func(adjMat[u][v], 0);
-            } else {  // if they are both not NO_EDGE - the result edge is the result of the operation
-                int res = func(adjMat[u][v], other.adjMat[u][v]);
-                if (res == 0 || res == NO_EDGE) {  // if the result is 0 or NO_EDGE - the result edge is NO_EDGE
-                    adjMat[u][v] = NO_EDGE;
-                } else {
-                    adjMat[u][v] = res;
+    // Storage::SPARSE - the pending change of the edge, or a binary search in the (sorted) row of u
+    int weight = NO_EDGE;
+    if (pending.find(u * numVertices + v, &weight)) {
+        return weight;
+    }
+    auto first = csr.targets.begin() + (std::ptrdiff_t)csr.offsets[u];
+    auto last = csr.targets.begin() + (std::ptrdiff_t)csr.offsets[u + 1];
+    auto it = std::lower_bound(first, last, v);
+    return it != last && *it == v ? csr.weights[(size_t)(it - csr.targets.begin())] : NO_EDGE;
+}
+
+void Graph::changeEdge(size_t u, size_t v, int weight) {
+    int old = weightOf(u, v);
+    if (old == weight) {
+        return;
+    }
+    int mirror = weightOf(v, u);
+
+    // the counters before and after the change
+    asymmetricPairs -= (size_t)(old != mirror);
+    asymmetricPairs += (size_t)(weight != mirror);
+    edgeCells -= (size_t)(old != NO_EDGE);
+    edgeCells += (size_t)(weight != NO_EDGE);
+    nonUnitWeights -= (size_t)(old != NO_EDGE && old != 1);
+    nonUnitWeights += (size_t)(weight != NO_EDGE && weight != 1);
+    negativeWeights -= (size_t)(old < 0);
+    negativeWeights += (size_t)(weight < 0);
+
+    if (storage == Storage::BITSET) {
+        // the transposed matrix is kept for every change (it was not built for an undirected graph)
+        if (inBits.size() != numVertices) {
+            inBits = bits.transposed();
+        }
+        if (weight == NO_EDGE) {
+            bits.reset(u, v);
+            inBits.reset(v, u);
+        } else {
+            bits.set(u, v);
+            inBits.set(v, u);
+        }
+    } else {
+        if (storage == Storage::DENSE) {
+            adjMat[u][v] = weight;
+        }
+        pending.record(u * numVertices + v, weight);
+    }
+
+    updateFlags();
+}
+
+void Graph::setEdge(size_t u, size_t v, int weight) {
+    checkEdge(u, v, weight);
+    changeEdge(u, v, weight);
+}
+
+void Graph::setEdges(const vector<Edge>& edges) {
+    for (const Edge& e : edges) {
+        checkEdge(e.from, e.to, e.weight);
+    }
+    for (const Edge& e : edges) {
+        changeEdge(e.from, e.to, e.weight);
+    }
+}
+
+int Graph::getEdgeWeight(size_t u, size_t v) const {
+    checkEdge(u, v, NO_EDGE);
+    if (storage == Storage::SPARSE) {
+        // another const reader may be merging the pending changes into csr right now - merge (or wait for the merge) first,
+        // so the lookup only reads csr after the merge, and the pending changes are not read while they are cleared
+        syncIndex();
+    }
+    return weightOf(u, v);
+}
+
+void Graph::mergePendingEdges() const {
+    std::lock_guard<std::mutex> lock(pending.mutex());
+    if (!pending.any()) {
+        return;  // another thread merged the changes
+    }
+
+    // the changes sorted by (u, v) - the same order as the edges in csr
+    vector<pair<size_t, int>> changes(pending.all().begin(), pending.all().end());
+    std::sort(changes.begin(), changes.end(), [](const pair<size_t, int>& a, const pair<size_t, int>& b) { return a.first < b.first; });
+
+    // merge every row of csr with the changes of the row
+    size_t n = getNumVertices();
+    CSR merged;
+    merged.offsets.assign(n + 1, 0);
+    merged.targets.reserve(edgeCells);
+    merged.weights.reserve(edgeCells);
+    size_t change = 0;
+    for (size_t u = 0; u < n; u++) {
+        size_t e = csr.offsets[u];
+        while (e < csr.offsets[u + 1] || (change < changes.size() && changes[change].first / n == u)) {
+            size_t v = 0;
+            int weight = NO_EDGE;
+            bool fromChange = change < changes.size() && changes[change].first / n == u;
+            if (fromChange && e < csr.offsets[u + 1] && csr.targets[e] < changes[change].first % n) {
+                fromChange = false;
+            }
+            if (fromChange) {
+                v = changes[change].first % n;
+                weight = changes[change].second;
+                change++;
+                if (e < csr.offsets[u + 1] && csr.targets[e] == v) {
+                    e++;  // the change replaces the old edge
                 }
+            } else {
+                v = csr.targets[e];
+                weight = csr.weights[e];
+                e++;
+            }
+            if (weight != NO_EDGE) {
+                merged.targets.push_back(v);
+                merged.weights.push_back(weight);
             }
         }
+        merged.offsets[u + 1] = merged.targets.size();
     }
+    csr = std::move(merged);
 
-    updateData();
+    if (isDirected) {
+        buildInIndex();
+    } else {
+        inCsr = CSR();
+    }
+    pending.clear();
 }
 
-bool isSubMatrix(const vector<vector<int>>& subMatrix, const vector<vector<int>>& matrix) {
+// ~~~ helper functions for the operators ~~~
+
+void Graph::indexRow(const int* row, size_t n, CSR* index) {
+    size_t count = 0;
+    for (size_t v = 0; v < n; v++) {
+        count += row[v] != NO_EDGE ? 1 : 0;
+    }
+
+    // every cell is written to the next free place, and the place is taken only if the cell is an edge (no branch to mispredict).
+    // one extra place for the cells after the last edge
+    size_t next = index->targets.size();
+    index->targets.resize(next + count + 1);
+    index->weights.resize(next + count + 1);
+    size_t* targets = index->targets.data();
+    int* weights = index->weights.data();
+    for (size_t v = 0; v < n; v++) {
+        targets[next] = v;
+        weights[next] = row[v];
+        next += row[v] != NO_EDGE ? 1 : 0;
+    }
+    index->targets.pop_back();
+    index->weights.pop_back();
+}
+
+bool isSubMatrix(const Matrix& subMatrix, const Matrix& matrix) {
     if (subMatrix.size() > matrix.size()) {
         return false;
     }
@@ -176,7 +751,7 @@ bool isSubMatrix(const vector<vector<int>>& subMatrix, const vector<vector<int>>
     return false;
 }
 
-bool matrixEqual(const vector<vector<int>>& mat1, const vector<vector<int>>& mat2) {
+bool matrixEqual(const Matrix& mat1, const Matrix& mat2) {
     if (mat1.size() != mat2.size()) {
         return false;
     }
@@ -194,39 +769,133 @@ bool matrixEqual(const vector<vector<int>>& mat1, const vector<vector<int>>& mat
 // ~~~~ operators ~~~~
 
 Graph Graph::operator*(const Graph& other) const {
+    this->requireDense("Graph multiplication");
+    other.requireDense("Graph multiplication");
     if (this->getNumVertices() != other.getNumVertices()) {
         throw std::invalid_argument("The two graphs have different number of vertices.");
     }
 
-    Graph g = *this;
+    // the product skips the zero cells and a zero sum stays zero - this is the same as skipping NO_EDGE and removing the edge if the sum is 0
+    static_assert(NO_EDGE == 0, "Graph multiplication assumes NO_EDGE is 0");
+
+    size_t n = getNumVertices();
+    Graph g;
+    g.numVertices = n;
 
-    // do matrix multiplication on the adjacency matrices
     // adjList[i][j] = sum(adjList[i][k] * adjList[k][j]) for all k
+    multiply(adjMat, other.adjMat, &g.adjMat);
+
     // the diagonal of the matrix must be NO_EDGE
-    for (size_t i = 0; i < getNumVertices(); i++) {
-        for (size_t j = 0; j < getNumVertices(); j++) {
-            if (i == j) {  // the diagonal of the matrix must be NO_EDGE
-                continue;
-            }
-            int sum = 0;
-            for (size_t k = 0; k < getNumVertices(); k++) {
-                if (adjMat[i][k] != NO_EDGE && other.adjMat[k][j] != NO_EDGE) {
-                    sum += adjMat[i][k] * other.adjMat[k][j];
-                }
-            }
-            if (sum != 0) {
-                g.adjMat[i][j] = sum;
+    for (size_t i = 0; i < n; i++) {
+        g.adjMat[i][i] = NO_EDGE;
+    }
+
+    g.updateData();
+    return g;
+}
+
+/**
+ * @brief base^k with exponentiation by squaring (k >= 1).
+ * result, base and scratch are reused by all the products, so after the first products there are no more allocations.
+ */
+template <typename SquareMatrix>
+SquareMatrix powerBySquaring(SquareMatrix base, size_t k) {
+    SquareMatrix result;
+    SquareMatrix scratch;
+    bool haveResult = false;
+    while (true) {
+        if ((k & 1U) != 0) {
+            if (!haveResult) {
+                result = base;
+                haveResult = true;
             } else {
-                g.adjMat[i][j] = NO_EDGE;
+                multiply(result, base, &scratch);
+                std::swap(result, scratch);
             }
         }
+        k >>= 1U;
+        if (k == 0) {
+            return result;
+        }
+        multiply(base, base, &scratch);
+        std::swap(base, scratch);
+    }
+}
+
+Graph Graph::power(size_t k) const {
+    this->requireDense("Graph power");
+    if (k == 0) {
+        throw invalid_argument("The power must be at least 1.");
+    }
+
+    Graph g;
+    g.numVertices = numVertices;
+    g.adjMat = powerBySquaring(adjMat, k);
+
+    // the diagonal of the matrix must be NO_EDGE
+    for (size_t i = 0; i < numVertices; i++) {
+        g.adjMat[i][i] = NO_EDGE;
+    }
+
+    g.updateData();
+    return g;
+}
+
+Graph Graph::reachabilityPower(size_t k) const {
+    if (k == 0) {
+        throw invalid_argument("The power must be at least 1.");
+    }
+
+    // the edges of the graph as bits
+    BitMatrix base(numVertices);
+    if (storage == Storage::BITSET) {
+        base = bits;
+    } else {
+        syncIndex();
+        for (size_t u = 0; u < numVertices; u++) {
+            for (Neighbor neighbor : rangeOf(csr, u)) {
+                base.set(u, neighbor.vertex);
+            }
+        }
+    }
+
+    Graph g;
+    g.storage = Storage::BITSET;
+    g.numVertices = numVertices;
+    g.bits = powerBySquaring(std::move(base), k);
+
+    // the diagonal of the matrix must be NO_EDGE
+    for (size_t i = 0; i < numVertices; i++) {
+        g.bits.reset(i, i);
     }
 
     g.updateData();
     return g;
 }
 
+Graph& Graph::operator*=(const Graph& other) {
+    this->requireDense("Graph multiplication");
+    other.requireDense("Graph multiplication");
+    if (this->getNumVertices() != other.getNumVertices()) {
+        throw std::invalid_argument("The two graphs have different number of vertices.");
+    }
+
+    // the product can't be done in place (every cell of the result needs a full row), so it is written to a new matrix that replaces adjMat
+    Matrix product;
+    multiply(adjMat, other.adjMat, &product);
+    for (size_t i = 0; i < numVertices; i++) {
+        product[i][i] = NO_EDGE;  // the diagonal of the matrix must be NO_EDGE
+    }
+    adjMat = std::move(product);
+
+    updateData();
+    return *this;
+}
+
 bool Graph::operator<(const Graph& other) const {
+    this->requireDense("Graph comparison");
+    other.requireDense("Graph comparison");
+
     // if they both empty graphs (no vertices and edges) return false
     if (this->adjMat.empty() && other.adjMat.empty()) {
         return false;
@@ -4,11 +4,24 @@
  */
 #pragma once
 
+#include <atomic>
+#include <cstddef>
 #include <functional>
 #include <iostream>
+#include <iterator>
 #include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "BitMatrix.hpp"
+#include "Matrix.hpp"
+
 using std::function;
 using std::vector;
 
@@ -17,47 +30,542 @@ constexpr int NO_EDGE = 0;                            // represent no edge betwe
 
 namespace shayg {
 
+/**
+ * @brief how the graph keeps its edges in memory
+ */
+enum class Storage {
+    DENSE,   // |V|x|V| adjacency matrix - O(V^2) memory, supports all the graph operators
+    SPARSE,  // compressed sparse row (CSR) arrays - O(V+E) memory, for big graphs with few edges
+    BITSET   // |V|x|V| matrix of bits - O(V^2 / 64) words, only for unweighted graphs (no neighbors index)
+};
+
+/**
+ * @brief a weighted edge (from -> to). used to load a graph without building an adjacency matrix first
+ */
+struct Edge {
+    size_t from;
+    size_t to;
+    int weight;
+};
+
+/**
+ * @brief compressed sparse row (CSR) representation of the adjacency matrix.
+ * the out edges of the vertex u are in the range [offsets[u], offsets[u + 1]) of the targets and weights vectors,
+ * sorted by the target vertex.
+ */
+struct CSR {
+    vector<size_t> offsets;  // |V| + 1 elements
+    vector<size_t> targets;  // |E| elements (2|E| for undirected graph)
+    vector<int> weights;     // the weight of the edge in the same index in targets
+};
+
+/**
+ * @brief the changes of single edges (Graph::setEdge) that are not in the CSR index yet.
+ * inserting an edge into the CSR arrays moves all the edges after it, so the changes are kept here,
+ * and they are merged into the index in one pass the next time the index is read.
+ * the merge can happen in a const function, so a mutex makes sure only one thread does it.
+ */
+class PendingEdges {
+   private:
+    std::unordered_map<size_t, int> changes;  // u * |V| + v -> the new weight of (u, v) (NO_EDGE if the edge was removed)
+    std::atomic<bool> hasChanges{false};
+    std::mutex mergeMutex;
+
+   public:
+    PendingEdges() = default;
+    PendingEdges(const PendingEdges& other) : changes(other.changes), hasChanges(other.hasChanges.load()) {}
+    PendingEdges(PendingEdges&& other) noexcept : changes(std::move(other.changes)), hasChanges(other.hasChanges.load()) { other.clear(); }
+    PendingEdges& operator=(const PendingEdges& other) {
+        if (this != &other) {
+            changes = other.changes;
+            hasChanges = other.hasChanges.load();
+        }
+        return *this;
+    }
+    PendingEdges& operator=(PendingEdges&& other) noexcept {
+        if (this != &other) {
+            changes = std::move(other.changes);
+            hasChanges = other.hasChanges.load();
+            other.clear();
+        }
+        return *this;
+    }
+    ~PendingEdges() = default;
+
+    /**
+     * @brief true if there are changes that are not in the index (one atomic load - called before every read of the index)
+     */
+    bool any() const { return hasChanges.load(std::memory_order_acquire); }
+
+    void record(size_t key, int weight) {
+        changes[key] = weight;
+        hasChanges.store(true, std::memory_order_release);
+    }
+
+    /**
+     * @brief the new weight of the cell, if it was changed
+     * @return true if the cell has a pending change
+     */
+    bool find(size_t key, int* weight) const {
+        auto it = changes.find(key);
+        if (it == changes.end()) {
+            return false;
+        }
+        *weight = it->second;
+        return true;
+    }
+
+    const std::unordered_map<size_t, int>& all() const { return changes; }
+    std::mutex& mutex() { return mergeMutex; }
+
+    void clear() {
+        changes.clear();
+        hasChanges.store(false, std::memory_order_release);
+    }
+};
+
+/**
+ * @brief the potentials that Algorithms keeps with a graph (see Graph::setPotentials).
+ * they are read and set by const queries, maybe on a few threads at once, so the pointer is only copied under a mutex.
+ * two threads that miss the cache at the same time both compute the potentials - they are the same, and the last one is kept.
+ */
+class PotentialsCache {
+   private:
+    std::shared_ptr<const vector<int>> potentials;
+    mutable std::mutex mutex;
+
+   public:
+    PotentialsCache() = default;
+    PotentialsCache(const PotentialsCache& other) : potentials(other.get()) {}
+    PotentialsCache(PotentialsCache&& other) noexcept : potentials(std::move(other.potentials)) {}
+    PotentialsCache& operator=(const PotentialsCache& other) {
+        if (this != &other) {
+            set(other.get());
+        }
+        return *this;
+    }
+    PotentialsCache& operator=(PotentialsCache&& other) noexcept {
+        if (this != &other) {
+            std::lock_guard<std::mutex> lock(mutex);
+            potentials = std::move(other.potentials);
+        }
+        return *this;
+    }
+    ~PotentialsCache() = default;
+
+    std::shared_ptr<const vector<int>> get() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return potentials;
+    }
+
+    void set(std::shared_ptr<const vector<int>> newPotentials) {
+        std::lock_guard<std::mutex> lock(mutex);
+        potentials.swap(newPotentials);  // the old potentials are freed after the lock (newPotentials holds them)
+    }
+};
+
+/**
+ * @brief an edge (u, v) as seen from u: the neighbor v and the weight of the edge
+ */
+struct Neighbor {
+    size_t vertex;
+    int weight;
+};
+
+/**
+ * @brief a range over the neighbors of a vertex, sorted by the neighbor vertex.
+ * the range points into the adjacency index of the graph, so it is valid until the graph is changed.
+ */
+class NeighborRange {
+   private:
+    const size_t* targets;
+    const int* weights;
+    size_t count;
+
+   public:
+    class iterator {
+       private:
+        const size_t* target;
+        const int* weight;
+
+       public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Neighbor;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = Neighbor;
+
+        iterator(const size_t* target, const int* weight) : target(target), weight(weight) {}
+
+        Neighbor operator*() const { return {*target, *weight}; }
+
+        iterator& operator++() {
+            ++target;
+            ++weight;
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator it = *this;
+            ++(*this);
+            return it;
+        }
+
+        bool operator==(const iterator& other) const { return target == other.target; }
+        bool operator!=(const iterator& other) const { return target != other.target; }
+    };
+
+    NeighborRange(const size_t* targets, const int* weights, size_t count) : targets(targets), weights(weights), count(count) {}
+
+    iterator begin() const { return {targets, weights}; }
+    iterator end() const { return {targets + count, weights + count}; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+};
+
+class Graph;
+class MappedFile;
+
+/**
+ * @brief the base of all the lazy graph expressions (see GraphExpr)
+ */
+struct GraphExprTag {};
+
+/**
+ * @brief a lazy expression of graphs (CRTP base). Derived has size(), storage(), at(i, j) - the weight of the cell (i, j) in the result,
+ * and for chains of unary operations on one graph, source() and mapWeight(weight).
+ * the queries of Graph can be called on an expression too (like `(g1 + g2).getGraph()`) - the expression is computed once, on the first query.
+ */
+template <typename Derived>
+class GraphExpr : public GraphExprTag {
+   private:
+    mutable std::shared_ptr<const Graph> value;  // the computed graph, for the queries (see result)
+
+   public:
+    const Derived& self() const { return static_cast<const Derived&>(*this); }
+
+    /**
+     * @brief the graph of the expression, computed on the first call and kept with the expression
+     */
+    const Graph& result() const;
+
+    const Matrix& getGraph() const;
+    size_t getNumVertices() const;
+    size_t getNumEdges() const;
+    bool isDirectedGraph() const;
+    bool isWeightedGraph() const;
+    bool isHaveNegativeEdgeWeight() const;
+    int getEdgeWeight(size_t u, size_t v) const;
+    void printGraph(std::ostream& os = std::cout) const;
+};
+
+/**
+ * @brief true if T can be an operand of the lazy operators (a Graph or an expression)
+ */
+template <typename T>
+constexpr bool isGraphOperand = std::is_same_v<T, Graph> || std::is_base_of_v<GraphExprTag, T>;
+
+/**
+ * @brief true if T is an expression (not a Graph)
+ */
+template <typename T>
+constexpr bool isGraphExpr = std::is_base_of_v<GraphExprTag, T>;
+
 /**
  * @brief an abstract class that represents a graph as an adjacency matrix
  */
 class Graph {
    private:
-    vector<vector<int>> adjMat;
-    bool isDirected;
-    bool isWeighted;
-    bool haveNegativeEdgeWeight;
-    size_t numEdges;
+    Matrix adjMat;
+    // the out edges of every vertex. the storage itself in Storage::SPARSE, an index over adjMat in Storage::DENSE (empty in Storage::BITSET).
+    // mutable - the pending edge changes are merged into it when it is read (see syncIndex)
+    mutable CSR csr;
+    mutable CSR inCsr;  // the in edges of every vertex (only for directed graphs)
+    mutable PendingEdges pending;  // the changes of setEdge that are not in csr and inCsr yet (csr + pending is the graph in Storage::SPARSE)
+    BitMatrix bits;    // the matrix in Storage::BITSET
+    BitMatrix inBits;  // the transposed matrix in Storage::BITSET (only for directed graphs)
+    std::shared_ptr<const MappedFile> mapping;  // the file that adjMat is a view of (see loadFile), kept open while the graph uses it
+    mutable PotentialsCache potentials;  // the cache of setPotentials, dropped on every change of the graph (see updateFlags)
+    Storage storage = Storage::DENSE;
+    size_t numVertices = 0;
+    bool isDirected = false;
+    bool isWeighted = false;
+    bool haveNegativeEdgeWeight = false;
+    size_t numEdges = 0;
+
+    // the counters behind the fields above, so a change of one edge updates the fields in O(1)
+    size_t edgeCells = 0;        // the number of cells that are not NO_EDGE (|E| for directed graph, 2|E| for undirected graph)
+    size_t asymmetricPairs = 0;  // the number of pairs {u, v} with mat[u][v] != mat[v][u] - the graph is directed iff there is one
+    size_t nonUnitWeights = 0;   // the number of edges with weight != 1 - the graph is weighted iff there is one
+    size_t negativeWeights = 0;  // the number of edges with negative weight
 
     /**
-     * @brief modify the weights of the edges in the graph using a function
+     * @brief modify the weights of the edges in the graph using a function (in place - the matrix is changed and the index is rebuilt in the same pass)
      * @note if func return 0, the edge will be removed.
      * @param func the function that will be applied to the weights of the edges, will take the current weight as an argument and change it.
+     * a template over the callable (and not std::function) so the call is inlined and the loop on the matrix can be vectorized.
+     * @throw logic_error if the graph is stored as Storage::BITSET
      */
-    void modifyEdgeWeights(const function<int(int)>& func);
+    template <typename Func>
+    void modifyEdgeWeights(Func func);
 
     /**
-     * @brief modify the weights of the edges in the graph using a function
-     * @note if func return 0, the edge will be removed.
-     * @param other the other graph that will be used to modify the weights of the edges
-     * @param func the function that will be applied to the weights of the edges, will take the current weight and the weight of the other graph as arguments and change the current weight with the result of the function.
-     * @throw invalid_argument if the two graphs have different number of vertices (the adjacency matrices are not the same size)
+     * @brief the same as modifyEdgeWeights, but the result is a new graph and this graph is not changed.
+     * the new matrix is written in one pass that reads this matrix (instead of a copy and then a pass on the copy).
+     */
+    template <typename Func>
+    Graph transformed(Func func) const;
+
+    /**
+     * @brief dst = func(src) on every edge of src (a cell that becomes 0 is NO_EDGE), and build the index of the out edges of dst.
+     * dst may be src (then the matrix is changed in place).
      */
-    void modifyEdgeWeights(const Graph& other, const function<int(int, int)>& func);
+    template <typename Func>
+    static void mapMatrix(const Matrix& src, Matrix* dst, Func func, CSR* index);
+
+    /**
+     * @brief add the edges of one row of the matrix (the cells that are not NO_EDGE) to the end of the index.
+     * called after the row is computed, while it is still in the cache - so the loop that computes the row has no branches and can be vectorized.
+     */
+    static void indexRow(const int* row, size_t n, CSR* index);
+
+    /**
+     * @brief compute an expression into this graph: every cell of the matrix is computed once (expr.at(i, j)) and the index of the edges
+     * is built in the same pass, then the fields are updated once. the expression may use this graph (every cell is read before it is written).
+     */
+    template <typename E>
+    void evaluate(const E& expr);
+
+    /**
+     * @brief the single pass of loadGraph: check every row of the matrix (the diagonal, and the weights for Storage::BITSET),
+     * copy it to the storage and build the index of the edges.
+     * @param getRow getRow(u) returns the n cells of row u (and throws if the row is not valid)
+     * @param releaseRow releaseRow(u) is called after row u is not needed anymore
+     */
+    template <typename GetRow, typename ReleaseRow>
+    void loadRows(size_t n, Storage storage, GetRow getRow, ReleaseRow releaseRow);
+
+    /**
+     * @brief the body of loadEdges and the text file readers: build the storage from lists of edges (edges with NO_EDGE weight are skipped).
+     * the vertices of the edges must already be checked. in Storage::SPARSE the edges are sorted into the CSR arrays with a counting sort,
+     * so the only extra memory is one row.
+     * @throw invalid_argument if an edge appears twice, or if storage is Storage::BITSET and an edge is weighted
+     */
+    void loadEdgeChunks(size_t numVertices, const vector<const vector<Edge>*>& chunks, Storage storage);
 
     /**
      * @brief update the isWeighted and haveNegativeEdgeWeight fields if needed.
      * check if a directed graph is a symmetric matrix
+     * rebuild the adjacency index (the out edges and in edges of every vertex)
      */
     void updateData();
 
+    /**
+     * @brief the second part of updateData, after the index of the out edges (csr) is built:
+     * update the fields from the weights of the edges, build the in edges index and check if the graph is directed. O(V + E)
+     */
+    void updateFromIndex();
+
+    /**
+     * @brief set isDirected, isWeighted, haveNegativeEdgeWeight and numEdges from the counters, and drop the cached potentials. O(1)
+     * called after every change of the graph
+     */
+    void updateFlags();
+
+    /**
+     * @brief the weight of the edge (u, v), or NO_EDGE. O(1), or O(log deg(u)) in Storage::SPARSE.
+     * reads the pending changes without the lock - only for the writers (changeEdge) or after syncIndex (getEdgeWeight)
+     */
+    int weightOf(size_t u, size_t v) const;
+
+    /**
+     * @brief check the vertices and the weight of an edge for setEdge
+     * @throw invalid_argument if the edge is not valid for this graph
+     */
+    void checkEdge(size_t u, size_t v, int weight) const;
+
+    /**
+     * @brief set the weight of the edge (u, v) after it was checked, and update the counters and the fields. O(1), or O(log deg(u)) in Storage::SPARSE
+     */
+    void changeEdge(size_t u, size_t v, int weight);
+
+    /**
+     * @brief merge the pending edge changes into the index, if there are any. called before every read of csr or inCsr
+     */
+    void syncIndex() const {
+        if (pending.any()) {
+            mergePendingEdges();
+        }
+    }
+
+    /**
+     * @brief merge the pending edge changes into csr (one pass over the edges and the sorted changes) and rebuild inCsr. O(V + E + k log k)
+     */
+    void mergePendingEdges() const;
+
+    /**
+     * @brief build the in edges index (inCsr) from csr - a counting sort of the edges by the target vertex. O(V + E)
+     */
+    void buildInIndex() const;
+
+    /**
+     * @brief get the neighbors of u in the given adjacency index
+     */
+    static NeighborRange rangeOf(const CSR& index, size_t u) {
+        return {index.targets.data() + index.offsets[u], index.weights.data() + index.offsets[u], index.offsets[u + 1] - index.offsets[u]};
+    }
+
+    /**
+     * @brief throw logic_error if the graph is not stored as an adjacency matrix.
+     * @param operation the name of the operation that needs the matrix, for the error message
+     */
+    void requireDense(const char* operation) const {
+        if (storage != Storage::DENSE) {
+            throw std::logic_error(std::string(operation) + " requires a graph with dense storage.");
+        }
+    }
+
+    /**
+     * @brief throw logic_error if the graph is not stored as bits.
+     */
+    void requireBits(const char* operation) const {
+        if (storage != Storage::BITSET) {
+            throw std::logic_error(std::string(operation) + " requires a graph with bitset storage.");
+        }
+    }
+
+    /**
+     * @brief throw logic_error if the graph has no neighbors index (Storage::BITSET).
+     */
+    void requireIndex(const char* operation) const {
+        if (storage == Storage::BITSET) {
+            throw std::logic_error(std::string(operation) + " is not available for a graph with bitset storage.");
+        }
+    }
+
    public:
     /**
      * @brief Load the graph from an adjacency matrix
      * @param adjMat the adjacency matrix
+     * @param storage how to store the graph. Default is Storage::DENSE (keep the adjacency matrix)
      * @throw invalid_argument if the graph is not a square matrix or the diagonal of the matrix is not NO_EDGE
      * @throw invalid_argument if the graph is undirected and the matrix is not symmetric
+     * @throw invalid_argument if storage is Storage::BITSET and the graph is weighted
+     */
+    void loadGraph(const vector<vector<int>>& adjMat, Storage storage = Storage::DENSE);
+
+    /**
+     * @brief Load the graph from an adjacency matrix that is moved in.
+     * every row of the matrix is freed right after it is copied, so loading a big graph takes the memory of one matrix (and not two).
+     * the rows of adjMat are left empty (also if the matrix is not valid).
+     * @throw the same as loadGraph(const vector<vector<int>>&, Storage)
+     */
+    void loadGraph(vector<vector<int>>&& adjMat, Storage storage = Storage::DENSE);
+
+    /**
+     * @brief Load the graph from an adjacency matrix in a buffer of the caller, row after row (the cell (u, v) is cells[u * numVertices + v]).
+     * in Storage::DENSE nothing is copied - the graph keeps a read-only view over the buffer, so the buffer must not change or be freed
+     * while the graph (or a copy of it) uses it. an operator that changes the matrix copies it first, the buffer is never changed.
+     * in the other storages the buffer is only read while the graph is loaded.
+     * the matrix is checked, and the index of the edges is built, in one pass over the cells.
+     * @param cells the numVertices x numVertices cells of the matrix
+     * @param numVertices the number of vertices in the graph (|V|)
+     * @param storage how to store the graph. Default is Storage::DENSE
+     * @throw invalid_argument if cells is null (and numVertices is not 0) or the diagonal of the matrix is not NO_EDGE
+     * @throw invalid_argument if storage is Storage::BITSET and the graph is weighted
+     */
+    void loadGraph(const int* cells, size_t numVertices, Storage storage = Storage::DENSE);
+
+    /**
+     * @brief Load the graph from a list of edges, without building an adjacency matrix (when storage is Storage::SPARSE).
+     * an edge with NO_EDGE weight is ignored. an undirected graph must contain each edge in both directions (with the same weight).
+     * @param numVertices the number of vertices in the graph (|V|)
+     * @param edges the edges of the graph
+     * @param storage how to store the graph. Default is Storage::SPARSE
+     * @throw invalid_argument if an edge has a vertex that is not in the graph, if there is an edge from a vertex to itself
+     * or if the same edge appears twice
+     * @throw invalid_argument if storage is Storage::BITSET and the graph is weighted
+     */
+    void loadEdges(size_t numVertices, const vector<Edge>& edges, Storage storage = Storage::SPARSE);
+
+    /**
+     * @brief Load the graph from a text file with one edge in every line: "u v w" (the weight is optional, 1 if it is missing).
+     * the vertices are 0 based and |V| is the largest vertex + 1. empty lines and lines that start with '#' or '%' are skipped.
+     * the file is mapped to memory and split between all the cores at line ends, every thread parses its part with std::from_chars
+     * (no locale, no streams), and the edges go straight into the storage (like loadEdges) - no adjacency matrix is built.
+     * an undirected graph must contain each edge in both directions (with the same weight).
+     * @param path the path of the file
+     * @param storage how to store the graph. Default is Storage::SPARSE
+     * @throw invalid_argument if the file can't be opened, if a line is not valid (the message has the line number),
+     * or for the same edges as loadEdges
+     */
+    void loadEdgeList(const std::string& path, Storage storage = Storage::SPARSE);
+
+    /**
+     * @brief Load the graph from a Matrix Market coordinate file ("%%MatrixMarket matrix coordinate integer|pattern general|symmetric|skew-symmetric",
+     * then "rows cols entries" and a line "i j [w]" for every entry, with 1 based vertices). a pattern file has weight 1 on every edge,
+     * and in a symmetric (or skew-symmetric) file every entry (i, j) adds the edge (j, i) too (with weight -w).
+     * the entries are parsed in parallel like in loadEdgeList.
+     * @param path the path of the file
+     * @param storage how to store the graph. Default is Storage::SPARSE
+     * @throw invalid_argument if the file can't be opened, is not a square coordinate matrix with integer (or pattern) entries,
+     * if a line is not valid, if the number of entries is not the number in the header, or for the same edges as loadEdges
+     */
+    void loadMatrixMarket(const std::string& path, Storage storage = Storage::SPARSE);
+
+    /**
+     * @brief Save the graph to a binary file (see GraphFileHeader for the layout): a header with |V|, |E|, the flags and the counters
+     * of the graph, then the matrix, the CSR arrays or the bits (the storage of the graph) and the index of the edges.
+     * the file is written in one pass over the arrays, without formatting a single number, to path + ".tmp" that is then renamed
+     * over the path, so a graph that was loaded from the same path keeps its mapping of the old file.
+     * @param path the path of the file (it is replaced if it exists)
+     * @throw invalid_argument if the file can't be written
+     */
+    void saveFile(const std::string& path) const;
+
+    /**
+     * @brief Load a graph that was saved with saveFile. the graph gets the storage it was saved with.
+     * the file is mapped to memory (mmap) and nothing is parsed: in Storage::DENSE the graph keeps a read-only view over the cells
+     * in the mapped file (the pages are read when they are used, and the matrix is copied only if an operator changes it),
+     * the index of the edges and the bits are copied from the file in one block, and the fields are taken from the header.
+     * the file is kept mapped while the graph (or a copy of it) uses it. the file must not be changed while it is mapped.
+     * @param path the path of the file
+     * @throw invalid_argument if the file can't be opened, is not a graph file, has another version or byte order, or is truncated
+     */
+    void loadFile(const std::string& path);
+
+    /**
+     * @brief Set the weight of one edge: add the edge (u, v), change its weight, or remove it if weight is NO_EDGE.
+     * The number of edges and the flags of the graph are updated in O(1) (with counters, without a scan of the matrix),
+     * and the neighbors index is updated the next time it is read (one merge for all the changes since the last read).
+     * in Storage::SPARSE finding the edge takes O(log deg(u)).
+     * @note the graph is undirected iff the matrix is symmetric, so to change an edge of an undirected graph set both (u, v) and (v, u).
+     * @param u the source vertex
+     * @param v the target vertex
+     * @param weight the new weight of the edge (NO_EDGE to remove it)
+     * @throw invalid_argument if u or v is not in the graph, if u == v (the diagonal must be NO_EDGE),
+     * or if the graph is stored as Storage::BITSET and the weight is not 1 or NO_EDGE
      */
-    void loadGraph(const vector<vector<int>>& adjMat);
+    void setEdge(size_t u, size_t v, int weight);
+
+    /**
+     * @brief Remove the edge (u, v) if it exists (the same as setEdge(u, v, NO_EDGE))
+     */
+    void removeEdge(size_t u, size_t v) { setEdge(u, v, NO_EDGE); }
+
+    /**
+     * @brief Set a batch of edges (like setEdge on every edge, in order - if an edge appears twice, the last weight is kept).
+     * all the edges are checked before the graph is changed, so if one of them is not valid the graph is not changed.
+     * @throw invalid_argument if one of the edges is not valid (see setEdge)
+     */
+    void setEdges(const vector<Edge>& edges);
+
+    /**
+     * @brief get the weight of the edge (u, v)
+     * @return the weight of the edge, or NO_EDGE if there is no edge
+     * @throw invalid_argument if u or v is not in the graph
+     */
+    int getEdgeWeight(size_t u, size_t v) const;
 
     /**
      * @brief Print the graph as an adjacency matrix
@@ -77,22 +585,111 @@ class Graph {
      * 0: 0 1 2
      * 1: 3 0 4
      * 2: 5 6 0
+     * the cells are written with std::to_chars into a buffer, and the buffer is written to the stream in blocks of about 1MB
+     * (a big matrix is formatted by all the cores, a block for every thread, and the blocks are written in order).
      *
      * @param os the output stream. Default is std::cout
      */
     void printAdjMat(std::ostream& = std::cout) const;
 
     /**
-     * @brief return the adjacency matrix of the graph
-     * @return vector<vector<int>> the adjacency matrix
+     * @brief Print the edges of the graph, one edge in every line: "u v w" (the format of loadEdgeList).
+     * an undirected graph has every edge in both directions (like in loadEdgeList).
+     * @param os the output stream. Default is std::cout
+     */
+    void printEdges(std::ostream& = std::cout) const;
+
+    /**
+     * @brief return the adjacency matrix of the graph.
+     * the matrix is one contiguous buffer, getGraph()[i] is a view of the i-th row (and can be converted to vector<vector<int>>).
+     * @return Matrix the adjacency matrix
+     * @throw logic_error if the graph is not stored as Storage::DENSE
      */
-    const vector<vector<int>>& getGraph() const { return this->adjMat; }
-    vector<vector<int>>& getGraph() { return this->adjMat; }
+    const Matrix& getGraph() const {
+        requireDense("getGraph");
+        return this->adjMat;
+    }
+
+    /**
+     * @brief return the CSR arrays of the graph (the out edges of every vertex).
+     * for Storage::SPARSE this is the graph itself, for Storage::DENSE this is an index that is kept up to date with the matrix.
+     * @return CSR the compressed sparse row representation of the adjacency matrix
+     */
+    const CSR& getCSR() const {
+        syncIndex();
+        return this->csr;
+    }
+
+    /**
+     * @brief return the bits of the adjacency matrix
+     * @return BitMatrix the adjacency matrix, one bit per cell
+     * @throw logic_error if the graph is not stored as Storage::BITSET
+     */
+    const BitMatrix& getBits() const {
+        requireBits("getBits");
+        return this->bits;
+    }
+
+    /**
+     * @brief return the bits of the transposed adjacency matrix (the in edges of every vertex).
+     * for undirected graph this is the same as getBits().
+     * @return BitMatrix the transposed adjacency matrix, one bit per cell
+     * @throw logic_error if the graph is not stored as Storage::BITSET
+     */
+    const BitMatrix& getInBits() const {
+        requireBits("getInBits");
+        return isDirected ? this->inBits : this->bits;
+    }
+
+    /**
+     * @brief get the out neighbors of a vertex - all v such that (u, v) is an edge. takes O(1) time.
+     * @param u the vertex (must be smaller than |V|)
+     * @return NeighborRange the neighbors of u with the weights of the edges, sorted by the neighbor vertex
+     * @throw logic_error if the graph is stored as Storage::BITSET (use getBits)
+     */
+    NeighborRange neighbors(size_t u) const {
+        requireIndex("neighbors");
+        syncIndex();
+        return rangeOf(csr, u);
+    }
+
+    /**
+     * @brief get the in neighbors of a vertex - all v such that (v, u) is an edge. takes O(1) time.
+     * for undirected graph this is the same as neighbors(u).
+     * @param u the vertex (must be smaller than |V|)
+     * @return NeighborRange the in neighbors of u with the weights of the edges, sorted by the neighbor vertex
+     * @throw logic_error if the graph is stored as Storage::BITSET (use getInBits)
+     */
+    NeighborRange inNeighbors(size_t u) const {
+        requireIndex("inNeighbors");
+        syncIndex();
+        return rangeOf(isDirected ? inCsr : csr, u);
+    }
+
+    /**
+     * @brief get the way the graph is stored
+     * @return Storage::DENSE, Storage::SPARSE or Storage::BITSET
+     */
+    Storage getStorage() const { return storage; }
+
+    /**
+     * @brief the potentials of the vertices that were kept with setPotentials (Algorithms uses them for Johnson's reweighting of the
+     * negative edges, so the queries after the first one don't run Bellman-Ford again)
+     * @return the potentials, or nullptr if they were not set since the last change of the graph
+     */
+    std::shared_ptr<const vector<int>> getPotentials() const { return potentials.get(); }
+
+    /**
+     * @brief keep a vector of potentials with the graph until the graph changes (see getPotentials).
+     * const - it is a cache of a value that is computed from the graph, not a part of the graph. safe to call from a few const queries at once
+     */
+    void setPotentials(std::shared_ptr<const vector<int>> potentials) const { this->potentials.set(std::move(potentials)); }
+
     /**
      * @brief get the number of vertices and edges in the graph
      * @return size_t the number of vertices in the graph (|V|)
      */
-    size_t getNumVertices() const { return adjMat.size(); }
+    size_t getNumVertices() const { return numVertices; }
 
     /**
      * @brief get the number of vertices and edges in the graph
@@ -119,75 +716,61 @@ class Graph {
     bool isHaveNegativeEdgeWeight() const { return haveNegativeEdgeWeight; }
 
     // ~~~ Operators overloading ~~~
-    /**
-     * @brief Unary + operator
-     * @return Graph a copy of the current graph
-     */
-    Graph operator+() const { return *this; }
+    /*
+    the element-wise operators (binary + and -, unary -, * int and / int) are lazy - they return an expression (see GraphExpr below)
+    that is computed when it is assigned to a graph. these operators are defined after the class.
+    */
+
+    Graph() = default;
 
     /**
-     * @brief Binary + operator.
-     * Will return a new graph that is the sum of the two graphs. (the sum of the adjacency matrices)
-     * If A(u, v) + B(u, v) = 0, the edge will be removed.
-     * @param other the other graph
-     * @return Graph the sum of the two graphs
-     * @throw invalid_argument if the two graphs have different number of vertices (the adjacency matrices are not the same size)
+     * @brief Create a graph from an expression (like `Graph g = g1 + g2 * 2;`)
+     * All the cells of the matrix are computed in one pass, and the fields are updated once at the end.
      */
-    Graph operator+(const Graph& other) const {
-        Graph newGraph = *this;  // copy the current graph
-        newGraph.modifyEdgeWeights(other, [](int a, int b) { return a + b; });
-        return newGraph;
+    template <typename E>
+    Graph(const GraphExpr<E>& expr) {  // NOLINT(google-explicit-constructor) - an expression is used like a graph
+        evaluate(expr.self());
     }
+
     /**
-     * @brief += operator.
-     * Will add the other graph to the current graph.
-     * If A(u, v) + B(u, v) = 0, the edge will be removed.
-     * @param other the other graph
-     * @return the current graph after adding the other graph
-     * @throw invalid_argument if the two graphs have different number of vertices (the adjacency matrices are not the same size)
+     * @brief Assign an expression to the graph (like `g = g1 + g2 * 2;`)
+     * The expression may use this graph (like `g = g - g1`) - every cell is read before it is written.
      */
-    Graph& operator+=(const Graph& other) {
-        *this = *this + other;  // call the + operator and assign the result to the current graph
+    template <typename E>
+    Graph& operator=(const GraphExpr<E>& expr) {
+        evaluate(expr.self());
         return *this;
     }
 
     /**
-     * @brief Unary - operator
-     * will return a new graph that is the negative of the current graph. (the negative of the adjacency matrix)
-     * @return Graph the negative of the current graph
+     * @brief Unary + operator
+     * @return Graph a copy of the current graph
      */
-    Graph operator-() const {
-        Graph g = *this;
-        g.modifyEdgeWeights([](int weight) { return -weight; });
-        return g;
-    }
+    Graph operator+() const { return *this; }
 
     /**
-     * @brief Binary - operator
-     * Will return a new graph that is the difference of the two graphs. (the difference of the adjacency matrices)
-     * If A(u, v) - B(u, v) = 0, the edge will be removed.
+     * @brief += operator.
+     * Will add the other graph (or expression) to the current graph, in place.
+     * If A(u, v) + B(u, v) = 0, the edge will be removed.
      * @param other the other graph
-     * @return A new graph that is the difference of the two graphs
+     * @return the current graph after adding the other graph
      * @throw invalid_argument if the two graphs have different number of vertices (the adjacency matrices are not the same size)
+     * @throw logic_error if one of the graphs is not stored as Storage::DENSE
      */
-    Graph operator-(const Graph& other) const {
-        Graph newGraph = *this;  // copy the current graph
-        newGraph.modifyEdgeWeights(other, [](int a, int b) { return a - b; });
-        return newGraph;
-    }
+    template <typename T, typename = std::enable_if_t<isGraphOperand<T>>>
+    Graph& operator+=(const T& other);
 
     /**
      * @brief -= operator
-     * Will subtract the other graph from the current graph.
+     * Will subtract the other graph (or expression) from the current graph, in place.
      * If A(u, v) - B(u, v) = 0, the edge will be removed.
      * @param other the other graph
      * @return a reference to the current graph after subtracting the other graph
      * @throw invalid_argument if the two graphs have different number of vertices (the adjacency matrices are not the same size)
+     * @throw logic_error if one of the graphs is not stored as Storage::DENSE
      */
-    Graph& operator-=(const Graph& other) {
-        *this = *this - other;  // call the - operator and assign the result to the current graph
-        return *this;
-    }
+    template <typename T, typename = std::enable_if_t<isGraphOperand<T>>>
+    Graph& operator-=(const T& other);
 
     /**
      * @brief prefix ++ operator (++Graph)
@@ -209,9 +792,10 @@ class Graph {
      * If the weight of an edge is -1, then the edge will be removed.
      */
     Graph operator++(int) {
-        Graph g = *this;  // copy the current graph
-        ++(*this);        // call the ++ operator on the original graph
-        return g;         // return the copy of the original graph (without the increment)
+        // build the incremented graph from the current one, and swap them - the old graph is returned without a copy
+        Graph g = transformed([](int weight) { return weight + 1; });
+        std::swap(*this, g);
+        return g;
     }
 
     /**
@@ -234,58 +818,60 @@ class Graph {
      * If the weight of an edge is 1, then the edge will be removed.
      */
     Graph operator--(int) {
-        Graph g = *this;  // copy the current graph
-        --(*this);        // call the -- operator on the original graph
-        return g;         // return the copy of the original graph (without the decrement)
+        // build the decremented graph from the current one, and swap them - the old graph is returned without a copy
+        Graph g = transformed([](int weight) { return weight - 1; });
+        std::swap(*this, g);
+        return g;
     }
 
     /**
      * @brief Binary * operator
      * Will return a new graph that is the matrix multiplication of the two graphs. (the matrix multiplication of the adjacency matrices)
      * If AB(u, v) = 0, the edge will be removed.
+     * The product is not element-wise, so it is not lazy - an expression operand is computed first.
      * @param other the other graph
      * @return a new graph that is the matrix multiplication of the two graphs
      * @throw invalid_argument if the two graphs have different number of vertices (the adjacency matrices are not the same size)
+     * @throw logic_error if one of the graphs is not stored as Storage::DENSE
      */
     Graph operator*(const Graph& other) const;
 
     /**
-     * @brief *= operator
-     * Will multiply the current graph by the other graph.
-     * If AB(u, v) = 0, the edge will be removed.
-     * @param other the other graph
-     * @return a reference to the current graph after multiplying it by the other graph
-     * @throw invalid_argument if the two graphs have different number of vertices (the adjacency matrices are not the same size)
+     * @brief The k-th power of the graph (the adjacency matrix to the power of k), computed with exponentiation by squaring -
+     * O(log k) matrix products, on three scratch matrices that are reused by all the products.
+     * The weight of (u, v) is the sum over all the walks of length k from u to v of the product of their weights
+     * (for unweighted graph - the number of walks of length k from u to v). If the sum is 0, there is no edge.
+     * Unlike k times `g *= g`, the diagonal is set to NO_EDGE only in the result (the walks may pass through their start vertex).
+     * The weights are int, so big powers of big graphs can overflow (the overflow wraps around).
+     * @param k the power (k >= 1)
+     * @return a new graph (Storage::DENSE) that is the k-th power of the graph
+     * @throw invalid_argument if k = 0 (the identity matrix has edges on the diagonal)
+     * @throw logic_error if the graph is not stored as Storage::DENSE
      */
-    Graph& operator*=(const Graph& other) {
-        *this = *this * other;  // call the * operator and assign the result to the current graph
-        return *this;
-    }
+    Graph power(size_t k) const;
 
     /**
-     * @brief Binary * operator with a scalar (Graph * int)
-     * Will return a new graph that is the current graph multiplied by a scalar.
-     * If A(u, v) * factor = 0, the edge will be removed. (iff factor = 0 || A(u, v) = 0)
-     *
-     * @param factor the scalar
-     * @return a new graph that is the current graph multiplied by a scalar
+     * @brief The k-th power of the graph in the boolean semiring (OR instead of +, AND instead of *):
+     * (u, v) is an edge iff there is a walk of exactly k edges from u to v (u != v). The weights are ignored.
+     * The products are done on bits (64 vertices in every word), so this is much faster than power(k) when only the reachability is needed.
+     * Works on all the storages.
+     * @param k the power (k >= 1)
+     * @return a new unweighted graph stored as Storage::BITSET
+     * @throw invalid_argument if k = 0
      */
-    Graph operator*(int factor) const {
-        Graph g = *this;
-        g.modifyEdgeWeights([factor](int weight) { return weight * factor; });
-        return g;
-    }
+    Graph reachabilityPower(size_t k) const;
 
     /**
-     * @brief Binary * operator with a scalar (int * Graph)
-     * Will return a new graph that is the current graph multiplied by a scalar.
-     * If A(u, v) * factor = 0, the edge will be removed. (iff factor = 0 || A(u, v) = 0)
-     * @param factor the scalar
-     * @param g a new graph that is the current graph multiplied by a scalar
+     * @brief *= operator
+     * Will multiply the current graph by the other graph.
+     * If AB(u, v) = 0, the edge will be removed.
+     * @param other the other graph
+     * The product is written to a new matrix that replaces the current one (the other parts of the graph are not copied).
+     * @return a reference to the current graph after multiplying it by the other graph
+     * @throw invalid_argument if the two graphs have different number of vertices (the adjacency matrices are not the same size)
+     * @throw logic_error if one of the graphs is not stored as Storage::DENSE
      */
-    friend Graph operator*(int factor, const Graph& g) {
-        return g * factor;
-    }
+    Graph& operator*=(const Graph& other);
 
     /**
      * @brief *= operator with a scalar
@@ -295,28 +881,10 @@ class Graph {
      * @return a reference to the current graph after multiplying it by a scalar
      */
     Graph& operator*=(int factor) {
-        *this = *this * factor;
+        modifyEdgeWeights([factor](int weight) { return weight * factor; });  // change the matrix in place
         return *this;
     }
 
-    /**
-     * @brief Binary / operator with a scalar
-     * Will return a new graph that is the current graph divided by a scalar.
-     * If A(u, v) / factor = 0, the edge will be removed. (iff A(u, v) = 0)
-     * @param factor the scalar (the divisor)
-     * @return a new graph that is the current graph divided by a scalar
-     * @throw invalid_argument if the factor is 0
-     *
-     */
-    Graph operator/(int factor) const {
-        if (factor == 0) {
-            throw std::invalid_argument("Division by zero.");
-        }
-        Graph g = *this;
-        g.modifyEdgeWeights([factor](int weight) { return weight / factor; });
-        return g;
-    }
-
     /**
      * @brief /= operator with a scalar
      * Will divide the current graph by a scalar.
@@ -326,7 +894,10 @@ class Graph {
      * @throw invalid_argument if the factor is 0
      */
     Graph& operator/=(int factor) {
-        *this = *this / factor;
+        if (factor == 0) {
+            throw std::invalid_argument("Division by zero.");
+        }
+        modifyEdgeWeights([factor](int weight) { return weight / factor; });  // change the matrix in place
         return *this;
     }
 
@@ -362,6 +933,7 @@ class Graph {
      *
      * @param other the other graph
      * @return true if the current graph is less than the other graph, false otherwise
+     * @throw logic_error if one of the graphs is not stored as Storage::DENSE
      */
     bool operator<(const Graph& other) const;
 
@@ -397,4 +969,456 @@ class Graph {
     friend std::ostream& operator<<(std::ostream& os, const Graph& graph);
 };
 
+// ~~~ Lazy arithmetic (expression templates) ~~~
+/*
+the element-wise operators don't compute a new matrix. they return a small object that keeps the operation and its operands,
+and the matrix is computed when the expression is assigned to a graph (or used where a Graph is needed) - in one pass over the matrix,
+with one update of the fields at the end. for example `g = (g1 + g2) * 3 - g3` reads every cell of g1, g2 and g3 once, and writes every cell of g once.
+
+the operands are checked (sizes and storage) when the expression is built, so the errors are thrown where the operator is used.
+an expression keeps pointers to its named graphs, so it must be assigned before the graphs are changed or destroyed (don't keep it with `auto`).
+a temporary graph (like `make() * 2`) is moved into the expression (see GraphValue), so it lives as long as the expression.
+*/
+
+/**
+ * @brief a graph in an expression (a leaf of the expression tree)
+ */
+class GraphRef : public GraphExpr<GraphRef> {
+   private:
+    const Graph* graph;
+    const int* cells = nullptr;  // the matrix of the graph (only in Storage::DENSE)
+    size_t stride = 0;
+
+   public:
+    static constexpr bool DENSE_ONLY = false;
+
+    /**
+     * @throw logic_error if the graph is stored as Storage::BITSET (the result may be weighted)
+     */
+    explicit GraphRef(const Graph& graph) : graph(&graph) {
+        if (graph.getStorage() == Storage::BITSET) {
+            throw std::logic_error("Graph arithmetic requires a graph with dense storage.");
+        }
+        if (graph.getStorage() == Storage::DENSE) {
+            cells = graph.getGraph().data();
+            stride = graph.getGraph().stride();
+        }
+    }
+
+    size_t size() const { return graph->getNumVertices(); }
+    Storage storage() const { return graph->getStorage(); }
+    const Graph& source() const { return *graph; }
+    int at(size_t i, size_t j) const { return cells[i * stride + j]; }
+    int mapWeight(int weight) const { return weight; }
+};
+
+/**
+ * @brief a temporary graph in an expression (a leaf that owns its graph). the graph is moved to the heap once, and the copies of the leaf
+ * that are made while the expression tree is built share it
+ */
+class GraphValue : public GraphExpr<GraphValue> {
+   private:
+    std::shared_ptr<const Graph> graph;
+    GraphRef ref;  // the cells of the owned graph
+
+   public:
+    static constexpr bool DENSE_ONLY = false;
+
+    /**
+     * @throw logic_error if the graph is stored as Storage::BITSET (the result may be weighted)
+     */
+    explicit GraphValue(Graph&& graph) : graph(std::make_shared<const Graph>(std::move(graph))), ref(*this->graph) {}
+
+    size_t size() const { return ref.size(); }
+    Storage storage() const { return ref.storage(); }
+    const Graph& source() const { return ref.source(); }
+    int at(size_t i, size_t j) const { return ref.at(i, j); }
+    int mapWeight(int weight) const { return weight; }
+};
+
+/**
+ * @brief an operation on every edge of an expression (unary -, * int, / int). NO_EDGE stays NO_EDGE, and a result of 0 removes the edge.
+ */
+template <typename E, typename Op>
+class UnaryExpr : public GraphExpr<UnaryExpr<E, Op>> {
+   private:
+    E expr;
+    Op op;
+
+   public:
+    static constexpr bool DENSE_ONLY = E::DENSE_ONLY;
+
+    UnaryExpr(const E& expr, Op op) : expr(expr), op(op) {}
+
+    size_t size() const { return expr.size(); }
+    Storage storage() const { return expr.storage(); }
+    const Graph& source() const { return expr.source(); }
+    int at(size_t i, size_t j) const { return apply(expr.at(i, j)); }
+    int mapWeight(int weight) const { return apply(expr.mapWeight(weight)); }
+
+   private:
+    int apply(int inner) const { return inner == NO_EDGE ? NO_EDGE : op(inner); }
+};
+
+/**
+ * @brief an operation on the cells of two expressions (+, -). if both cells are NO_EDGE the result is NO_EDGE,
+ * otherwise op(a, b) (NO_EDGE is 0), and a result of 0 removes the edge.
+ */
+template <typename L, typename R, typename Op>
+class BinaryExpr : public GraphExpr<BinaryExpr<L, R, Op>> {
+   private:
+    L left;
+    R right;
+    Op op;
+
+   public:
+    static constexpr bool DENSE_ONLY = true;
+
+    /**
+     * @throw logic_error if one of the operands is not stored as Storage::DENSE
+     * @throw invalid_argument if the operands have different number of vertices
+     */
+    BinaryExpr(const L& left, const R& right, Op op) : left(left), right(right), op(op) {
+        if (left.storage() != Storage::DENSE || right.storage() != Storage::DENSE) {
+            throw std::logic_error("Graph arithmetic requires a graph with dense storage.");
+        }
+        if (left.size() != right.size()) {
+            throw std::invalid_argument("The two graphs have different number of vertices.");
+        }
+    }
+
+    size_t size() const { return left.size(); }
+    Storage storage() const { return Storage::DENSE; }
+    const Graph& source() const { return left.source(); }
+    int at(size_t i, size_t j) const {
+        int a = left.at(i, j);
+        int b = right.at(i, j);
+        return a == NO_EDGE && b == NO_EDGE ? NO_EDGE : op(a, b);
+    }
+    int mapWeight(int weight) const { return weight; }  // not used - a binary expression is always dense
+};
+
+// the operations of the expressions
+struct AddOp {
+    int operator()(int a, int b) const { return a + b; }
+};
+struct SubtractOp {
+    int operator()(int a, int b) const { return a - b; }
+};
+struct NegateOp {
+    int operator()(int weight) const { return -weight; }
+};
+struct ScaleOp {
+    int factor;
+    int operator()(int weight) const { return weight * factor; }
+};
+struct DivideOp {
+    int divisor;
+    int operator()(int weight) const { return weight / divisor; }
+};
+
+/**
+ * @brief the expression of an operand - a named graph becomes a GraphRef, a temporary graph is moved into a GraphValue,
+ * and an expression stays as it is
+ */
+inline GraphRef operand(const Graph& g) { return GraphRef(g); }
+inline GraphValue operand(Graph&& g) { return GraphValue(std::move(g)); }
+template <typename E>
+const E& operand(const GraphExpr<E>& expr) {
+    return expr.self();
+}
+template <typename T>
+using OperandType = std::decay_t<decltype(operand(std::declval<T>()))>;
+
+/**
+ * @brief Binary + operator.
+ * The sum of the two graphs (the sum of the adjacency matrices). If A(u, v) + B(u, v) = 0, the edge will be removed.
+ * @return a lazy expression of the sum
+ * @throw invalid_argument if the two graphs have different number of vertices (the adjacency matrices are not the same size)
+ * @throw logic_error if one of the graphs is not stored as Storage::DENSE
+ */
+template <typename L, typename R, typename = std::enable_if_t<isGraphOperand<std::decay_t<L>> && isGraphOperand<std::decay_t<R>>>>
+BinaryExpr<OperandType<L>, OperandType<R>, AddOp> operator+(L&& left, R&& right) {
+    return {operand(std::forward<L>(left)), operand(std::forward<R>(right)), AddOp{}};
+}
+
+/**
+ * @brief Binary - operator
+ * The difference of the two graphs (the difference of the adjacency matrices). If A(u, v) - B(u, v) = 0, the edge will be removed.
+ * @return a lazy expression of the difference
+ * @throw invalid_argument if the two graphs have different number of vertices (the adjacency matrices are not the same size)
+ * @throw logic_error if one of the graphs is not stored as Storage::DENSE
+ */
+template <typename L, typename R, typename = std::enable_if_t<isGraphOperand<std::decay_t<L>> && isGraphOperand<std::decay_t<R>>>>
+BinaryExpr<OperandType<L>, OperandType<R>, SubtractOp> operator-(L&& left, R&& right) {
+    return {operand(std::forward<L>(left)), operand(std::forward<R>(right)), SubtractOp{}};
+}
+
+/**
+ * @brief Unary - operator
+ * The negative of the graph (the negative of the adjacency matrix).
+ * @return a lazy expression of the negative graph
+ * @throw logic_error if the graph is stored as Storage::BITSET
+ */
+template <typename T, typename = std::enable_if_t<isGraphOperand<std::decay_t<T>>>>
+UnaryExpr<OperandType<T>, NegateOp> operator-(T&& g) {
+    return {operand(std::forward<T>(g)), NegateOp{}};
+}
+
+/**
+ * @brief Binary * operator with a scalar (Graph * int)
+ * The graph multiplied by a scalar. If A(u, v) * factor = 0, the edge will be removed. (iff factor = 0 || A(u, v) = 0)
+ * @return a lazy expression of the graph multiplied by a scalar
+ * @throw logic_error if the graph is stored as Storage::BITSET
+ */
+template <typename T, typename = std::enable_if_t<isGraphOperand<std::decay_t<T>>>>
+UnaryExpr<OperandType<T>, ScaleOp> operator*(T&& g, int factor) {
+    return {operand(std::forward<T>(g)), ScaleOp{factor}};
+}
+
+/**
+ * @brief Binary * operator with a scalar (int * Graph)
+ */
+template <typename T, typename = std::enable_if_t<isGraphOperand<std::decay_t<T>>>>
+UnaryExpr<OperandType<T>, ScaleOp> operator*(int factor, T&& g) {
+    return {operand(std::forward<T>(g)), ScaleOp{factor}};
+}
+
+/**
+ * @brief Binary / operator with a scalar
+ * The graph divided by a scalar. If A(u, v) / factor = 0, the edge will be removed.
+ * @return a lazy expression of the graph divided by a scalar
+ * @throw invalid_argument if the factor is 0
+ * @throw logic_error if the graph is stored as Storage::BITSET
+ */
+template <typename T, typename = std::enable_if_t<isGraphOperand<std::decay_t<T>>>>
+UnaryExpr<OperandType<T>, DivideOp> operator/(T&& g, int factor) {
+    if (factor == 0) {
+        throw std::invalid_argument("Division by zero.");
+    }
+    return {operand(std::forward<T>(g)), DivideOp{factor}};
+}
+
+/**
+ * @brief Binary * operator (matrix multiplication) with an expression on the left - the expression is computed first
+ */
+template <typename E>
+Graph operator*(const GraphExpr<E>& left, const Graph& right) {
+    return Graph(left) * right;
+}
+
+/**
+ * @brief print an expression (computed first)
+ */
+template <typename E>
+std::ostream& operator<<(std::ostream& os, const GraphExpr<E>& expr) {
+    return os << expr.result();
+}
+
+/**
+ * @brief the graph of a comparison operand - a graph as it is, an expression computed
+ */
+inline const Graph& comparedGraph(const Graph& g) { return g; }
+template <typename E>
+const Graph& comparedGraph(const GraphExpr<E>& expr) {
+    return expr.result();
+}
+
+/*
+the comparison operators with an expression on one side (or both) - the expressions are computed, and the graphs are compared
+like in Graph::operator== and Graph::operator<
+*/
+template <typename L, typename R>
+using EnableIfExprComparison = std::enable_if_t<isGraphOperand<L> && isGraphOperand<R> && (isGraphExpr<L> || isGraphExpr<R>)>;
+
+template <typename L, typename R, typename = EnableIfExprComparison<L, R>>
+bool operator==(const L& left, const R& right) {
+    return comparedGraph(left) == comparedGraph(right);
+}
+template <typename L, typename R, typename = EnableIfExprComparison<L, R>>
+bool operator!=(const L& left, const R& right) {
+    return comparedGraph(left) != comparedGraph(right);
+}
+template <typename L, typename R, typename = EnableIfExprComparison<L, R>>
+bool operator<(const L& left, const R& right) {
+    return comparedGraph(left) < comparedGraph(right);
+}
+template <typename L, typename R, typename = EnableIfExprComparison<L, R>>
+bool operator>(const L& left, const R& right) {
+    return comparedGraph(left) > comparedGraph(right);
+}
+template <typename L, typename R, typename = EnableIfExprComparison<L, R>>
+bool operator<=(const L& left, const R& right) {
+    return comparedGraph(left) <= comparedGraph(right);
+}
+template <typename L, typename R, typename = EnableIfExprComparison<L, R>>
+bool operator>=(const L& left, const R& right) {
+    return comparedGraph(left) >= comparedGraph(right);
+}
+
+// ~ the queries of an expression ~
+
+template <typename Derived>
+const Graph& GraphExpr<Derived>::result() const {
+    if (!value) {
+        value = std::make_shared<const Graph>(self());
+    }
+    return *value;
+}
+
+template <typename Derived>
+const Matrix& GraphExpr<Derived>::getGraph() const {
+    return result().getGraph();
+}
+template <typename Derived>
+size_t GraphExpr<Derived>::getNumVertices() const {
+    return result().getNumVertices();
+}
+template <typename Derived>
+size_t GraphExpr<Derived>::getNumEdges() const {
+    return result().getNumEdges();
+}
+template <typename Derived>
+bool GraphExpr<Derived>::isDirectedGraph() const {
+    return result().isDirectedGraph();
+}
+template <typename Derived>
+bool GraphExpr<Derived>::isWeightedGraph() const {
+    return result().isWeightedGraph();
+}
+template <typename Derived>
+bool GraphExpr<Derived>::isHaveNegativeEdgeWeight() const {
+    return result().isHaveNegativeEdgeWeight();
+}
+template <typename Derived>
+int GraphExpr<Derived>::getEdgeWeight(size_t u, size_t v) const {
+    return result().getEdgeWeight(u, v);
+}
+template <typename Derived>
+void GraphExpr<Derived>::printGraph(std::ostream& os) const {
+    result().printGraph(os);
+}
+
+template <typename T, typename>
+Graph& Graph::operator+=(const T& other) {
+    return *this = *this + other;  // computed in place
+}
+
+template <typename T, typename>
+Graph& Graph::operator-=(const T& other) {
+    return *this = *this - other;  // computed in place
+}
+
+template <typename E>
+void Graph::evaluate(const E& expr) {
+    if constexpr (!E::DENSE_ONLY) {
+        if (expr.storage() == Storage::SPARSE) {
+            // a chain of unary operations on one sparse graph - apply it on the weights of the edges
+            Graph result = expr.source();
+            result.modifyEdgeWeights([&expr](int weight) { return expr.mapWeight(weight); });
+            *this = std::move(result);
+            return;
+        }
+    }
+
+    // if this graph has a matrix of the right size, the expression is written into it (every cell is read before it is written)
+    size_t n = expr.size();
+    Matrix result;
+    bool inPlace = storage == Storage::DENSE && adjMat.size() == n;
+    if (!inPlace) {
+        result = Matrix(n);
+    }
+    Matrix& target = inPlace ? adjMat : result;
+
+    // the expression reads only matrices, so the index of this graph is rebuilt in its own buffers
+    csr.offsets.assign(n + 1, 0);
+    csr.targets.clear();
+    csr.weights.clear();
+    for (size_t i = 0; i < n; i++) {
+        int* row = target[i].data();
+        for (size_t j = 0; j < n; j++) {
+            row[j] = expr.at(i, j);
+        }
+        indexRow(row, n, &csr);
+        csr.offsets[i + 1] = csr.targets.size();
+    }
+
+    if (!inPlace) {
+        adjMat = std::move(result);
+    }
+    bits = BitMatrix();
+    storage = Storage::DENSE;
+    numVertices = n;
+    updateFromIndex();
+}
+
+template <typename Func>
+void Graph::mapMatrix(const Matrix& src, Matrix* dst, Func func, CSR* index) {
+    size_t n = src.size();
+    index->offsets.assign(n + 1, 0);
+    index->targets.clear();
+    index->weights.clear();
+
+    for (size_t u = 0; u < n; u++) {
+        const int* row = src[u].data();
+        int* out = (*dst)[u].data();
+        for (size_t v = 0; v < n; v++) {
+            int weight = row[v];
+            out[v] = weight == NO_EDGE ? NO_EDGE : func(weight);  // if func returns 0 the edge is removed (NO_EDGE is 0)
+        }
+        indexRow(out, n, index);
+        index->offsets[u + 1] = index->targets.size();
+    }
+}
+
+template <typename Func>
+void Graph::modifyEdgeWeights(Func func) {
+    if (storage == Storage::BITSET) {  // the result may be weighted
+        requireDense("Graph arithmetic");
+    }
+    if (storage == Storage::SPARSE) {
+        // change the weights and remove the edges that became NO_EDGE
+        syncIndex();
+        size_t write = 0;
+        size_t rowStart = 0;
+        for (size_t u = 0; u < getNumVertices(); u++) {
+            for (size_t e = rowStart; e < csr.offsets[u + 1]; e++) {
+                int res = func(csr.weights[e]);
+                if (res != 0) {
+                    csr.targets[write] = csr.targets[e];
+                    csr.weights[write] = res;
+                    write++;
+                }
+            }
+            rowStart = csr.offsets[u + 1];
+            csr.offsets[u + 1] = write;
+        }
+        csr.targets.resize(write);
+        csr.weights.resize(write);
+
+        updateFromIndex();
+        return;
+    }
+
+    mapMatrix(adjMat, &adjMat, func, &csr);
+    updateFromIndex();
+}
+
+template <typename Func>
+Graph Graph::transformed(Func func) const {
+    if (storage != Storage::DENSE) {
+        // the sparse storage is changed in O(E) on a copy (and a bitset graph throws)
+        Graph g = *this;
+        g.modifyEdgeWeights(func);
+        return g;
+    }
+
+    Graph g;
+    g.numVertices = numVertices;
+    g.adjMat = Matrix(numVertices);
+    mapMatrix(adjMat, &g.adjMat, func, &g.csr);
+    g.updateFromIndex();
+    return g;
+}
+
 }  // namespace shayg
\ No newline at end of file
@@ -0,0 +1,585 @@
+/**
+ * @author Shay Gali
+ * @link shay.gali@msmail.ariel.ac.il
+ */
+#include "GraphFile.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "Graph.hpp"
+
+using namespace shayg;
+
+using std::invalid_argument;
+
+static_assert(sizeof(size_t) == sizeof(uint64_t), "the CSR arrays are saved as uint64");
+static_assert(sizeof(int) == sizeof(int32_t), "the cells of the matrix are saved as int32");
+
+MappedFile::MappedFile(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw invalid_argument("Can't open the graph file " + path + ": " + std::strerror(errno));
+    }
+
+    struct stat info {};
+    if (::fstat(fd, &info) != 0) {
+        int error = errno;
+        ::close(fd);
+        throw invalid_argument("Can't read the graph file " + path + ": " + std::strerror(error));
+    }
+
+    length = (size_t)info.st_size;
+    if (length != 0) {  // an empty file can't be mapped (and is not a graph file - loadFile will say it is truncated)
+        void* address = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address == MAP_FAILED) {
+            int error = errno;
+            ::close(fd);
+            throw invalid_argument("Can't map the graph file " + path + ": " + std::strerror(error));
+        }
+        bytes = static_cast<const unsigned char*>(address);
+    }
+    ::close(fd);  // the mapping keeps the file open
+}
+
+MappedFile::~MappedFile() {
+    if (bytes != nullptr) {
+        ::munmap(const_cast<unsigned char*>(bytes), length);  // NOLINT(cppcoreguidelines-pro-type-const-cast)
+    }
+}
+
+void MappedFile::adviseSequential() const {
+    if (bytes != nullptr) {
+        ::madvise(const_cast<unsigned char*>(bytes), length, MADV_SEQUENTIAL);  // NOLINT(cppcoreguidelines-pro-type-const-cast)
+    }
+}
+
+namespace {
+
+constexpr size_t MIN_CHUNK = size_t{1} << 20U;  // every thread parses at least 1MB of text (a smaller file is parsed by one thread)
+
+/**
+ * @brief read the numbers in one line of a text file (separated by spaces or tabs)
+ */
+class LineParser {
+   private:
+    const char* position;
+    const char* end;
+
+    static bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+   public:
+    LineParser(const char* begin, const char* end) : position(begin), end(end) {}
+
+    /**
+     * @brief true if there is nothing but blanks until the end of the line
+     */
+    bool atEnd() {
+        while (position != end && isBlank(*position)) {
+            position++;
+        }
+        return position == end;
+    }
+
+    /**
+     * @brief the next character (after the blanks)
+     */
+    char peek() { return atEnd() ? '\n' : *position; }
+
+    /**
+     * @brief the next number - std::from_chars, without a locale or a stream
+     * @throw invalid_argument if the next word is not a number of type T
+     */
+    template <typename T>
+    T number(const char* what) {
+        atEnd();
+        T value{};
+        auto [next, error] = std::from_chars(position, end, value);
+        if (error != std::errc() || (next != end && !isBlank(*next))) {
+            throw invalid_argument(std::string("expected ") + what + ".");
+        }
+        position = next;
+        return value;
+    }
+
+    /**
+     * @brief the next word, as it is in the text
+     */
+    std::string_view word() {
+        atEnd();
+        const char* start = position;
+        while (position != end && !isBlank(*position)) {
+            position++;
+        }
+        return {start, (size_t)(position - start)};
+    }
+};
+
+/**
+ * @brief parse the lines of text[begin, end) with all the cores. the text is split into one part for every thread at line ends,
+ * and every thread calls parseLine(line, lineEnd, &edges) on the lines of its part - into its own list of edges, so the threads share nothing.
+ * parseLine returns true if the line had an entry (and not a comment or an empty line).
+ * @param text the start of the file (for the line numbers in the errors)
+ * @param entries the number of the lines with an entry
+ * @return the edges of every part, in the order of the file
+ * @throw invalid_argument the first error in the file, with its line number
+ */
+template <typename ParseLine>
+vector<vector<Edge>> parseLines(const char* text, const char* begin, const char* end, size_t* entries, ParseLine parseLine) {
+    size_t length = (size_t)(end - begin);
+    size_t numThreads = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), length / MIN_CHUNK));
+
+    vector<const char*> bounds(numThreads + 1, end);
+    bounds[0] = begin;
+    for (size_t t = 1; t < numThreads; t++) {
+        const char* cut = std::find(std::max(bounds[t - 1], begin + length / numThreads * t), end, '\n');
+        bounds[t] = cut == end ? end : cut + 1;
+    }
+
+    vector<vector<Edge>> chunks(numThreads);
+    vector<size_t> counts(numThreads, 0);
+    vector<std::exception_ptr> errors(numThreads);
+    auto worker = [&](size_t t) {
+        const char* line = bounds[t];
+        try {
+            while (line != bounds[t + 1]) {
+                const char* lineEnd = std::find(line, bounds[t + 1], '\n');
+                counts[t] += (size_t)parseLine(line, lineEnd, &chunks[t]);
+                line = lineEnd == bounds[t + 1] ? lineEnd : lineEnd + 1;
+            }
+        } catch (const invalid_argument& error) {
+            std::string lineNumber = std::to_string(std::count(text, line, '\n') + 1);
+            errors[t] = std::make_exception_ptr(invalid_argument("Invalid graph file: line " + lineNumber + ": " + error.what()));
+        }
+    };
+
+    vector<std::thread> threads;
+    threads.reserve(numThreads - 1);
+    for (size_t t = 1; t < numThreads; t++) {
+        threads.emplace_back(worker, t);
+    }
+    worker(0);  // the current thread parses the first part
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    for (const std::exception_ptr& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+    *entries = 0;
+    for (size_t count : counts) {
+        *entries += count;
+    }
+    return chunks;
+}
+
+/**
+ * @brief the list of the parts (for Graph::loadEdgeChunks)
+ */
+vector<const vector<Edge>*> chunkList(const vector<vector<Edge>>& chunks) {
+    vector<const vector<Edge>*> list;
+    for (const vector<Edge>& chunk : chunks) {
+        list.push_back(&chunk);
+    }
+    return list;
+}
+
+invalid_argument diagonalError(size_t u) {
+    return invalid_argument("The diagonal of the matrix must be NO_EDGE. (the " + std::to_string(u) + "th node is not a NO_EDGE)");
+}
+
+/**
+ * @brief the next line of the text (without the '\n'), and move begin to the line after it
+ */
+std::string_view nextLine(const char** begin, const char* end) {
+    const char* start = *begin;
+    const char* lineEnd = std::find(start, end, '\n');
+    *begin = lineEnd == end ? end : lineEnd + 1;
+    return {start, (size_t)(lineEnd - start)};
+}
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    return a.size() == b.size() &&
+           std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) { return std::tolower((unsigned char)x) == std::tolower((unsigned char)y); });
+}
+
+/**
+ * @brief write the sections of a graph file - every section is padded with zeros to a multiple of GRAPH_FILE_ALIGN bytes
+ */
+class SectionWriter {
+   private:
+    std::ofstream& out;
+    size_t written = 0;
+
+   public:
+    explicit SectionWriter(std::ofstream& out) : out(out) {}
+
+    void write(const void* data, size_t bytes) {
+        out.write(static_cast<const char*>(data), (std::streamsize)bytes);
+        written += bytes;
+    }
+
+    void endSection() {
+        static constexpr char zeros[GRAPH_FILE_ALIGN] = {};
+        if (written % GRAPH_FILE_ALIGN != 0) {
+            write(zeros, GRAPH_FILE_ALIGN - written % GRAPH_FILE_ALIGN);
+        }
+    }
+
+    template <typename T>
+    void section(const T* data, size_t count) {
+        write(data, count * sizeof(T));
+        endSection();
+    }
+};
+
+/**
+ * @brief read the sections of a mapped graph file in place - a section is a pointer into the mapping
+ */
+class SectionReader {
+   private:
+    const MappedFile& file;
+    size_t position = 0;
+
+   public:
+    explicit SectionReader(const MappedFile& file) : file(file) {}
+
+    /**
+     * @brief the next section, with rows * columns elements of T
+     * @throw invalid_argument if the file is too short for the section
+     */
+    template <typename T>
+    const T* section(size_t rows, size_t columns = 1) {
+        size_t available = (file.size() - position) / sizeof(T);
+        if (columns != 0 && rows > available / columns) {
+            throw invalid_argument("Invalid graph file: the file is truncated.");
+        }
+        const T* start = reinterpret_cast<const T*>(file.data() + position);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        position += rows * columns * sizeof(T);
+        position = std::min((position + GRAPH_FILE_ALIGN - 1) / GRAPH_FILE_ALIGN * GRAPH_FILE_ALIGN, file.size());
+        return start;
+    }
+};
+
+void writeIndex(SectionWriter* writer, const CSR& index) {
+    writer->section(index.offsets.data(), index.offsets.size());
+    writer->section(index.targets.data(), index.targets.size());
+    writer->section(index.weights.data(), index.weights.size());
+}
+
+/**
+ * @brief copy an index of the edges from the file, and check that it is an index of a graph with n vertices
+ */
+void readIndex(SectionReader* reader, size_t n, size_t edgeCells, CSR* index) {
+    const size_t* offsets = reader->section<size_t>(n + 1);
+    const size_t* targets = reader->section<size_t>(edgeCells);
+    const int* weights = reader->section<int>(edgeCells);
+
+    if (offsets[0] != 0 || offsets[n] != edgeCells || !std::is_sorted(offsets, offsets + n + 1)) {
+        throw invalid_argument("Invalid graph file: the offsets of the edges are not valid.");
+    }
+    if (std::any_of(targets, targets + edgeCells, [n](size_t v) { return v >= n; })) {
+        throw invalid_argument("Invalid graph file: an edge has a vertex that is not in the graph.");
+    }
+    index->offsets.assign(offsets, offsets + n + 1);
+    index->targets.assign(targets, targets + edgeCells);
+    index->weights.assign(weights, weights + edgeCells);
+}
+
+/**
+ * @brief copy the words of a bit matrix from the file
+ */
+BitMatrix readBits(SectionReader* reader, size_t n) {
+    // the section is checked before the matrix is allocated, so a bad header throws instead of allocating a huge matrix
+    size_t rowWords = (n + BitMatrix::WORD_BITS - 1) / BitMatrix::WORD_BITS;
+    const uint64_t* words = reader->section<uint64_t>(n, rowWords);
+    BitMatrix mat(n);
+    std::copy(words, words + n * rowWords, mat.row(0));
+    return mat;
+}
+
+/**
+ * @brief check the bits of a graph file: no bit after column n - 1 (the padding of the rows, the loops on the words don't stop at n),
+ * no bit on the diagonal, and edgeCells bits in all
+ */
+void checkBits(const BitMatrix& mat, size_t edgeCells) {
+    size_t n = mat.size();
+    size_t used = n % BitMatrix::WORD_BITS;
+    uint64_t padding = used == 0 ? 0 : ~uint64_t{0} << used;
+    for (size_t u = 0; u < n; u++) {
+        if ((mat.row(u)[mat.wordsPerRow() - 1] & padding) != 0) {
+            throw invalid_argument("Invalid graph file: the row " + std::to_string(u) + " has a bit after the last vertex.");
+        }
+        if (mat.test(u, u)) {
+            throw diagonalError(u);
+        }
+    }
+    if (mat.count() != edgeCells) {
+        throw invalid_argument("Invalid graph file: the number of bits doesn't match the number of edges in the header.");
+    }
+}
+
+}  // namespace
+
+void Graph::saveFile(const std::string& path) const {
+    syncIndex();
+    size_t n = getNumVertices();
+
+    // the graph is written next to the path and renamed over it at the end, so the path is never truncated:
+    // a graph that was loaded from the path (or a copy of it) keeps reading the old file from its mapping
+    std::string tempPath = path + ".tmp";
+    std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw invalid_argument("Can't open the graph file " + path + " for writing.");
+    }
+
+    GraphFileHeader header{};
+    std::copy(std::begin(GRAPH_FILE_MAGIC), std::end(GRAPH_FILE_MAGIC), header.magic);
+    header.version = GRAPH_FILE_VERSION;
+    header.byteOrder = GRAPH_FILE_BYTE_ORDER;
+    header.storage = (uint32_t)storage;
+    header.flags = (isDirected ? GRAPH_FILE_DIRECTED : 0U) | (isWeighted ? GRAPH_FILE_WEIGHTED : 0U) | (haveNegativeEdgeWeight ? GRAPH_FILE_NEGATIVE : 0U);
+    header.numVertices = n;
+    header.numEdges = numEdges;
+    header.edgeCells = edgeCells;
+    header.asymmetricPairs = asymmetricPairs;
+    header.nonUnitWeights = nonUnitWeights;
+    header.negativeWeights = negativeWeights;
+
+    SectionWriter writer(out);
+    writer.section(&header, 1);
+
+    if (storage == Storage::BITSET) {
+        writer.section(bits.row(0), n * bits.wordsPerRow());
+        if (isDirected) {
+            writer.section(inBits.row(0), n * inBits.wordsPerRow());
+        }
+    } else {
+        if (storage == Storage::DENSE) {
+            for (size_t u = 0; u < n; u++) {  // without the padding of the rows
+                writer.write(adjMat[u].data(), n * sizeof(int));
+            }
+            writer.endSection();
+        }
+        writeIndex(&writer, csr);
+        if (isDirected) {
+            writeIndex(&writer, inCsr);
+        }
+    }
+
+    out.close();
+    if (!out || std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        std::remove(tempPath.c_str());
+        throw invalid_argument("Can't write the graph file " + path + ".");
+    }
+}
+
+void Graph::loadFile(const std::string& path) {
+    auto file = std::make_shared<const MappedFile>(path);
+    SectionReader reader(*file);
+
+    const GraphFileHeader& header = *reader.section<GraphFileHeader>(1);
+    if (!std::equal(std::begin(GRAPH_FILE_MAGIC), std::end(GRAPH_FILE_MAGIC), header.magic)) {
+        throw invalid_argument("Invalid graph file: " + path + " is not a graph file.");
+    }
+    if (header.byteOrder != GRAPH_FILE_BYTE_ORDER) {
+        throw invalid_argument("Invalid graph file: the file was saved on a machine with another byte order.");
+    }
+    if (header.version != GRAPH_FILE_VERSION) {
+        throw invalid_argument("Invalid graph file: version " + std::to_string(header.version) + " is not supported (the supported version is " +
+                               std::to_string(GRAPH_FILE_VERSION) + ").");
+    }
+    if (header.storage > (uint32_t)Storage::BITSET) {
+        throw invalid_argument("Invalid graph file: unknown storage " + std::to_string(header.storage) + ".");
+    }
+
+    auto newStorage = (Storage)header.storage;
+    size_t n = header.numVertices;
+    size_t cells = header.edgeCells;
+    bool directed = header.asymmetricPairs != 0;
+    if (header.numEdges != (directed ? cells : cells / 2) || header.nonUnitWeights > cells || header.negativeWeights > cells ||
+        (newStorage == Storage::BITSET && (header.nonUnitWeights != 0 || header.negativeWeights != 0))) {
+        throw invalid_argument("Invalid graph file: the counters in the header don't match.");
+    }
+    // every storage has at least one byte for every vertex (the offsets alone are 8 bytes for every vertex), so a bigger |V| is a
+    // corrupt header. it also keeps n + 1 from wrapping around in the size of the offsets section
+    if (n >= file->size()) {
+        throw invalid_argument("Invalid graph file: the file is too short for " + std::to_string(n) + " vertices.");
+    }
+
+    Matrix newMat;
+    BitMatrix newBits;
+    BitMatrix newInBits;
+    CSR newCsr;
+    CSR newInCsr;
+    if (newStorage == Storage::BITSET) {
+        newBits = readBits(&reader, n);
+        checkBits(newBits, cells);
+        // the in bits of a directed graph are the transposed matrix, and the matrix of an undirected graph is symmetric
+        BitMatrix transposed = newBits.transposed();
+        if (directed) {
+            newInBits = readBits(&reader, n);
+        }
+        if (!(directed ? newInBits == transposed : newBits == transposed)) {
+            throw invalid_argument("Invalid graph file: the in edges don't match the out edges.");
+        }
+    } else {
+        if (newStorage == Storage::DENSE) {
+            const int* mapped = reader.section<int>(n, n);
+            for (size_t u = 0; u < n; u++) {
+                if (mapped[u * n + u] != NO_EDGE) {
+                    throw invalid_argument("The diagonal of the matrix must be NO_EDGE. (the " + std::to_string(u) + "th node is not a NO_EDGE)");
+                }
+            }
+            newMat = Matrix::view(mapped, n);  // the cells stay in the file
+        }
+        readIndex(&reader, n, cells, &newCsr);
+        if (directed) {
+            readIndex(&reader, n, cells, &newInCsr);
+        }
+    }
+
+    this->storage = newStorage;
+    this->numVertices = n;
+    this->adjMat = std::move(newMat);
+    this->mapping = newStorage == Storage::DENSE ? std::move(file) : nullptr;  // the other storages were copied, the file can be unmapped
+    this->bits = std::move(newBits);
+    this->inBits = std::move(newInBits);
+    this->csr = std::move(newCsr);
+    this->inCsr = std::move(newInCsr);
+    this->pending.clear();
+
+    this->edgeCells = cells;
+    this->asymmetricPairs = header.asymmetricPairs;
+    this->nonUnitWeights = header.nonUnitWeights;
+    this->negativeWeights = header.negativeWeights;
+    updateFlags();
+}
+
+void Graph::loadEdgeList(const std::string& path, Storage storage) {
+    MappedFile file(path);
+    file.adviseSequential();
+    const char* text = reinterpret_cast<const char*>(file.data());  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+
+    size_t entries = 0;
+    vector<vector<Edge>> chunks = parseLines(text, text, text + file.size(), &entries, [](const char* line, const char* lineEnd, vector<Edge>* edges) {
+        LineParser parser(line, lineEnd);
+        if (parser.atEnd() || parser.peek() == '#' || parser.peek() == '%') {
+            return false;
+        }
+        Edge e{};
+        e.from = parser.number<size_t>("a vertex");
+        e.to = parser.number<size_t>("a vertex");
+        e.weight = parser.atEnd() ? 1 : parser.number<int>("a weight");
+        if (!parser.atEnd()) {
+            throw invalid_argument("expected the end of the line after the weight.");
+        }
+        if (e.from == e.to && e.weight != NO_EDGE) {
+            throw diagonalError(e.from);
+        }
+        edges->push_back(e);
+        return true;
+    });
+
+    size_t n = 0;  // the largest vertex + 1
+    for (const vector<Edge>& chunk : chunks) {
+        for (const Edge& e : chunk) {
+            n = std::max({n, e.from + 1, e.to + 1});
+        }
+    }
+    loadEdgeChunks(n, chunkList(chunks), storage);
+}
+
+void Graph::loadMatrixMarket(const std::string& path, Storage storage) {
+    MappedFile file(path);
+    file.adviseSequential();
+    const char* text = reinterpret_cast<const char*>(file.data());  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    const char* end = text + file.size();
+    const char* body = text;
+
+    // the banner: %%MatrixMarket matrix coordinate <field> <symmetry>
+    std::string_view banner = nextLine(&body, end);
+    LineParser header(banner.data(), banner.data() + banner.size());
+    if (!equalsIgnoreCase(header.word(), "%%MatrixMarket") || !equalsIgnoreCase(header.word(), "matrix") ||
+        !equalsIgnoreCase(header.word(), "coordinate")) {
+        throw invalid_argument("Invalid graph file: " + path + " is not a Matrix Market coordinate file.");
+    }
+    std::string_view field = header.word();
+    std::string_view symmetry = header.word();
+    bool pattern = equalsIgnoreCase(field, "pattern");
+    if (!pattern && !equalsIgnoreCase(field, "integer")) {
+        throw invalid_argument("Invalid graph file: the entries of the matrix must be integer or pattern (not " + std::string(field) + ").");
+    }
+    bool symmetric = equalsIgnoreCase(symmetry, "symmetric");
+    bool skew = equalsIgnoreCase(symmetry, "skew-symmetric");
+    if (!symmetric && !skew && !equalsIgnoreCase(symmetry, "general")) {
+        throw invalid_argument("Invalid graph file: unknown symmetry " + std::string(symmetry) + ".");
+    }
+
+    // the comments, then the size line: <rows> <columns> <entries>
+    std::string_view sizeLine;
+    do {
+        if (body == end) {
+            throw invalid_argument("Invalid graph file: the size of the matrix is missing.");
+        }
+        sizeLine = nextLine(&body, end);
+    } while (LineParser(sizeLine.data(), sizeLine.data() + sizeLine.size()).atEnd() || sizeLine.front() == '%');
+    LineParser sizes(sizeLine.data(), sizeLine.data() + sizeLine.size());
+    size_t n = sizes.number<size_t>("the number of rows");
+    size_t columns = sizes.number<size_t>("the number of columns");
+    size_t declared = sizes.number<size_t>("the number of entries");
+    if (n != columns) {
+        throw invalid_argument("Invalid graph file: the matrix is not square (" + std::to_string(n) + " x " + std::to_string(columns) + ").");
+    }
+
+    size_t entries = 0;
+    vector<vector<Edge>> chunks = parseLines(text, body, end, &entries, [&](const char* line, const char* lineEnd, vector<Edge>* edges) {
+        LineParser parser(line, lineEnd);
+        if (parser.atEnd() || parser.peek() == '%') {
+            return false;
+        }
+        size_t i = parser.number<size_t>("a row");
+        size_t j = parser.number<size_t>("a column");
+        int weight = pattern ? 1 : parser.number<int>("a weight");
+        if (!parser.atEnd()) {
+            throw invalid_argument("expected the end of the line.");
+        }
+        if (i == 0 || j == 0 || i > n || j > n) {
+            throw invalid_argument("the entry (" + std::to_string(i) + ", " + std::to_string(j) + ") is not in a " + std::to_string(n) + " x " +
+                                   std::to_string(n) + " matrix.");
+        }
+        if (i == j && weight != NO_EDGE) {
+            throw diagonalError(i - 1);
+        }
+        edges->push_back({i - 1, j - 1, weight});
+        if ((symmetric || skew) && i != j) {
+            edges->push_back({j - 1, i - 1, skew ? -weight : weight});
+        }
+        return true;
+    });
+
+    if (entries != declared) {
+        throw invalid_argument("Invalid graph file: the file has " + std::to_string(entries) + " entries, and the header says " + std::to_string(declared) +
+                               ".");
+    }
+    loadEdgeChunks(n, chunkList(chunks), storage);
+}
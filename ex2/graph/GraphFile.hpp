@@ -0,0 +1,79 @@
+/**
+ * @author Shay Gali
+ * @link shay.gali@msmail.ariel.ac.il
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace shayg {
+
+/**
+ * @brief the binary graph file (Graph::saveFile and Graph::loadFile).
+ *
+ * the file is a GraphFileHeader and then sections, every section starts on a multiple of GRAPH_FILE_ALIGN bytes
+ * (so the arrays can be read in place from a mapped file):
+ * - Storage::DENSE: the |V| x |V| cells of the matrix (int32, row after row), then the out edges index
+ * - Storage::SPARSE: the out edges index
+ * - Storage::BITSET: the |V| x wordsPerRow words of the bits (uint64), and the words of the transposed bits if the graph is directed
+ * the out edges index is three sections: offsets (|V| + 1 uint64), targets (edgeCells uint64) and weights (edgeCells int32),
+ * and if the graph is directed (and not Storage::BITSET) the same three sections of the in edges index follow.
+ * the numbers are in the byte order of the machine that wrote the file (byteOrder tells which one).
+ */
+struct GraphFileHeader {
+    char magic[8];             // GRAPH_FILE_MAGIC
+    uint32_t version;          // GRAPH_FILE_VERSION - a new version is needed for every change in the layout
+    uint32_t byteOrder;        // GRAPH_FILE_BYTE_ORDER as written by the machine that saved the file
+    uint32_t storage;          // the Storage of the graph (0 DENSE, 1 SPARSE, 2 BITSET) - the payload of the file
+    uint32_t flags;            // GRAPH_FILE_DIRECTED | GRAPH_FILE_WEIGHTED | GRAPH_FILE_NEGATIVE
+    uint64_t numVertices;      // |V|
+    uint64_t numEdges;         // |E|
+    uint64_t edgeCells;        // the number of cells that are not NO_EDGE (the size of the out edges index)
+    uint64_t asymmetricPairs;  // the counters of the graph, so loading a graph doesn't scan it
+    uint64_t nonUnitWeights;
+    uint64_t negativeWeights;
+};
+
+constexpr char GRAPH_FILE_MAGIC[8] = {'S', 'H', 'A', 'Y', 'G', 'R', 'P', 'H'};
+constexpr uint32_t GRAPH_FILE_VERSION = 1;
+constexpr uint32_t GRAPH_FILE_BYTE_ORDER = 0x01020304;
+constexpr size_t GRAPH_FILE_ALIGN = 64;
+
+constexpr uint32_t GRAPH_FILE_DIRECTED = 1U << 0U;
+constexpr uint32_t GRAPH_FILE_WEIGHTED = 1U << 1U;
+constexpr uint32_t GRAPH_FILE_NEGATIVE = 1U << 2U;
+
+/**
+ * @brief a file that is mapped to memory read-only (mmap). the pages are read from the disk (or the page cache) when they are used,
+ * so opening a big file takes the same time as opening a small one. the file is unmapped when the object is destroyed.
+ */
+class MappedFile {
+   private:
+    const unsigned char* bytes = nullptr;
+    size_t length = 0;
+
+   public:
+    /**
+     * @brief map the whole file
+     * @throw invalid_argument if the file can't be opened or mapped
+     */
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&&) = delete;
+    MappedFile& operator=(MappedFile&&) = delete;
+
+    const unsigned char* data() const { return bytes; }
+    size_t size() const { return length; }
+
+    /**
+     * @brief tell the system that the file will be read from the start to the end (so it reads ahead more pages)
+     */
+    void adviseSequential() const;
+};
+
+}  // namespace shayg
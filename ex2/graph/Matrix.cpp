@@ -0,0 +1,314 @@
+/**
+ * @author Shay Gali
+ * @link shay.gali@msmail.ariel.ac.il
+ */
+#include "Matrix.hpp"
+#include "BitMatrix.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SHAYG_X86 1
+#endif
+
+namespace shayg {
+
+namespace {
+
+/*
+the product is computed in blocks, so the part of `b` that is used over and over stays in the cache:
+a block of BLOCK_K rows of b and BLOCK_J columns is 128 * 512 * 4 bytes = 256KB (the size of L2 cache).
+for every row i of a, row i of the result gets a[i][k] * (row k of b) for every k in the block (the i-k-j order),
+so all the memory accesses are on rows, and the inner loop is a simple `dst += scale * src` on a row - easy to vectorize.
+*/
+constexpr size_t BLOCK_K = 128;
+constexpr size_t BLOCK_J = 512;  // a multiple of Matrix::ROW_ALIGN, so every block starts on a cache line
+
+// every thread takes ROWS_PER_TASK rows at a time (rows of sparse graphs take less time, so the work is not split in advance)
+constexpr size_t ROWS_PER_TASK = 16;
+// below this size the threads cost more than the product itself
+constexpr size_t MIN_PARALLEL_SIZE = 256;
+// Floyd-Warshall works on FW_BLOCK rows at a time (64 rows of 8192 vertices are 2MB)
+constexpr size_t FW_BLOCK = 64;
+
+// dst[j] += scale * src[j] for j in [0, count)
+using RowKernel = void (*)(int* dst, const int* src, int scale, size_t count);
+
+/*
+the scalar kernel does the math on unsigned int, so an overflow wraps around (like the AVX2 kernel) and is not undefined behavior.
+the compiler vectorizes this loop with the default instruction set (SSE2 on x86).
+*/
+void addScaledRowScalar(int* dst, const int* src, int scale, size_t count) {
+    auto uscale = (unsigned int)scale;
+    for (size_t j = 0; j < count; j++) {
+        dst[j] = (int)((unsigned int)dst[j] + uscale * (unsigned int)src[j]);
+    }
+}
+
+#ifdef SHAYG_X86
+/*
+the AVX2 kernel - 8 ints in every instruction. only this function is compiled for AVX2,
+so the program still runs on CPUs without AVX2 (see selectKernel).
+*/
+__attribute__((target("avx2"))) void addScaledRowAvx2(int* dst, const int* src, int scale, size_t count) {
+    __m256i scales = _mm256_set1_epi32(scale);
+    size_t j = 0;
+    for (; j + 8 <= count; j += 8) {
+        auto* out = reinterpret_cast<__m256i*>(dst + j);
+        __m256i row = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + j));
+        __m256i sums = _mm256_loadu_si256(out);
+        _mm256_storeu_si256(out, _mm256_add_epi32(sums, _mm256_mullo_epi32(row, scales)));
+    }
+    addScaledRowScalar(dst + j, src + j, scale, count - j);
+}
+#endif
+
+// dist[j] = min(dist[j], viaDist + via[j]) for j in [0, count), and next[j] = viaNext where dist[j] changed (if next is not null).
+// the NO_PATH cells of via are skipped
+using RelaxKernel = void (*)(int* dist, int* next, const int* via, int viaDist, int viaNext, size_t count);
+
+void relaxRowScalar(int* dist, int* next, const int* via, int viaDist, int viaNext, size_t count) {
+    for (size_t j = 0; j < count; j++) {
+        if (via[j] == Matrix::NO_PATH) {
+            continue;
+        }
+        int candidate = viaDist + via[j];
+        if (candidate < dist[j]) {
+            dist[j] = candidate;
+            if (next != nullptr) {
+                next[j] = viaNext;
+            }
+        }
+    }
+}
+
+#ifdef SHAYG_X86
+// the AVX2 version - the compare gives a mask of the cells that were improved, and the mask selects the new distance (and next vertex)
+__attribute__((target("avx2"))) void relaxRowAvx2(int* dist, int* next, const int* via, int viaDist, int viaNext, size_t count) {
+    __m256i noPath = _mm256_set1_epi32(Matrix::NO_PATH);
+    __m256i viaDists = _mm256_set1_epi32(viaDist);
+    __m256i viaNexts = _mm256_set1_epi32(viaNext);
+    size_t j = 0;
+    for (; j + 8 <= count; j += 8) {
+        auto* out = reinterpret_cast<__m256i*>(dist + j);
+        __m256i row = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(via + j));
+        __m256i current = _mm256_loadu_si256(out);
+        __m256i candidate = _mm256_add_epi32(row, viaDists);
+        __m256i better = _mm256_andnot_si256(_mm256_cmpeq_epi32(row, noPath), _mm256_cmpgt_epi32(current, candidate));
+        _mm256_storeu_si256(out, _mm256_blendv_epi8(current, candidate, better));
+        if (next != nullptr) {
+            auto* nextOut = reinterpret_cast<__m256i*>(next + j);
+            _mm256_storeu_si256(nextOut, _mm256_blendv_epi8(_mm256_loadu_si256(nextOut), viaNexts, better));
+        }
+    }
+    relaxRowScalar(dist + j, next == nullptr ? nullptr : next + j, via + j, viaDist, viaNext, count - j);
+}
+#endif
+
+/**
+ * @brief check (once) if the CPU we run on supports AVX2
+ */
+bool haveAvx2() {
+#ifdef SHAYG_X86
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    return avx2;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief choose the kernels for the CPU we run on
+ */
+RowKernel selectKernel() {
+#ifdef SHAYG_X86
+    if (haveAvx2()) {
+        return addScaledRowAvx2;
+    }
+#endif
+    return addScaledRowScalar;
+}
+
+RelaxKernel selectRelaxKernel() {
+#ifdef SHAYG_X86
+    if (haveAvx2()) {
+        return relaxRowAvx2;
+    }
+#endif
+    return relaxRowScalar;
+}
+
+/**
+ * @brief call func(begin, end) on blocks of rows that cover [0, n). for big n the blocks are split between all the cores.
+ * every thread takes ROWS_PER_TASK rows at a time, so func must only write to the rows it gets.
+ */
+template <typename Func>
+void forEachRowBlock(size_t n, Func func) {
+    size_t numThreads = std::min<size_t>(std::thread::hardware_concurrency(), (n + ROWS_PER_TASK - 1) / ROWS_PER_TASK);
+    if (n < MIN_PARALLEL_SIZE || numThreads <= 1) {
+        func(0, n);
+        return;
+    }
+
+    // the only shared state is the next row to take
+    std::atomic<size_t> nextRow{0};
+    auto worker = [&]() {
+        for (size_t begin = nextRow.fetch_add(ROWS_PER_TASK); begin < n; begin = nextRow.fetch_add(ROWS_PER_TASK)) {
+            func(begin, std::min(begin + ROWS_PER_TASK, n));
+        }
+    };
+
+    vector<std::thread> threads;
+    threads.reserve(numThreads - 1);
+    for (size_t t = 0; t + 1 < numThreads; t++) {
+        threads.emplace_back(worker);
+    }
+    worker();  // the current thread works too
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+/**
+ * @brief the loops of a blocked product on the rows [begin, end) of a: call op(i, k, a[i][k], jj, count) on every block of
+ * `count` columns starting at column jj of row k of b, for every cell a[i][k] that is not `skip` (a cell that adds nothing to the row)
+ */
+template <typename RowOp>
+void blockedProductRows(const Matrix& a, size_t width, size_t begin, size_t end, int skip, RowOp op) {
+    size_t n = a.size();
+    for (size_t jj = 0; jj < width; jj += BLOCK_J) {
+        size_t count = std::min(BLOCK_J, width - jj);
+        for (size_t kk = 0; kk < n; kk += BLOCK_K) {
+            size_t kEnd = std::min(kk + BLOCK_K, n);
+            for (size_t i = begin; i < end; i++) {
+                const int* row = a[i].data();
+                for (size_t k = kk; k < kEnd; k++) {
+                    if (row[k] != skip) {
+                        op(i, k, row[k], jj, count);
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief check the arguments of a product, and set the size of the result (all the cells are set to value)
+ */
+void prepareProduct(const Matrix& a, const Matrix& b, Matrix* result, int value) {
+    size_t n = a.size();
+    if (b.size() != n) {
+        throw std::invalid_argument("The two matrices have different sizes.");
+    }
+    if (result == &a || result == &b) {
+        throw std::invalid_argument("The result of the product can't be one of the operands.");
+    }
+    if (result->size() != n) {
+        *result = Matrix(n, value);
+    } else {
+        std::fill(result->data(), result->data() + n * result->stride(), value);
+    }
+}
+
+}  // namespace
+
+void multiply(const Matrix& a, const Matrix& b, Matrix* result) {
+    prepareProduct(a, b, result, 0);
+
+    // the padding of the rows of b is 0, so the kernel can run on full blocks up to the stride (and the padding of the result stays 0)
+    RowKernel kernel = selectKernel();
+    forEachRowBlock(a.size(), [&](size_t begin, size_t end) {
+        blockedProductRows(a, b.stride(), begin, end, 0, [&](size_t i, size_t k, int value, size_t jj, size_t count) {
+            kernel((*result)[i].data() + jj, b[k].data() + jj, value, count);
+        });
+    });
+}
+
+void minPlus(const Matrix& a, const Matrix& b, Matrix* result) {
+    prepareProduct(a, b, result, Matrix::NO_PATH);
+
+    RelaxKernel relax = selectRelaxKernel();
+    forEachRowBlock(a.size(), [&](size_t begin, size_t end) {
+        blockedProductRows(a, b.size(), begin, end, Matrix::NO_PATH, [&](size_t i, size_t k, int value, size_t jj, size_t count) {
+            relax((*result)[i].data() + jj, nullptr, b[k].data() + jj, value, 0, count);
+        });
+    });
+}
+
+void floydWarshall(Matrix* dist, Matrix* next) {
+    size_t n = dist->size();
+    if (next->size() != n) {
+        throw std::invalid_argument("The two matrices have different sizes.");
+    }
+    dist->makeOwned();  // the threads write to the rows of the matrices
+    next->makeOwned();
+
+    /*
+    the vertices are taken as intermediate vertices in blocks of FW_BLOCK vertices K = [kk, kEnd):
+    1. the rows of K are relaxed with the vertices of K (in order) - this is Floyd-Warshall on the rows of K only,
+       since these rows only need the rows of K.
+    2. every other row i is relaxed with the (now final) rows of K, in order. the rows of K are read by all the rows, so they stay in the cache,
+       and row i is read from memory once for the whole block instead of once for every k.
+       the rows only read the rows of K, so they are split between the threads.
+    */
+    RelaxKernel relax = selectRelaxKernel();
+    auto relaxVia = [&](size_t i, size_t k) {
+        int viaDist = (*dist)[i][k];
+        if (viaDist != Matrix::NO_PATH) {
+            relax((*dist)[i].data(), (*next)[i].data(), (*dist)[k].data(), viaDist, (*next)[i][k], n);
+        }
+    };
+
+    for (size_t kk = 0; kk < n; kk += FW_BLOCK) {
+        size_t kEnd = std::min(kk + FW_BLOCK, n);
+        for (size_t k = kk; k < kEnd; k++) {
+            for (size_t i = kk; i < kEnd; i++) {
+                relaxVia(i, k);
+            }
+        }
+
+        forEachRowBlock(n, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                if (i >= kk && i < kEnd) {
+                    continue;
+                }
+                for (size_t k = kk; k < kEnd; k++) {
+                    relaxVia(i, k);
+                }
+            }
+        });
+    }
+}
+
+void multiply(const BitMatrix& a, const BitMatrix& b, BitMatrix* result) {
+    size_t n = a.size();
+    if (b.size() != n) {
+        throw std::invalid_argument("The two matrices have different sizes.");
+    }
+    if (result == &a || result == &b) {
+        throw std::invalid_argument("The result of the product can't be one of the operands.");
+    }
+    if (result->size() != n) {
+        *result = BitMatrix(n);
+    }
+
+    size_t words = a.wordsPerRow();
+    forEachRowBlock(n, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            uint64_t* out = result->row(i);
+            std::fill(out, out + words, 0);
+            forEachBit(a.row(i), words, [&](size_t k) {
+                const uint64_t* row = b.row(k);
+                for (size_t w = 0; w < words; w++) {
+                    out[w] |= row[w];
+                }
+            });
+        }
+    });
+}
+
+}  // namespace shayg
@@ -0,0 +1,88 @@
+/**
+ * @author Shay Gali
+ * @link shay.gali@msmail.ariel.ac.il
+ *
+ * Algorithms::aStar with the euclidean and the manhattan heuristics against Algorithms::shortestPath (Dijkstra that stops at dest)
+ * on a grid where the points are 10 apart and the weights are in [10, 14] (like roads - the weight is the length of the edge and a bit more),
+ * between random vertices. the lengths of the paths are compared.
+ *
+ * usage: ./AStarBenchmark [side of the grid] [queries]   (default 1000 x 1000, 20 queries)
+ */
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../algorithms/Algorithms.hpp"
+#include "../graph/Graph.hpp"
+#include "Benchmark.hpp"
+
+using namespace shayg;
+using std::string;
+using std::vector;
+
+// the length of a path in the format of shortestPath
+long pathLength(const Graph& g, const string& path) {
+    std::istringstream in(path);
+    long length = 0;
+    size_t u = 0;
+    size_t v = 0;
+    in >> u;
+    while (in.ignore(2) >> v) {
+        length += g.getEdgeWeight(u, v);
+        u = v;
+    }
+    return length;
+}
+
+int main(int argc, char** argv) {
+    size_t side = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000;
+    size_t queries = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 20;
+    bench::Random random;
+
+    vector<Algorithms::Point> points;
+    vector<Edge> edges;
+    for (size_t r = 0; r < side; r++) {
+        for (size_t c = 0; c < side; c++) {
+            size_t u = r * side + c;
+            points.push_back({10.0 * (double)c, 10.0 * (double)r});
+            for (size_t v : {c + 1 < side ? u + 1 : u, r + 1 < side ? u + side : u}) {
+                if (v != u) {
+                    int weight = (int)random.below(5) + 10;
+                    edges.push_back({u, v, weight});
+                    edges.push_back({v, u, weight});
+                }
+            }
+        }
+    }
+    Graph g;
+    g.loadEdges(side * side, edges);
+    Algorithms::Heuristic euclidean = Algorithms::euclideanHeuristic(points);
+    Algorithms::Heuristic manhattan = Algorithms::manhattanHeuristic(points);
+
+    double dijkstraMs = 0;
+    double euclideanMs = 0;
+    double manhattanMs = 0;
+    bool allSame = true;
+    for (size_t q = 0; q < queries; q++) {
+        size_t src = random.below(side * side);
+        size_t dest = random.below(side * side);
+        string dijkstraPath;
+        string euclideanPath;
+        string manhattanPath;
+        dijkstraMs += bench::bestOf(1, [&]() { dijkstraPath = Algorithms::shortestPath(g, src, dest); });
+        euclideanMs += bench::bestOf(1, [&]() { euclideanPath = Algorithms::aStar(g, src, dest, euclidean); });
+        manhattanMs += bench::bestOf(1, [&]() { manhattanPath = Algorithms::aStar(g, src, dest, manhattan); });
+        long length = pathLength(g, dijkstraPath);
+        allSame &= pathLength(g, euclideanPath) == length && pathLength(g, manhattanPath) == length;
+    }
+
+    std::cout << "grid " << side << " x " << side << ", average of " << queries << " queries" << std::endl;
+    std::cout << "dijkstra (ms)\teuclidean A* (ms)\tmanhattan A* (ms)" << std::endl;
+    std::cout << dijkstraMs / queries << "\t\t" << euclideanMs / queries << "\t\t\t" << manhattanMs / queries << std::endl;
+    if (!allSame) {
+        std::cerr << "the lengths of the paths are different" << std::endl;
+    }
+    return allSame ? 0 : 1;
+}
@@ -0,0 +1,137 @@
+/**
+ * @author Shay Gali
+ * @link shay.gali@msmail.ariel.ac.il
+ *
+ * The per-cell throughput of the element-wise operators (scalar *, /, unary -, binary +, ++ and --).
+ * 1. the kernel - the loop that computes the cells of the result: the old std::function call on every cell,
+ *    against the expression templates (the operation is a template parameter, so it is inlined and the loop is vectorized).
+ * 2. the whole operator on a Graph (the kernel, the index of the edges and the update of the fields).
+ * the results of the two kernels are compared.
+ *
+ * usage: ./ArithmeticBenchmark [max |V|]   (default 4096)
+ */
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../graph/Graph.hpp"
+#include "Benchmark.hpp"
+
+using namespace shayg;
+using std::function;
+using std::string;
+using std::vector;
+
+// the old kernel of the unary operators - a std::function call on every cell
+void mapOld(const Matrix& src, Matrix* dst, const function<int(int)>& func) {
+    for (size_t u = 0; u < src.size(); u++) {
+        const int* row = src[u].data();
+        int* out = (*dst)[u].data();
+        for (size_t v = 0; v < src.size(); v++) {
+            out[v] = row[v] == NO_EDGE ? NO_EDGE : func(row[v]);
+        }
+    }
+}
+
+// the old kernel of the binary operators
+void combineOld(const Matrix& a, const Matrix& b, Matrix* dst, const function<int(int, int)>& func) {
+    for (size_t u = 0; u < a.size(); u++) {
+        const int* rowA = a[u].data();
+        const int* rowB = b[u].data();
+        int* out = (*dst)[u].data();
+        for (size_t v = 0; v < a.size(); v++) {
+            out[v] = rowA[v] == NO_EDGE && rowB[v] == NO_EDGE ? NO_EDGE : func(rowA[v], rowB[v]);
+        }
+    }
+}
+
+// the kernel of Graph::evaluate - the cells of the expression, row by row
+template <typename E>
+void evaluateCells(const E& expr, Matrix* dst) {
+    for (size_t u = 0; u < expr.size(); u++) {
+        int* out = (*dst)[u].data();
+        for (size_t v = 0; v < expr.size(); v++) {
+            out[v] = expr.at(u, v);
+        }
+    }
+}
+
+// random directed graph with half of the cells set, weights in [-9, 9]
+vector<vector<int>> randomGraph(size_t n, bench::Random* random) {
+    vector<vector<int>> graph(n, vector<int>(n, NO_EDGE));
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < n; j++) {
+            if (i != j && random->below(2) == 0) {
+                graph[i][j] = (int)random->below(19) - 9;
+            }
+        }
+    }
+    return graph;
+}
+
+double nsPerCell(double ms, size_t n) {
+    return ms * 1e6 / ((double)n * (double)n);
+}
+
+void report(size_t n, const string& name, double oldMs, double newMs, double operatorMs, bool same) {
+    std::cout << n << "\t" << name << "\t" << nsPerCell(oldMs, n) << "\t\t" << nsPerCell(newMs, n) << "\t\t" << oldMs / newMs << "x\t"
+              << nsPerCell(operatorMs, n) << (same ? "" : "\tDIFFERENT RESULTS") << std::endl;
+}
+
+int main(int argc, char** argv) {
+    size_t maxVertices = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4096;
+    bench::Random random;
+    bool allSame = true;
+
+    std::cout << "|V|\toperator\tstd::function kernel\ttemplate kernel\tspeedup\twhole operator (ns/cell)" << std::endl;
+    for (size_t n = 512; n <= maxVertices; n *= 2) {
+        Graph g1;
+        Graph g2;
+        g1.loadGraph(randomGraph(n, &random));
+        g2.loadGraph(randomGraph(n, &random));
+        const Matrix& mat1 = g1.getGraph();
+        const Matrix& mat2 = g2.getGraph();
+
+        Matrix expected(n);
+        Matrix cells(n);
+        Graph result = g1;  // the result graph already has a matrix of the right size, like `g = ...` in a loop
+        int factor = 3;
+        int divisor = 2;
+
+        double oldMs = bench::bestOf(3, [&]() { mapOld(mat1, &expected, [factor](int w) { return w * factor; }); });
+        double newMs = bench::bestOf(3, [&]() { evaluateCells(g1 * factor, &cells); });
+        double operatorMs = bench::bestOf(3, [&]() { result = g1 * factor; });
+        allSame &= cells == expected && result.getGraph() == expected;
+        report(n, "* int", oldMs, newMs, operatorMs, cells == expected && result.getGraph() == expected);
+
+        oldMs = bench::bestOf(3, [&]() { mapOld(mat1, &expected, [divisor](int w) { return w / divisor; }); });
+        newMs = bench::bestOf(3, [&]() { evaluateCells(g1 / divisor, &cells); });
+        operatorMs = bench::bestOf(3, [&]() { result = g1 / divisor; });
+        allSame &= cells == expected && result.getGraph() == expected;
+        report(n, "/ int", oldMs, newMs, operatorMs, cells == expected && result.getGraph() == expected);
+
+        oldMs = bench::bestOf(3, [&]() { mapOld(mat1, &expected, [](int w) { return -w; }); });
+        newMs = bench::bestOf(3, [&]() { evaluateCells(-g1, &cells); });
+        operatorMs = bench::bestOf(3, [&]() { result = -g1; });
+        allSame &= cells == expected && result.getGraph() == expected;
+        report(n, "unary -", oldMs, newMs, operatorMs, cells == expected && result.getGraph() == expected);
+
+        oldMs = bench::bestOf(3, [&]() { combineOld(mat1, mat2, &expected, [](int a, int b) { return a + b; }); });
+        newMs = bench::bestOf(3, [&]() { evaluateCells(g1 + g2, &cells); });
+        operatorMs = bench::bestOf(3, [&]() { result = g1 + g2; });
+        allSame &= cells == expected && result.getGraph() == expected;
+        report(n, "binary +", oldMs, newMs, operatorMs, cells == expected && result.getGraph() == expected);
+
+        // ++ and -- change the matrix in place with modifyEdgeWeights (the same kernel as the unary operators) - one call of each,
+        // so the matrix is the same after every repeat
+        result = g1;
+        operatorMs = bench::bestOf(3, [&]() {
+            ++result;
+            --result;
+        });
+        std::cout << n << "\t++ --\t\t\t\t\t" << nsPerCell(operatorMs / 2, n) << std::endl;
+    }
+    return allSame ? 0 : 1;
+}
@@ -0,0 +1,137 @@
+/**
+ * @author Shay Gali
+ * @link shay.gali@msmail.ariel.ac.il
+ *
+ * Algorithms::shortestPath on a directed graph with a few negative edges against the old Bellman-Ford (rounds over all the edges until
+ * nothing changes), and against Dijkstra on the same graph without the negative edges. the first query runs SPFA (only the edges out of
+ * the vertices that changed) from a virtual vertex for the potentials of Johnson's reweighting, and the next queries are Dijkstra on the
+ * new weights. the distances are compared to the old Bellman-Ford.
+ *
+ * usage: ./BellmanFordBenchmark [|V|]   (default 200000, 1% of the edges are negative)
+ */
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../algorithms/Algorithms.hpp"
+#include "../graph/Graph.hpp"
+#include "Benchmark.hpp"
+
+using namespace shayg;
+using std::string;
+using std::vector;
+
+// the old bellmanFord of a directed graph: V - 1 rounds over all the edges (stops after a round that changed nothing)
+vector<long> oldBellmanFord(const Graph& g, size_t src) {
+    size_t n = g.getNumVertices();
+    vector<long> distances(n, INF);
+    distances[src] = 0;
+    for (size_t i = 0; i + 1 < n; i++) {
+        bool relaxed = false;
+        for (size_t u = 0; u < n; u++) {
+            if (distances[u] == INF) {
+                continue;
+            }
+            for (auto [v, weight] : g.neighbors(u)) {
+                if (distances[u] + weight < distances[v]) {
+                    distances[v] = distances[u] + weight;
+                    relaxed = true;
+                }
+            }
+        }
+        if (!relaxed) {
+            break;
+        }
+    }
+    return distances;
+}
+
+// the length of a path in the format of shortestPath
+long pathLength(const Graph& g, const string& path) {
+    std::istringstream in(path);
+    long length = 0;
+    size_t u = 0;
+    size_t v = 0;
+    in >> u;
+    while (in.ignore(2) >> v) {
+        length += g.getEdgeWeight(u, v);
+        u = v;
+    }
+    return length;
+}
+
+// a random graph with 4 out edges for every vertex, or a side x side grid (edges in both directions) where the paths are long.
+// positive weights are in [50, 100] and negative weights in [-9, -1] only from a vertex to a bigger one, so a negative cycle needs
+// more than 5 negative edges and a path of them back - with 1% negative edges there are none
+void makeGraphs(bool grid, size_t n, bench::Random* random, Graph* g, Graph* positive) {
+    vector<Edge> edges;
+    vector<Edge> positiveEdges;
+    auto add = [&](size_t u, size_t v) {
+        int weight = (int)random->below(51) + 50;
+        positiveEdges.push_back({u, v, weight});
+        edges.push_back({u, v, u < v && random->below(100) == 0 ? -(int)random->below(9) - 1 : weight});
+    };
+    if (grid) {
+        size_t side = 1;
+        while ((side + 1) * (side + 1) <= n) {
+            side++;
+        }
+        n = side * side;
+        for (size_t u = 0; u < n; u++) {
+            for (size_t v : {u % side + 1 < side ? u + 1 : u, u + side < n ? u + side : u, u % side > 0 ? u - 1 : u, u >= side ? u - side : u}) {
+                if (v != u) {
+                    add(u, v);
+                }
+            }
+        }
+    } else {
+        vector<bool> used(n, false);
+        vector<size_t> row;
+        for (size_t u = 0; u < n; u++) {
+            row.clear();
+            while (row.size() < 4) {
+                size_t v = random->below(n);
+                if (v != u && !used[v]) {
+                    used[v] = true;
+                    row.push_back(v);
+                }
+            }
+            for (size_t v : row) {
+                used[v] = false;
+                add(u, v);
+            }
+        }
+    }
+    g->loadEdges(n, edges);
+    positive->loadEdges(n, positiveEdges);
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+    bench::Random random;
+    bool allSame = true;
+
+    std::cout << "graph\told bellman-ford (ms)\tfirst query (ms)\tnext query (ms)\tdijkstra without the negative edges (ms)" << std::endl;
+    for (bool grid : {false, true}) {
+        Graph g;
+        Graph positive;
+        makeGraphs(grid, n, &random, &g, &positive);
+
+        // from the middle of the grid, so the paths go in all the directions
+        size_t src = grid ? g.getNumVertices() / 2 : 0;
+        size_t dest = g.getNumVertices() - 1;
+        vector<long> oldDistances;
+        string path;
+        double oldMs = bench::bestOf(1, [&]() { oldDistances = oldBellmanFord(g, src); });
+        double firstMs = bench::bestOf(1, [&]() { path = Algorithms::shortestPath(g, src, dest); });
+        double nextMs = bench::bestOf(3, [&]() { path = Algorithms::shortestPath(g, src, dest, Algorithms::SearchMode::FULL); });
+        double dijkstraMs = bench::bestOf(3, [&]() { bench::keep(Algorithms::shortestPath(positive, src, dest, Algorithms::SearchMode::FULL)); });
+        bool same = pathLength(g, path) == oldDistances[dest];
+        allSame &= same;
+        std::cout << (grid ? "grid" : "random") << "\t" << oldMs << "\t\t\t" << firstMs << "\t\t\t" << nextMs << "\t\t" << dijkstraMs
+                  << (same ? "" : "\tDIFFERENT DISTANCES") << std::endl;
+    }
+    return allSame ? 0 : 1;
+}
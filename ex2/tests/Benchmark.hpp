@@ -0,0 +1,64 @@
+/**
+ * @author Shay Gali
+ * @link shay.gali@msmail.ariel.ac.il
+ */
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+/**
+ * @brief small helpers for the benchmarks in this directory (timing and a fast random generator)
+ */
+namespace bench {
+
+/**
+ * @brief run func `repeats` times and return the best time in milliseconds
+ */
+template <typename Func>
+double bestOf(int repeats, Func func) {
+    double best = 0;
+    for (int i = 0; i < repeats; i++) {
+        auto start = std::chrono::steady_clock::now();
+        func();
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        if (i == 0 || elapsed.count() < best) {
+            best = elapsed.count();
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief xorshift random generator - much faster than std::rand when filling big matrices
+ */
+class Random {
+   private:
+    uint64_t state;
+
+   public:
+    explicit Random(uint64_t seed = 0x9E3779B97F4A7C15ULL) : state(seed) {}
+
+    uint64_t next() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+
+    /**
+     * @brief a random number in [0, bound)
+     */
+    size_t below(size_t bound) { return (size_t)(next() % bound); }
+};
+
+/**
+ * @brief a value that the compiler can't optimize away
+ */
+template <typename T>
+void keep(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+}  // namespace bench
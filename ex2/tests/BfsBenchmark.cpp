@@ -0,0 +1,144 @@
+/**
+ * @author Shay Gali
+ * @link shay.gali@msmail.ariel.ac.il
+ *
+ * the BFS of Algorithms (level synchronous, top-down and bottom-up levels, big levels on all the cores) against the old BFS
+ * (std::queue, one vertex at a time), and isConnected (strongly connected components of the directed graph) against the old isConnected
+ * (two DFS with a stack). the distances of the two BFS are compared.
+ *
+ * usage: ./BfsBenchmark [|V|] [out edges of every vertex]   (default 1000000 vertices with 10 out edges - 10M edges)
+ */
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../algorithms/Algorithms.hpp"
+#include "../graph/Graph.hpp"
+#include "Benchmark.hpp"
+
+using namespace shayg;
+using std::string;
+using std::vector;
+
+// random directed graph with `degree` out edges for every vertex
+vector<Edge> randomEdges(size_t n, size_t degree, bench::Random* random) {
+    vector<Edge> edges;
+    vector<bool> used(n, false);
+    vector<size_t> row;
+    for (size_t u = 0; u < n; u++) {
+        row.clear();
+        while (row.size() < degree && row.size() + 1 < n) {
+            size_t v = random->below(n);
+            if (v != u && !used[v]) {
+                used[v] = true;
+                row.push_back(v);
+            }
+        }
+        for (size_t v : row) {
+            used[v] = false;
+            edges.push_back({u, v, 1});
+        }
+    }
+    return edges;
+}
+
+// the old bfs of Algorithms
+vector<int> bfsOld(const Graph& g, size_t src) {
+    vector<int> distances(g.getNumVertices(), INF);
+    vector<int> parents(g.getNumVertices(), -1);
+    distances[src] = 0;
+    std::queue<size_t> q;
+    q.push(src);
+    while (!q.empty()) {
+        size_t u = q.front();
+        q.pop();
+        for (Neighbor neighbor : g.neighbors(u)) {
+            if (distances[neighbor.vertex] == INF) {
+                distances[neighbor.vertex] = distances[u] + 1;
+                parents[neighbor.vertex] = (int)u;
+                q.push(neighbor.vertex);
+            }
+        }
+    }
+    return distances;
+}
+
+// the old isConnected: a DFS forest, then a DFS from the root of the last tree
+size_t dfsOld(const Graph& g, size_t src, vector<bool>* visited) {
+    size_t count = 0;
+    vector<size_t> stack = {src};
+    while (!stack.empty()) {
+        size_t u = stack.back();
+        stack.pop_back();
+        if (!(*visited)[u]) {
+            (*visited)[u] = true;
+            count++;
+            for (Neighbor neighbor : g.neighbors(u)) {
+                if (!(*visited)[neighbor.vertex]) {
+                    stack.push_back(neighbor.vertex);
+                }
+            }
+        }
+    }
+    return count;
+}
+
+bool isConnectedOld(const Graph& g) {
+    size_t n = g.getNumVertices();
+    vector<bool> visited(n, false);
+    size_t trees = 0;
+    size_t lastRoot = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (!visited[i]) {
+            dfsOld(g, i, &visited);
+            trees++;
+            lastRoot = i;
+        }
+    }
+    if (trees == 1 || !g.isDirectedGraph()) {
+        return trees == 1;
+    }
+    vector<bool> fromRoot(n, false);
+    return dfsOld(g, lastRoot, &fromRoot) == n;
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    size_t degree = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 10;
+    bench::Random random;
+
+    Graph g;
+    g.loadEdges(n, randomEdges(n, degree, &random), Storage::SPARSE);
+    size_t src = random.below(n);
+
+    // the distance of every vertex is the number of vertices in its path
+    vector<int> oldDistances = bfsOld(g, src);
+    bool same = true;
+    for (size_t v = 0; v < n && same; v += n / 100 + 1) {
+        string path = Algorithms::shortestPath(g, src, v);
+        long vertices = path == "-1" ? 0 : (long)std::count(path.begin(), path.end(), '>') + 1;
+        same = (oldDistances[v] == INF ? vertices == 0 : vertices == oldDistances[v] + 1);
+    }
+
+    std::cout << "threads: " << std::thread::hardware_concurrency() << ", |V| = " << n << ", |E| = " << g.getNumEdges() << std::endl;
+    std::cout << "query\t\told (ms)\tnew (ms)\tspeedup" << std::endl;
+    double oldMs = bench::bestOf(3, [&]() { bench::keep(bfsOld(g, src)); });
+    double newMs = bench::bestOf(3, [&]() { bench::keep(Algorithms::shortestPath(g, src, 0, Algorithms::SearchMode::FULL)); });
+    std::cout << "BFS tree\t" << oldMs << "\t\t" << newMs << "\t\t" << oldMs / newMs << "x" << std::endl;
+
+    bool oldConnected = false;
+    bool newConnected = false;
+    oldMs = bench::bestOf(3, [&]() { oldConnected = isConnectedOld(g); });
+    newMs = bench::bestOf(3, [&]() { newConnected = Algorithms::isConnected(g); });
+    std::cout << "isConnected\t" << oldMs << "\t\t" << newMs << "\t\t" << oldMs / newMs << "x" << std::endl;
+
+    if (!same || oldConnected != newConnected) {
+        std::cerr << "the results are different" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,109 @@
+/**
+ * @author Shay Gali
+ * @link shay.gali@msmail.ariel.ac.il
+ *
+ * the connected components of a random undirected graph: the old isConnected (DFS with a stack, a yes/no answer) against
+ * Algorithms::connectedComponents (union-find on all the cores, the label of every vertex). then the edges are added in batches:
+ * IncrementalComponents::addEdges on every batch against the components of all the edges so far, from scratch after every batch.
+ * the number of components of the two ways is compared after every batch.
+ *
+ * usage: ./ComponentsBenchmark [|V|] [batches]   (default 1000000 vertices with 5 random edges each - 10M cells, 10 batches)
+ */
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "../algorithms/Algorithms.hpp"
+#include "../graph/Graph.hpp"
+#include "Benchmark.hpp"
+
+using namespace shayg;
+using std::vector;
+
+// the edges of a random undirected graph (both directions), sorted and without duplicates
+vector<Edge> randomEdges(size_t n, bench::Random* random) {
+    vector<Edge> edges;
+    for (size_t u = 0; u < n; u++) {
+        for (int k = 0; k < 5; k++) {
+            size_t v = random->below(n);
+            if (v != u) {
+                edges.push_back({u, v, 1});
+                edges.push_back({v, u, 1});
+            }
+        }
+    }
+    auto less = [](const Edge& a, const Edge& b) { return a.from < b.from || (a.from == b.from && a.to < b.to); };
+    auto same = [](const Edge& a, const Edge& b) { return a.from == b.from && a.to == b.to; };
+    std::sort(edges.begin(), edges.end(), less);
+    edges.erase(std::unique(edges.begin(), edges.end(), same), edges.end());
+    return edges;
+}
+
+// the old isConnected of an undirected graph
+bool isConnectedOld(const Graph& g) {
+    vector<bool> visited(g.getNumVertices(), false);
+    size_t count = 0;
+    vector<size_t> stack = {0};
+    while (!stack.empty()) {
+        size_t u = stack.back();
+        stack.pop_back();
+        if (!visited[u]) {
+            visited[u] = true;
+            count++;
+            for (Neighbor neighbor : g.neighbors(u)) {
+                if (!visited[neighbor.vertex]) {
+                    stack.push_back(neighbor.vertex);
+                }
+            }
+        }
+    }
+    return count == g.getNumVertices();
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    size_t batches = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 10;
+    bench::Random random;
+    vector<Edge> edges = randomEdges(n, &random);
+    Graph g;
+    g.loadEdges(n, edges, Storage::SPARSE);
+
+    std::cout << "threads: " << std::thread::hardware_concurrency() << ", |V| = " << n << ", |E| = " << g.getNumEdges() << std::endl;
+    bool oldConnected = false;
+    Algorithms::Components components;
+    double oldMs = bench::bestOf(3, [&]() { oldConnected = isConnectedOld(g); });
+    double newMs = bench::bestOf(3, [&]() { components = Algorithms::connectedComponents(g); });
+    std::cout << "old isConnected (ms)\tconnectedComponents (ms)" << std::endl;
+    std::cout << oldMs << "\t\t\t" << newMs << std::endl;
+    bool same = oldConnected == (components.count() == 1);
+
+    // the same edges in random order, added in batches
+    for (size_t i = edges.size() - 1; i > 0; i--) {
+        std::swap(edges[i], edges[random.below(i + 1)]);
+    }
+    Algorithms::IncrementalComponents incremental(n);
+    vector<Edge> added;
+    double incrementalMs = 0;
+    double fromScratchMs = 0;
+    for (size_t b = 0; b < batches; b++) {
+        vector<Edge> batch(edges.begin() + (long)(edges.size() * b / batches), edges.begin() + (long)(edges.size() * (b + 1) / batches));
+        incrementalMs += bench::bestOf(1, [&]() { incremental.addEdges(batch); });
+
+        added.insert(added.end(), batch.begin(), batch.end());
+        fromScratchMs += bench::bestOf(1, [&]() {
+            Algorithms::IncrementalComponents fromScratch(n);
+            fromScratch.addEdges(added);
+            same = same && fromScratch.count() == incremental.count();
+        });
+    }
+    std::cout << "batches\taddEdges (ms)\tfrom scratch (ms)\tspeedup" << std::endl;
+    std::cout << batches << "\t" << incrementalMs << "\t\t" << fromScratchMs << "\t\t\t" << fromScratchMs / incrementalMs << "x" << std::endl;
+
+    if (!same || incremental.count() != components.count()) {
+        std::cerr << "the results are different" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,145 @@
+/**
+ * @author Shay Gali
+ * @link shay.gali@msmail.ariel.ac.il
+ *
+ * the cycle search of Algorithms on a big random DAG (the worst case - every vertex and edge is scanned): the old recursive DFS
+ * (a string of the path on every call), findCycle (a DFS with its own stack) and findCycleParallel (in-degree trimming on all the cores).
+ * then one edge closes a cycle, and the cycles are checked. (on a path of a million vertices the old DFS overflows the stack, so it is not measured there)
+ *
+ * usage: ./CycleBenchmark [|V|] [out edges of every vertex]   (default 1000000 vertices with 8 out edges)
+ */
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../algorithms/Algorithms.hpp"
+#include "../graph/Graph.hpp"
+#include "Benchmark.hpp"
+
+using namespace shayg;
+using std::string;
+using std::vector;
+
+// random DAG: the edges go from a vertex to one of the next 64 vertices in a random order of the vertices
+vector<Edge> randomDag(size_t n, size_t degree, bench::Random* random) {
+    vector<size_t> order(n);
+    for (size_t i = 0; i < n; i++) {
+        order[i] = i;
+    }
+    for (size_t i = n - 1; i > 0; i--) {
+        std::swap(order[i], order[random->below(i + 1)]);
+    }
+    vector<Edge> edges;
+    vector<bool> used(64, false);
+    for (size_t i = 0; i + 1 < n; i++) {
+        size_t window = std::min<size_t>(64, n - 1 - i);
+        size_t count = 0;
+        for (size_t tries = 0; tries < 4 * degree && count < std::min(degree, window); tries++) {
+            size_t step = random->below(window);
+            if (!used[step]) {
+                used[step] = true;
+                count++;
+            }
+        }
+        for (size_t step = 0; step < 64; step++) {
+            if (used[step]) {
+                used[step] = false;
+                edges.push_back({order[i], order[i + 1 + step], 1});
+            }
+        }
+    }
+    return edges;
+}
+
+// the old isContainsCycle: a recursive DFS that builds the cycle string from a path array
+string dfsOld(const Graph& g, size_t u, vector<int>* colors, vector<int>* parents, vector<int>* path) {
+    (*colors)[u] = 1;
+    path->push_back((int)u);
+    for (Neighbor neighbor : g.neighbors(u)) {
+        size_t v = neighbor.vertex;
+        if ((*colors)[v] == 0) {
+            (*parents)[v] = (int)u;
+            string cycle = dfsOld(g, v, colors, parents, path);
+            if (cycle != "-1") {
+                return cycle;
+            }
+        } else if ((*colors)[v] == 1 && (g.isDirectedGraph() || (*parents)[u] != (int)v)) {
+            string cycle;
+            size_t i = 0;
+            while ((*path)[i] != (int)v) {
+                i++;
+            }
+            for (; i < path->size(); i++) {
+                cycle += std::to_string((*path)[i]) + "->";
+            }
+            return cycle + std::to_string(v);
+        }
+    }
+    (*colors)[u] = 2;
+    path->pop_back();
+    return "-1";
+}
+
+string isContainsCycleOld(const Graph& g) {
+    size_t n = g.getNumVertices();
+    vector<int> colors(n, 0);
+    vector<int> parents(n, -1);
+    vector<int> path;
+    for (size_t v = 0; v < n; v++) {
+        if (colors[v] == 0) {
+            string cycle = dfsOld(g, v, &colors, &parents, &path);
+            if (cycle != "-1") {
+                return cycle;
+            }
+        }
+    }
+    return "-1";
+}
+
+bool isCycleOf(const Graph& g, const vector<size_t>& cycle) {
+    if (cycle.size() < 3 || cycle.front() != cycle.back()) {
+        return false;
+    }
+    for (size_t i = 1; i < cycle.size(); i++) {
+        if (g.getEdgeWeight(cycle[i - 1], cycle[i]) == NO_EDGE) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    size_t degree = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 8;
+    bench::Random random;
+
+    vector<Edge> edges = randomDag(n, degree, &random);
+    Graph g;
+    g.loadEdges(n, edges, Storage::SPARSE);
+
+    std::cout << "threads: " << std::thread::hardware_concurrency() << ", |V| = " << n << ", |E| = " << g.getNumEdges() << std::endl;
+    std::cout << "DAG\t\t\ttime (ms)" << std::endl;
+    string oldCycle;
+    vector<size_t> cycle;
+    vector<size_t> parallelCycle = {0};
+    double ms = bench::bestOf(1, [&]() { oldCycle = isContainsCycleOld(g); });
+    std::cout << "old recursive DFS\t" << ms << std::endl;
+    ms = bench::bestOf(3, [&]() { cycle = Algorithms::findCycle(g); });
+    std::cout << "findCycle\t\t" << ms << std::endl;
+    ms = bench::bestOf(3, [&]() { parallelCycle = Algorithms::findCycleParallel(g); });
+    std::cout << "findCycleParallel\t" << ms << std::endl;
+    bool same = oldCycle == "-1" && cycle.empty() && parallelCycle.empty();
+
+    // the edge from the last vertex of a path back to its first vertex closes a cycle
+    edges.push_back({edges.back().to, edges.back().from, 1});
+    g.loadEdges(n, edges, Storage::SPARSE);
+    same = same && isCycleOf(g, Algorithms::findCycle(g)) && isCycleOf(g, Algorithms::findCycleParallel(g));
+
+    if (!same) {
+        std::cerr << "the results are different" << std::endl;
+        return 1;
+    }
+    return 0;
+}
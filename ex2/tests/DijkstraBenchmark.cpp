@@ -0,0 +1,128 @@
+/**
+ * @author Shay Gali
+ * @link shay.gali@msmail.ariel.ac.il
+ *
+ * Algorithms::shortestPath on graphs with positive weights (Dial's buckets when the weights are small, a 4-ary lazy heap otherwise)
+ * against the old dijkstra (std::priority_queue of (distance, vertex) with a new entry for every relaxation).
+ * the paths of the two are compared on every graph.
+ *
+ * usage: ./DijkstraBenchmark [|V|]   (default 1000000)
+ */
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../algorithms/Algorithms.hpp"
+#include "../graph/Graph.hpp"
+#include "Benchmark.hpp"
+
+using namespace shayg;
+using std::pair;
+using std::string;
+using std::vector;
+
+// the old dijkstra and the path to dest, in the format of shortestPath
+string oldShortestPath(const Graph& g, size_t src, size_t dest) {
+    size_t n = g.getNumVertices();
+    vector<int> distances(n, INF);
+    vector<int> parents(n, -1);
+    std::priority_queue<pair<int, size_t>, vector<pair<int, size_t>>, std::greater<pair<int, size_t>>> pq;
+    distances[src] = 0;
+    pq.push({0, src});
+    while (!pq.empty()) {
+        size_t u = pq.top().second;
+        pq.pop();
+        for (auto [v, weight] : g.neighbors(u)) {
+            if (distances[u] + weight < distances[v]) {
+                distances[v] = distances[u] + weight;
+                parents[v] = (int)u;
+                pq.push({distances[v], v});
+            }
+        }
+    }
+    if (distances[dest] == INF) {
+        return "-1";
+    }
+    string path = std::to_string(dest);
+    for (int parent = parents[dest]; parent != -1; parent = parents[(size_t)parent]) {
+        path.insert(0, std::to_string(parent) + "->");
+    }
+    return path;
+}
+
+// random directed graph with 8 out edges for every vertex, weights in [1, maxWeight]
+vector<Edge> randomEdges(size_t n, int maxWeight, bench::Random* random) {
+    vector<Edge> edges;
+    vector<bool> used(n, false);
+    vector<size_t> row;
+    for (size_t u = 0; u < n; u++) {
+        row.clear();
+        while (row.size() < 8 && row.size() + 1 < n) {
+            size_t v = random->below(n);
+            if (v != u && !used[v]) {
+                used[v] = true;
+                row.push_back(v);
+            }
+        }
+        for (size_t v : row) {
+            used[v] = false;
+            edges.push_back({u, v, (int)random->below((size_t)maxWeight) + 1});
+        }
+    }
+    return edges;
+}
+
+// undirected side x side grid, weights in [1, maxWeight]
+vector<Edge> gridEdges(size_t side, int maxWeight, bench::Random* random) {
+    vector<Edge> edges;
+    for (size_t r = 0; r < side; r++) {
+        for (size_t c = 0; c < side; c++) {
+            size_t u = r * side + c;
+            for (size_t v : {c + 1 < side ? u + 1 : u, r + 1 < side ? u + side : u}) {
+                if (v != u) {
+                    int weight = (int)random->below((size_t)maxWeight) + 1;
+                    edges.push_back({u, v, weight});
+                    edges.push_back({v, u, weight});
+                }
+            }
+        }
+    }
+    return edges;
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    size_t side = 1;
+    while ((side + 1) * (side + 1) <= n) {
+        side++;
+    }
+    bench::Random random;
+    bool allSame = true;
+
+    std::cout << "graph\tmax weight\told (ms)\tnew (ms)\tspeedup" << std::endl;
+    for (bool grid : {false, true}) {
+        for (int maxWeight : {16, 255, 4096, 65536, 1000000}) {
+            Graph g;
+            if (grid) {
+                g.loadEdges(side * side, gridEdges(side, maxWeight, &random));
+            } else {
+                g.loadEdges(n, randomEdges(n, maxWeight, &random));
+            }
+            size_t dest = g.getNumVertices() - 1;
+
+            string oldPath;
+            string newPath;
+            double oldMs = bench::bestOf(3, [&]() { oldPath = oldShortestPath(g, 0, dest); });
+            double newMs = bench::bestOf(3, [&]() { newPath = Algorithms::shortestPath(g, 0, dest); });
+            bool same = oldPath == newPath;
+            allSame &= same;
+            std::cout << (grid ? "grid" : "random") << "\t" << maxWeight << "\t\t" << oldMs << "\t\t" << newMs << "\t\t" << oldMs / newMs << "x"
+                      << (same ? "" : "\tDIFFERENT PATHS") << std::endl;
+        }
+    }
+    return allSame ? 0 : 1;
+}
@@ -2,13 +2,22 @@
  * @author Shay Gali
  * @link shay.gali@msmail.ariel.ac.il
  */
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <limits>
 #include <sstream>
 #include <stdexcept>
+#include <thread>
 #include <vector>
 
 #include "../algorithms/Algorithms.hpp"
 #include "../graph/Graph.hpp"
+#include "../graph/GraphFile.hpp"
 #include "doctest.h"
 
 using namespace shayg;
@@ -84,6 +93,661 @@ TEST_CASE("Test loadGraph") {
     }
 }
 
+TEST_CASE("Test loadGraph without a copy") {
+    Graph g;
+    Graph expected;
+    vector<vector<int>> graph = {
+        // clang-format off
+        {NO_EDGE, 2,       NO_EDGE, -1     },
+        {2,       NO_EDGE, 3,       NO_EDGE},
+        {NO_EDGE, 3,       NO_EDGE, 1      },
+        {-1,      NO_EDGE, 1,       NO_EDGE}
+        // clang-format on
+    };
+    expected.loadGraph(graph);
+
+    SUBCASE("move the matrix in") {
+        vector<vector<int>> moved = graph;
+        g.loadGraph(std::move(moved));
+        CHECK(g.getGraph() == graph);
+        CHECK(g.getNumEdges() == expected.getNumEdges());
+        CHECK(g.isDirectedGraph() == false);
+        CHECK(g.isHaveNegativeEdgeWeight() == true);
+        CHECK(moved.empty());  // NOLINT(bugprone-use-after-move)
+
+        moved = graph;
+        g.loadGraph(std::move(moved), Storage::SPARSE);
+        CHECK(g.getCSR().weights == expected.getCSR().weights);
+
+        // a matrix that is not valid - the graph is not changed
+        vector<vector<int>> notSquare = {{NO_EDGE, 1}, {1}};
+        CHECK_THROWS_AS(g.loadGraph(std::move(notSquare)), std::invalid_argument);
+        vector<vector<int>> diagonal = {{NO_EDGE, 1}, {1, 1}};
+        CHECK_THROWS_AS(g.loadGraph(std::move(diagonal)), std::invalid_argument);
+        CHECK(g.getStorage() == Storage::SPARSE);
+        CHECK(g.getNumVertices() == 4);
+    }
+
+    SUBCASE("a view over a buffer") {
+        vector<int> cells;
+        for (const vector<int>& row : graph) {
+            cells.insert(cells.end(), row.begin(), row.end());
+        }
+        g.loadGraph(cells.data(), 4);
+        CHECK(g.getGraph().isView() == true);
+        CHECK(g.getGraph().data() == cells.data());  // nothing was copied
+        CHECK(g.getGraph() == graph);
+        CHECK(g.getCSR().targets == expected.getCSR().targets);
+        CHECK(g.getNumEdges() == 4);
+        CHECK(g.isDirectedGraph() == false);
+        CHECK((g * g).getGraph() == (expected * expected).getGraph());
+
+        // a change of the graph copies the matrix, the buffer is not changed
+        g.setEdge(0, 1, 7);
+        CHECK(g.getGraph().isView() == false);
+        CHECK(g.getGraph()[0][1] == 7);
+        CHECK(cells[1] == 2);
+        g.loadGraph(cells.data(), 4);
+        g *= 2;
+        CHECK(g.getGraph()[0][1] == 4);
+        CHECK(cells[1] == 2);
+
+        g.loadGraph(cells.data(), 4, Storage::SPARSE);
+        CHECK(g.getCSR().weights == expected.getCSR().weights);
+        CHECK_THROWS_AS(g.loadGraph(cells.data(), 4, Storage::BITSET), std::invalid_argument);
+
+        cells[5] = 1;  // (1, 1)
+        CHECK_THROWS_AS(g.loadGraph(cells.data(), 4), std::invalid_argument);
+        CHECK_THROWS_AS(g.loadGraph(nullptr, 4), std::invalid_argument);
+        g.loadGraph(nullptr, 0);
+        CHECK(g.getNumVertices() == 0);
+    }
+}
+
+TEST_CASE("Test loadEdges") {
+    Graph g;
+    SUBCASE("undirected sparse graph") {
+        vector<Edge> edges = {{0, 1, 1}, {1, 0, 1}, {1, 2, 1}, {2, 1, 1}, {0, 2, 1}, {2, 0, 1}};
+        g.loadEdges(3, edges);
+        CHECK(g.getStorage() == Storage::SPARSE);
+        CHECK(g.getNumVertices() == 3);
+        CHECK(g.getNumEdges() == 3);
+        CHECK(g.isDirectedGraph() == false);
+        CHECK(g.isWeightedGraph() == false);
+        CHECK(g.getCSR().offsets == vector<size_t>{0, 2, 4, 6});
+        CHECK(g.getCSR().targets == vector<size_t>{1, 2, 0, 2, 0, 1});
+        CHECK_THROWS_AS(g.getGraph(), std::logic_error);
+    }
+
+    SUBCASE("directed sparse graph") {
+        // the edges are not sorted, and the weight of (1, 0) is not the same as (0, 1)
+        vector<Edge> edges = {{1, 2, 2}, {0, 2, -1}, {0, 1, 1}, {1, 0, 3}};
+        g.loadEdges(3, edges);
+        CHECK(g.getNumEdges() == 4);
+        CHECK(g.isDirectedGraph() == true);
+        CHECK(g.isWeightedGraph() == true);
+        CHECK(g.isHaveNegativeEdgeWeight() == true);
+        CHECK(g.getCSR().targets == vector<size_t>{1, 2, 0, 2});
+        CHECK(g.getCSR().weights == vector<int>{1, -1, 3, 2});
+
+        stringstream ss;
+        ss << g;
+        CHECK(ss.str() == "[X, 1, -1],\n[3, X, 2],\n[X, X, X]");
+    }
+
+    SUBCASE("dense and sparse storage of the same matrix") {
+        vector<vector<int>> graph = {
+            // clang-format off
+            {NO_EDGE, 1,       -1     },
+            {NO_EDGE, NO_EDGE, 2      },
+            {NO_EDGE, NO_EDGE, NO_EDGE}
+            // clang-format on
+        };
+        Graph sparse;
+        sparse.loadGraph(graph, Storage::SPARSE);
+        g.loadEdges(3, {{0, 1, 1}, {0, 2, -1}, {1, 2, 2}}, Storage::DENSE);
+        CHECK(g.getGraph() == graph);
+        CHECK(sparse.getNumEdges() == g.getNumEdges());
+        CHECK(sparse.isDirectedGraph() == g.isDirectedGraph());
+        CHECK(sparse.getCSR().weights == vector<int>{1, -1, 2});
+
+        // the arithmetic operators that need the matrix can't be used on sparse graph
+        CHECK_THROWS_AS(sparse + g, std::logic_error);
+        Graph scaled = sparse * 2;
+        CHECK(scaled.getCSR().weights == vector<int>{2, -2, 4});
+    }
+
+    SUBCASE("errors") {
+        // vertex out of range
+        CHECK_THROWS_AS(g.loadEdges(2, {{0, 2, 1}}), std::invalid_argument);
+        // edge from a vertex to itself
+        CHECK_THROWS_AS(g.loadEdges(2, {{1, 1, 1}}), std::invalid_argument);
+        // the same edge twice
+        CHECK_THROWS_AS(g.loadEdges(2, {{0, 1, 1}, {0, 1, 2}}), std::invalid_argument);
+        CHECK_THROWS_AS(g.loadEdges(2, {{0, 1, 1}, {0, 1, 2}}, Storage::DENSE), std::invalid_argument);
+    }
+}
+
+TEST_CASE("Test loadEdgeList and loadMatrixMarket") {
+    const char* path = "GraphTest.txt";
+    Graph g;
+    Graph expected;
+    expected.loadEdges(4, {{0, 1, 2}, {0, 3, -1}, {1, 2, 1}, {2, 0, 4}, {3, 2, 1}});
+
+    SUBCASE("edge list") {
+        std::ofstream(path) << "# u v w\n0 1 2\n0\t3 -1\r\n\n1 2\n% a comment\n2 0 4\n  3 2 1  \n";
+        g.loadEdgeList(path);
+        CHECK(g.getStorage() == Storage::SPARSE);
+        CHECK(g.getNumVertices() == 4);
+        CHECK(g.getCSR().offsets == expected.getCSR().offsets);
+        CHECK(g.getCSR().targets == expected.getCSR().targets);
+        CHECK(g.getCSR().weights == expected.getCSR().weights);
+        CHECK(g.isDirectedGraph() == true);
+
+        g.loadEdgeList(path, Storage::DENSE);
+        CHECK(g.getGraph() == vector<vector<int>>{{0, 2, 0, -1}, {0, 0, 1, 0}, {4, 0, 0, 0}, {0, 0, 1, 0}});
+        CHECK_THROWS_AS(g.loadEdgeList(path, Storage::BITSET), std::invalid_argument);
+
+        std::ofstream(path) << "0 1\n1 0\n";
+        g.loadEdgeList(path, Storage::BITSET);
+        CHECK(g.getNumEdges() == 1);
+        CHECK(g.isDirectedGraph() == false);
+
+        std::ofstream(path) << "";
+        g.loadEdgeList(path);
+        CHECK(g.getNumVertices() == 0);
+    }
+
+    SUBCASE("a big edge list is parsed by all the threads") {
+        // a cycle of 300k vertices, a few MB of text - more than one part
+        size_t n = 300000;
+        vector<Edge> edges;
+        {
+            std::ofstream out(path);
+            for (size_t u = 0; u < n; u++) {
+                edges.push_back({u, (u + 1) % n, (int)(u % 7) - 3});
+                out << u << " " << (u + 1) % n << " " << (int)(u % 7) - 3 << "\n";
+            }
+        }
+        g.loadEdgeList(path);
+        expected.loadEdges(n, edges);
+        CHECK(g.getNumEdges() == expected.getNumEdges());
+        CHECK(g.getCSR().targets == expected.getCSR().targets);
+        CHECK(g.getCSR().weights == expected.getCSR().weights);
+
+        // the error of the part of the second thread has the line number in the whole file
+        std::ofstream(path, std::ios::app) << "1 x 3\n";
+        try {
+            g.loadEdgeList(path);
+            CHECK(false);
+        } catch (const std::invalid_argument& error) {
+            CHECK(string(error.what()) == "Invalid graph file: line 300001: expected a vertex.");
+        }
+    }
+
+    SUBCASE("edge lists that are not valid") {
+        g.loadEdges(2, {{0, 1, 1}});
+        for (const char* text : {"0 1 2 3\n", "0 -1\n", "0 1 w\n", "0 1 99999999999\n", "2 2 1\n", "0 1\n0 1 3\n", "0,1\n"}) {
+            std::ofstream(path) << text;
+            CHECK_THROWS_AS(g.loadEdgeList(path), std::invalid_argument);
+        }
+        CHECK_THROWS_AS(g.loadEdgeList("no such file.txt"), std::invalid_argument);
+        CHECK(g.getNumEdges() == 1);  // the graph is not changed
+    }
+
+    SUBCASE("Matrix Market") {
+        std::ofstream(path) << "%%MatrixMarket matrix coordinate integer general\n% a comment\n4 4 5\n1 2 2\n1 4 -1\n2 3 1\n3 1 4\n4 3 1\n";
+        g.loadMatrixMarket(path);
+        CHECK(g.getCSR().targets == expected.getCSR().targets);
+        CHECK(g.getCSR().weights == expected.getCSR().weights);
+
+        std::ofstream(path) << "%%MatrixMarket matrix coordinate pattern symmetric\n3 3 2\n2 1\n3 2\n";
+        g.loadMatrixMarket(path, Storage::DENSE);
+        CHECK(g.getGraph() == vector<vector<int>>{{0, 1, 0}, {1, 0, 1}, {0, 1, 0}});
+        CHECK(g.isDirectedGraph() == false);
+
+        std::ofstream(path) << "%%MatrixMarket matrix coordinate integer skew-symmetric\n2 2 1\n2 1 5\n";
+        g.loadMatrixMarket(path, Storage::DENSE);
+        CHECK(g.getGraph() == vector<vector<int>>{{0, -5}, {5, 0}});
+
+        for (const char* text : {"%%MatrixMarket matrix array integer general\n2 2\n1\n2\n3\n4\n",
+                                 "%%MatrixMarket matrix coordinate real general\n2 2 1\n1 2 1.5\n",
+                                 "%%MatrixMarket matrix coordinate integer general\n2 3 1\n1 2 1\n",
+                                 "%%MatrixMarket matrix coordinate integer general\n2 2 2\n1 2 1\n",
+                                 "%%MatrixMarket matrix coordinate integer general\n2 2 1\n1 3 1\n",
+                                 "%%MatrixMarket matrix coordinate integer general\n2 2 1\n1 1 1\n",
+                                 "%%MatrixMarket matrix coordinate integer general\n",
+                                 "0 1 2\n"}) {
+            std::ofstream(path) << text;
+            CHECK_THROWS_AS(g.loadMatrixMarket(path), std::invalid_argument);
+        }
+    }
+    std::remove(path);
+}
+
+TEST_CASE("Test saveFile and loadFile") {
+    const char* path = "GraphTest.bin";
+    Graph g;
+    Graph loaded;
+    vector<vector<int>> directed = {
+        // clang-format off
+        {NO_EDGE, 2,       NO_EDGE, -1     },
+        {NO_EDGE, NO_EDGE, 3,       NO_EDGE},
+        {4,       NO_EDGE, NO_EDGE, NO_EDGE},
+        {NO_EDGE, NO_EDGE, 1,       NO_EDGE}
+        // clang-format on
+    };
+    vector<vector<int>> undirected = {
+        // clang-format off
+        {NO_EDGE, 1,       1      },
+        {1,       NO_EDGE, NO_EDGE},
+        {1,       NO_EDGE, NO_EDGE}
+        // clang-format on
+    };
+
+    SUBCASE("all the storages") {
+        for (Storage storage : {Storage::DENSE, Storage::SPARSE, Storage::BITSET}) {
+            for (const vector<vector<int>>& graph : {directed, undirected}) {
+                if (storage == Storage::BITSET && graph == directed) {
+                    g.loadEdges(4, {{0, 1, 1}, {1, 2, 1}, {2, 0, 1}, {3, 2, 1}}, Storage::BITSET);
+                } else {
+                    g.loadGraph(graph, storage);
+                }
+                g.saveFile(path);
+                loaded.loadFile(path);
+
+                CHECK(loaded.getStorage() == storage);
+                CHECK(loaded.getNumVertices() == g.getNumVertices());
+                CHECK(loaded.getNumEdges() == g.getNumEdges());
+                CHECK(loaded.isDirectedGraph() == g.isDirectedGraph());
+                CHECK(loaded.isWeightedGraph() == g.isWeightedGraph());
+                CHECK(loaded.isHaveNegativeEdgeWeight() == g.isHaveNegativeEdgeWeight());
+                if (storage == Storage::BITSET) {
+                    CHECK(loaded.getBits() == g.getBits());
+                    CHECK(loaded.getInBits() == g.getInBits());
+                    continue;
+                }
+                CHECK(loaded.getCSR().offsets == g.getCSR().offsets);
+                CHECK(loaded.getCSR().targets == g.getCSR().targets);
+                CHECK(loaded.getCSR().weights == g.getCSR().weights);
+                for (size_t u = 0; u < g.getNumVertices(); u++) {
+                    CHECK(loaded.inNeighbors(u).size() == g.inNeighbors(u).size());
+                }
+                if (storage == Storage::DENSE) {
+                    CHECK(loaded.getGraph().isView() == true);  // the cells are read from the mapped file
+                    CHECK(loaded.getGraph() == graph);
+                }
+            }
+        }
+    }
+
+    SUBCASE("change a loaded graph") {
+        g.loadGraph(directed);
+        g.saveFile(path);
+        loaded.loadFile(path);
+        Graph copy = loaded;  // the copy keeps the file mapped too
+        loaded.setEdge(1, 0, 5);
+        CHECK(loaded.getGraph().isView() == false);
+        CHECK(loaded.getEdgeWeight(1, 0) == 5);
+        CHECK(loaded.getNumEdges() == 6);
+        loaded *= 2;
+        CHECK(loaded.getEdgeWeight(0, 1) == 4);
+
+        loaded.loadGraph(undirected);  // the mapping is released
+        CHECK(copy.getGraph() == directed);
+        CHECK(copy.getEdgeWeight(1, 0) == NO_EDGE);
+        CHECK(Algorithms::shortestPath(copy, 0, 2) == "0->3->2");
+
+        g.loadEdges(2, {});
+        g.saveFile(path);
+        loaded.loadFile(path);
+        CHECK(loaded.getNumVertices() == 2);
+        CHECK(loaded.getNumEdges() == 0);
+    }
+
+    SUBCASE("save a loaded graph to its own file") {
+        g.loadGraph(directed);
+        g.saveFile(path);
+        loaded.loadFile(path);
+        CHECK(loaded.getGraph().isView() == true);
+        loaded.saveFile(path);  // the matrix is read from the file that is replaced
+        CHECK(loaded.getGraph() == directed);
+        CHECK(loaded.getEdgeWeight(0, 1) == 2);
+
+        Graph reloaded;
+        reloaded.loadFile(path);
+        CHECK(reloaded.getGraph() == directed);
+        CHECK(reloaded.getNumEdges() == loaded.getNumEdges());
+        CHECK(std::ifstream(std::string(path) + ".tmp").good() == false);
+
+        loaded *= 2;  // a changed copy of the mapped matrix is saved over its own file
+        loaded.saveFile(path);
+        reloaded.loadFile(path);
+        CHECK(reloaded.getEdgeWeight(0, 1) == 4);
+    }
+
+    SUBCASE("files that are not valid") {
+        g.loadGraph(directed);
+        loaded.loadGraph(undirected);
+        CHECK_THROWS_AS(loaded.loadFile("no such file.bin"), std::invalid_argument);
+        CHECK_THROWS_AS(g.saveFile("no such directory/graph.bin"), std::invalid_argument);
+
+        std::ofstream(path) << "not a graph file, but long enough to have a header of a graph file in it..............";
+        CHECK_THROWS_AS(loaded.loadFile(path), std::invalid_argument);
+        std::ofstream(path, std::ios::trunc).close();  // an empty file
+        CHECK_THROWS_AS(loaded.loadFile(path), std::invalid_argument);
+
+        // a file that was cut in the middle
+        g.saveFile(path);
+        std::string bytes;
+        {
+            std::ifstream in(path, std::ios::binary);
+            bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+        std::ofstream(path, std::ios::binary | std::ios::trunc).write(bytes.data(), (std::streamsize)bytes.size() / 2);
+        CHECK_THROWS_AS(loaded.loadFile(path), std::invalid_argument);
+
+        // a corrupt number of vertices in the header, in every storage
+        for (Storage storage : {Storage::DENSE, Storage::SPARSE, Storage::BITSET}) {
+            g.loadGraph(undirected, storage);
+            g.saveFile(path);
+            std::string corrupt;
+            {
+                std::ifstream in(path, std::ios::binary);
+                corrupt.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+            }
+            for (uint64_t numVertices : {std::numeric_limits<uint64_t>::max(), uint64_t{1} << 40U, (uint64_t)corrupt.size()}) {
+                std::memcpy(&corrupt[offsetof(GraphFileHeader, numVertices)], &numVertices, sizeof(numVertices));
+                std::ofstream(path, std::ios::binary | std::ios::trunc).write(corrupt.data(), (std::streamsize)corrupt.size());
+                CHECK_THROWS_AS(loaded.loadFile(path), std::invalid_argument);
+            }
+        }
+
+        // corrupt bits in a bitset file of 10 vertices (one word in every row): a padding bit, a bit on the diagonal,
+        // one more edge than in the header, and in a directed graph out bits that are not the transposed in bits
+        size_t bitsStart = (sizeof(GraphFileHeader) + GRAPH_FILE_ALIGN - 1) / GRAPH_FILE_ALIGN * GRAPH_FILE_ALIGN;
+        auto flipBit = [&](bool isDirected, vector<pair<size_t, size_t>> cells) {
+            g.loadEdges(10, {{0, 1, 1}, {1, 0, 1}, {2, 3, 1}, {3, 2, 1}}, Storage::BITSET);
+            if (isDirected) {
+                g.removeEdge(3, 2);
+            }
+            g.saveFile(path);
+            std::string corrupt;
+            {
+                std::ifstream in(path, std::ios::binary);
+                corrupt.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+            }
+            for (auto [row, column] : cells) {
+                corrupt[bitsStart + row * sizeof(uint64_t) + column / 8] ^= (char)(1U << (column % 8));
+            }
+            std::ofstream(path, std::ios::binary | std::ios::trunc).write(corrupt.data(), (std::streamsize)corrupt.size());
+        };
+        flipBit(false, {});
+        Graph valid;
+        valid.loadFile(path);
+        CHECK(Algorithms::isConnected(valid) == false);
+        flipBit(false, {{0, 12}});  // the padding of row 0
+        CHECK_THROWS_AS(loaded.loadFile(path), std::invalid_argument);
+        flipBit(false, {{4, 4}});
+        CHECK_THROWS_AS(loaded.loadFile(path), std::invalid_argument);
+        flipBit(false, {{4, 5}});
+        CHECK_THROWS_AS(loaded.loadFile(path), std::invalid_argument);
+        flipBit(false, {{4, 5}, {0, 1}});  // the same number of bits, but not symmetric
+        CHECK_THROWS_AS(loaded.loadFile(path), std::invalid_argument);
+        flipBit(true, {{4, 5}, {0, 1}});  // the out bits don't match the in bits
+        CHECK_THROWS_AS(loaded.loadFile(path), std::invalid_argument);
+
+        // another version of the format
+        bytes[8] = 99;
+        std::ofstream(path, std::ios::binary | std::ios::trunc).write(bytes.data(), (std::streamsize)bytes.size());
+        CHECK_THROWS_AS(loaded.loadFile(path), std::invalid_argument);
+
+        CHECK(loaded.getGraph() == undirected);  // the graph is not changed
+    }
+    std::remove(path);
+}
+
+TEST_CASE("Test setEdge") {
+    Graph g;
+    SUBCASE("the fields follow every change") {
+        g.loadGraph(vector<vector<int>>{{NO_EDGE, 1, NO_EDGE}, {1, NO_EDGE, NO_EDGE}, {NO_EDGE, NO_EDGE, NO_EDGE}});
+        CHECK(g.isDirectedGraph() == false);
+        CHECK(g.getNumEdges() == 1);
+
+        g.setEdge(1, 2, 1);  // (2, 1) is missing - the graph is directed
+        CHECK(g.isDirectedGraph() == true);
+        CHECK(g.getNumEdges() == 3);
+        CHECK(g.getGraph()[1][2] == 1);
+        CHECK(g.inNeighbors(2).size() == 1);
+
+        g.setEdge(2, 1, 1);
+        CHECK(g.isDirectedGraph() == false);
+        CHECK(g.getNumEdges() == 2);
+        CHECK(g.isWeightedGraph() == false);
+
+        g.setEdge(0, 1, -4);
+        CHECK(g.isDirectedGraph() == true);
+        CHECK(g.isWeightedGraph() == true);
+        CHECK(g.isHaveNegativeEdgeWeight() == true);
+        CHECK(g.getEdgeWeight(0, 1) == -4);
+        g.setEdge(1, 0, -4);
+        CHECK(g.isDirectedGraph() == false);
+        CHECK(g.getNumEdges() == 2);
+
+        g.removeEdge(0, 1);
+        g.removeEdge(1, 0);
+        CHECK(g.isHaveNegativeEdgeWeight() == false);
+        CHECK(g.isWeightedGraph() == false);
+        CHECK(g.getNumEdges() == 1);
+        CHECK(g.neighbors(0).empty());
+        g.removeEdge(0, 1);  // no edge - nothing changes
+        CHECK(g.getNumEdges() == 1);
+    }
+
+    SUBCASE("the same graph as a reload, in every storage") {
+        size_t n = 40;
+        vector<vector<int>> mat(n, vector<int>(n, NO_EDGE));
+        for (Storage storage : {Storage::DENSE, Storage::SPARSE, Storage::BITSET}) {
+            bool unweighted = storage == Storage::BITSET;
+            g.loadEdges(n, {}, storage);
+            mat.assign(n, vector<int>(n, NO_EDGE));
+            bool same = true;
+            for (size_t step = 0; step < 2000; step++) {
+                size_t u = (step * 7 + 3) % n;
+                size_t v = (step * 13 + step / n) % n;
+                if (u == v) {
+                    continue;
+                }
+                int weight = unweighted ? (int)(step % 3 != 0) : (int)(step % 7) - 2;  // some steps remove the edge
+                g.setEdge(u, v, weight);
+                if (step % 3 == 0) {
+                    g.setEdge(v, u, weight);  // keep some pairs symmetric
+                    mat[v][u] = weight;
+                }
+                mat[u][v] = weight;
+
+                if (step % 97 == 0) {
+                    Graph expected;
+                    expected.loadGraph(mat, storage);
+                    same = same && g.getNumEdges() == expected.getNumEdges() && g.isDirectedGraph() == expected.isDirectedGraph() &&
+                           g.isWeightedGraph() == expected.isWeightedGraph() && g.isHaveNegativeEdgeWeight() == expected.isHaveNegativeEdgeWeight();
+                    if (storage == Storage::BITSET) {
+                        same = same && g.getBits() == expected.getBits() && g.getInBits() == expected.getInBits();
+                    } else {
+                        same = same && g.getCSR().targets == expected.getCSR().targets && g.getCSR().weights == expected.getCSR().weights &&
+                               g.getCSR().offsets == expected.getCSR().offsets;
+                        for (size_t w = 0; w < n; w++) {
+                            same = same && g.inNeighbors(w).size() == expected.inNeighbors(w).size();
+                        }
+                    }
+                }
+            }
+            CHECK(same);
+        }
+    }
+
+    SUBCASE("batch") {
+        g.loadEdges(4, {{0, 1, 2}, {1, 2, 3}}, Storage::SPARSE);
+        g.setEdges({{0, 1, NO_EDGE}, {2, 3, 5}, {3, 2, 5}, {2, 3, 6}});  // the last weight of (2, 3) is kept
+        CHECK(g.getCSR().targets == vector<size_t>{2, 3, 2});
+        CHECK(g.getCSR().weights == vector<int>{3, 6, 5});
+        CHECK(g.getNumEdges() == 3);
+
+        // an invalid edge - the graph is not changed
+        CHECK_THROWS_AS(g.setEdges({{0, 1, 1}, {0, 4, 1}}), std::invalid_argument);
+        CHECK(g.getEdgeWeight(0, 1) == NO_EDGE);
+        CHECK(g.getNumEdges() == 3);
+    }
+
+    SUBCASE("invalid edges") {
+        g.loadGraph(vector<vector<int>>{{NO_EDGE, 1}, {1, NO_EDGE}}, Storage::BITSET);
+        CHECK_THROWS_AS(g.setEdge(0, 0, 1), std::invalid_argument);
+        CHECK_THROWS_AS(g.setEdge(0, 2, 1), std::invalid_argument);
+        CHECK_THROWS_AS(g.setEdge(0, 1, 2), std::invalid_argument);
+        CHECK_THROWS_AS(g.getEdgeWeight(2, 0), std::invalid_argument);
+        g.removeEdge(1, 0);
+        CHECK(g.isDirectedGraph() == true);
+        CHECK(g.getInBits().test(1, 0) == true);
+        CHECK(g.getInBits().test(0, 1) == false);
+    }
+}
+
+TEST_CASE("Test const readers on many threads") {
+    // a sparse graph with pending changes: the first reader merges them into the index, the other readers wait for the merge
+    size_t n = 2000;
+    for (size_t round = 0; round < 20; round++) {
+        Graph g;
+        vector<Edge> edges;
+        for (size_t v = 0; v + 1 < n; v++) {
+            edges.push_back({v, v + 1, 1});
+        }
+        g.loadEdges(n, edges, Storage::SPARSE);
+        for (size_t v = 0; v + 2 < n; v += 3) {
+            g.setEdge(v, v + 2, 2);
+            g.setEdge(v + 1, v + 2, NO_EDGE);
+        }
+
+        const Graph& reader = g;
+        vector<size_t> wrong(4, 0);
+        vector<std::thread> threads;
+        for (size_t t = 0; t < wrong.size(); t++) {
+            threads.emplace_back([&reader, &wrong, t, n]() {
+                for (size_t v = 3 * t; v + 2 < n; v += 3 * wrong.size()) {
+                    wrong[t] += (size_t)(reader.getEdgeWeight(v, v + 2) != 2) + (size_t)(reader.getEdgeWeight(v + 1, v + 2) != NO_EDGE);
+                    wrong[t] += (size_t)(reader.neighbors(v).size() != 2);
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        CHECK(std::count(wrong.begin(), wrong.end(), 0) == (std::ptrdiff_t)wrong.size());
+    }
+}
+
+TEST_CASE("Test neighbors") {
+    Graph g;
+    vector<vector<int>> graph = {
+        // clang-format off
+        {NO_EDGE, 3,       -1     },
+        {NO_EDGE, NO_EDGE, 2      },
+        {5,       NO_EDGE, NO_EDGE}
+        // clang-format on
+    };
+
+    for (Storage storage : {Storage::DENSE, Storage::SPARSE}) {
+        g.loadGraph(graph, storage);
+
+        vector<size_t> out;
+        vector<int> outWeights;
+        for (auto [v, weight] : g.neighbors(0)) {
+            out.push_back(v);
+            outWeights.push_back(weight);
+        }
+        CHECK(out == vector<size_t>{1, 2});
+        CHECK(outWeights == vector<int>{3, -1});
+
+        vector<size_t> in;
+        vector<int> inWeights;
+        for (auto [v, weight] : g.inNeighbors(2)) {
+            in.push_back(v);
+            inWeights.push_back(weight);
+        }
+        CHECK(in == vector<size_t>{0, 1});
+        CHECK(inWeights == vector<int>{-1, 2});
+        CHECK(g.inNeighbors(1).size() == 1);
+        CHECK(g.neighbors(1).size() == 1);
+    }
+
+    // the index is updated after the graph is changed
+    g.loadGraph(graph);
+    g = -g;
+    CHECK((*g.neighbors(0).begin()).weight == -3);
+    g = g * 0;
+    CHECK(g.neighbors(0).empty());
+    CHECK(g.inNeighbors(2).empty());
+
+    // for undirected graph the in neighbors are the out neighbors
+    g.loadGraph({{NO_EDGE, 1, 1}, {1, NO_EDGE, NO_EDGE}, {1, NO_EDGE, NO_EDGE}});
+    CHECK(g.inNeighbors(0).size() == 2);
+    CHECK((*g.inNeighbors(0).begin()).vertex == (*g.neighbors(0).begin()).vertex);
+}
+
+TEST_CASE("Test bitset storage") {
+    Graph g;
+    vector<vector<int>> graph = {
+        // clang-format off
+        {NO_EDGE, 1,       1,       NO_EDGE},
+        {NO_EDGE, NO_EDGE, 1,       NO_EDGE},
+        {NO_EDGE, NO_EDGE, NO_EDGE, 1      },
+        {1,       NO_EDGE, NO_EDGE, NO_EDGE}
+        // clang-format on
+    };
+
+    g.loadGraph(graph, Storage::BITSET);
+    CHECK(g.getStorage() == Storage::BITSET);
+    CHECK(g.getNumEdges() == 5);
+    CHECK(g.isDirectedGraph() == true);
+    CHECK(g.isWeightedGraph() == false);
+    CHECK(g.getBits().test(0, 2) == true);
+    CHECK(g.getBits().test(2, 0) == false);
+    CHECK(g.getInBits().test(2, 0) == true);
+
+    stringstream ss;
+    ss << g;
+    CHECK(ss.str() == "[X, 1, 1, X],\n[X, X, 1, X],\n[X, X, X, 1],\n[1, X, X, X]");
+
+    // undirected graph - every edge is counted once, the in bits are the out bits
+    g.loadEdges(3, {{0, 1, 1}, {1, 0, 1}, {1, 2, 1}, {2, 1, 1}}, Storage::BITSET);
+    CHECK(g.getNumEdges() == 2);
+    CHECK(g.isDirectedGraph() == false);
+    CHECK(&g.getInBits() == &g.getBits());
+
+    // more than one word in a row
+    vector<Edge> chain;
+    for (size_t i = 0; i + 1 < 130; i++) {
+        chain.push_back({i, i + 1, 1});
+    }
+    g.loadEdges(130, chain, Storage::BITSET);
+    CHECK(g.getBits().wordsPerRow() == 3);
+    CHECK(g.getNumEdges() == 129);
+    CHECK(g.getBits().test(63, 64) == true);
+    CHECK(g.getInBits().test(128, 127) == true);
+
+    // only unweighted graphs can be stored as bits
+    CHECK_THROWS_AS(g.loadGraph({{NO_EDGE, 2}, {2, NO_EDGE}}, Storage::BITSET), std::invalid_argument);
+    CHECK_THROWS_AS(g.loadEdges(2, {{0, 1, -1}}, Storage::BITSET), std::invalid_argument);
+
+    // the weights and the matrix are not available
+    g.loadGraph(graph, Storage::BITSET);
+    CHECK_THROWS_AS(g.getGraph(), std::logic_error);
+    CHECK_THROWS_AS(g.neighbors(0), std::logic_error);
+    CHECK_THROWS_AS(-g, std::logic_error);
+    CHECK_THROWS_AS(g * g, std::logic_error);
+    g.loadGraph(graph);
+    CHECK_THROWS_AS(g.getBits(), std::logic_error);
+}
+
 TEST_CASE("Test printGraph") {
     // Redirect std::cout to a buffer
     std::stringstream buffer;
@@ -140,7 +804,7 @@ TEST_CASE("Test printGraph") {
 /**
  * helper function to check if the adjacency matrixes are equal
  */
-bool checkMatrixes(const vector<vector<int>>& m1, const vector<vector<int>>& m2, vector<vector<int>>& expected, const function<int(int, int)>& op) {
+bool checkMatrixes(const vector<vector<int>>& m1, const vector<vector<int>>& m2, const vector<vector<int>>& expected, const function<int(int, int)>& op) {
     for (size_t i = 0; i < m1.size(); i++) {
         for (size_t j = 0; j < m1.size(); j++) {
             if (m1[i][j] == NO_EDGE && m2[i][j] == NO_EDGE) {  // if they are both NO_EDGE - the expected value should be NO_EDGE
@@ -1099,6 +1763,40 @@ TEST_CASE("*") {
 
             CHECK_THROWS_AS(g1*g2, std::invalid_argument);
         }
+
+        SUBCASE("big graphs") {
+            // bigger than one block of the product, and with a size that is not a multiple of the row alignment
+            size_t n = 301;
+            graph1.assign(n, vector<int>(n, NO_EDGE));
+            graph2.assign(n, vector<int>(n, NO_EDGE));
+            for (size_t i = 0; i < n; i++) {
+                for (size_t j = 0; j < n; j++) {
+                    if (i != j && (i * 7 + j * 3) % 5 == 0) {
+                        graph1[i][j] = (int)((i + j) % 7) - 3;
+                    }
+                    if (i != j && (i + j * 11) % 4 == 0) {
+                        graph2[i][j] = (int)(i % 5) - 2;
+                    }
+                }
+            }
+
+            // the old i-j-k product
+            expected.assign(n, vector<int>(n, NO_EDGE));
+            for (size_t i = 0; i < n; i++) {
+                for (size_t j = 0; j < n; j++) {
+                    int sum = 0;
+                    for (size_t k = 0; k < n; k++) {
+                        sum += graph1[i][k] * graph2[k][j];
+                    }
+                    expected[i][j] = i == j ? NO_EDGE : sum;
+                }
+            }
+
+            g1.loadGraph(graph1);
+            g2.loadGraph(graph2);
+            g3 = g1 * g2;
+            CHECK(g3.getGraph() == expected);
+        }
     }
 
     SUBCASE("(Graph * int) and (int * Graph)") {
@@ -1229,6 +1927,349 @@ TEST_CASE("*=") {
     }
 }
 
+TEST_CASE("in-place operators") {
+    Graph g1, g2;
+    vector<vector<int>> graph1 = {
+        // clang-format off
+        {NO_EDGE, 1,       -2     },
+        {1,       NO_EDGE, 3      },
+        {-2,      3,       NO_EDGE}
+        // clang-format on
+    };
+    vector<vector<int>> graph2 = {
+        // clang-format off
+        {NO_EDGE, -1,      NO_EDGE},
+        {NO_EDGE, NO_EDGE, 1      },
+        {2,       NO_EDGE, NO_EDGE}
+        // clang-format on
+    };
+    g1.loadGraph(graph1);
+    g2.loadGraph(graph2);
+
+    // the fields are updated after every change
+    g1 += g2;
+    vector<vector<int>> expected = {
+        // clang-format off
+        {NO_EDGE, NO_EDGE, -2     },
+        {1,       NO_EDGE, 4      },
+        {NO_EDGE, 3,       NO_EDGE}
+        // clang-format on
+    };
+    CHECK(g1.getGraph() == expected);
+    CHECK(g1.getNumEdges() == 4);
+    CHECK(g1.isDirectedGraph() == true);
+    CHECK(g1.isHaveNegativeEdgeWeight() == true);
+
+    g1 -= g2;
+    CHECK(g1.getGraph() == graph1);
+    CHECK(g1.getNumEdges() == 3);
+    CHECK(g1.isDirectedGraph() == false);
+
+    // a graph with itself
+    g1 += g1;
+    CHECK(g1.getGraph()[1][2] == 6);
+    g1 -= g1;
+    CHECK(g1.getNumEdges() == 0);
+
+    g1.loadGraph(graph1);
+    Graph squared = g1 * g1;
+    g1 *= g1;
+    CHECK(g1 == squared);
+    CHECK(g1.getNumEdges() == squared.getNumEdges());
+
+    g1.loadGraph(graph1);
+    g1 *= -1;
+    CHECK(g1.isHaveNegativeEdgeWeight() == true);
+    CHECK(g1.getGraph()[0][2] == 2);
+    g1 /= 2;
+    CHECK(g1.getNumEdges() == 2);  // -1 / 2 = 0 - the edge (0, 1) is removed
+    CHECK_THROWS_AS(g1 /= 0, std::invalid_argument);
+
+    // a chain of operators on temporary graphs
+    g1.loadGraph(graph1);
+    Graph g3 = (g1 + g2) * 3 - g2;
+    expected = {
+        // clang-format off
+        {NO_EDGE, 1,       -6     },
+        {3,       NO_EDGE, 11     },
+        {-2,      9,       NO_EDGE}
+        // clang-format on
+    };
+    CHECK(g3.getGraph() == expected);
+    CHECK((-(g1 + g2)).getGraph()[1][2] == -4);
+    CHECK((2 * (g1 - g2)).getGraph()[0][1] == 4);
+    CHECK(g1.getGraph() == graph1);  // the operands are not changed
+
+    // postfix operators return the old graph
+    Graph old = g1++;
+    CHECK(old.getGraph() == graph1);
+    CHECK(g1.getGraph()[0][2] == -1);
+    old = g1--;
+    CHECK(old.getGraph()[0][2] == -1);
+    CHECK(g1.getGraph() == graph1);
+
+    // sparse graphs
+    g1.loadGraph(graph1, Storage::SPARSE);
+    old = g1++;
+    CHECK(old.getCSR().weights == vector<int>{1, -2, 1, 3, -2, 3});
+    CHECK(g1.getCSR().weights == vector<int>{2, -1, 2, 4, -1, 4});
+    g1 *= 0;
+    CHECK(g1.getNumEdges() == 0);
+}
+
+TEST_CASE("lazy expressions") {
+    Graph g1;
+    Graph g2;
+    Graph g3;
+    vector<vector<int>> graph1 = {
+        // clang-format off
+        {NO_EDGE, 1,       -2     },
+        {1,       NO_EDGE, 3      },
+        {-2,      3,       NO_EDGE}
+        // clang-format on
+    };
+    vector<vector<int>> graph2 = {
+        // clang-format off
+        {NO_EDGE, -1,      NO_EDGE},
+        {NO_EDGE, NO_EDGE, 1      },
+        {2,       NO_EDGE, NO_EDGE}
+        // clang-format on
+    };
+    g1.loadGraph(graph1);
+    g2.loadGraph(graph2);
+    g3.loadGraph(graph2);
+
+    // the whole expression is computed in one pass, cell by cell
+    g3 = (g1 + g2) * 3 - g3;
+    vector<vector<int>> expected = {
+        // clang-format off
+        {NO_EDGE, 1,       -6     },
+        {3,       NO_EDGE, 11     },
+        {-2,      9,       NO_EDGE}
+        // clang-format on
+    };
+    CHECK(g3.getGraph() == expected);
+    CHECK(g3.getNumEdges() == 6);
+    CHECK(g3.isDirectedGraph() == true);
+    CHECK(g3.isHaveNegativeEdgeWeight() == true);
+    CHECK(g3.getCSR().weights == vector<int>{1, -6, 3, 11, -2, 9});
+
+    // the target graph is an operand of the expression
+    g3 = g3 - g3;
+    CHECK(g3.getNumEdges() == 0);
+    g3 = g1;
+    g3 = -g3 / 2 + g3;  // -1 / 2 = 0
+    expected = {
+        // clang-format off
+        {NO_EDGE, 1,       -1     },
+        {1,       NO_EDGE, 2      },
+        {-1,      2,       NO_EDGE}
+        // clang-format on
+    };
+    CHECK(g3.getGraph() == expected);
+    CHECK(g3.isDirectedGraph() == false);
+
+    // an expression of a different size
+    Graph small;
+    small.loadGraph(vector<vector<int>>{{NO_EDGE, 4}, {4, NO_EDGE}});
+    g3 = small * 2;
+    CHECK(g3.getNumVertices() == 2);
+    CHECK(g3.getGraph()[0][1] == 8);
+
+    // unary operations on a sparse graph keep the sparse storage
+    g3.loadGraph(graph1, Storage::SPARSE);
+    Graph scaled = -(g3 * 2);
+    CHECK(scaled.getStorage() == Storage::SPARSE);
+    CHECK(scaled.getCSR().weights == vector<int>{-2, 4, -2, -6, 4, -6});
+    CHECK(scaled.getNumEdges() == 3);
+
+    // the errors are thrown where the operator is used
+    CHECK_THROWS_AS(g1 + g3, std::logic_error);
+    CHECK_THROWS_AS(g1 + small, std::invalid_argument);
+    CHECK_THROWS_AS(g1 / 0, std::invalid_argument);
+    g3.loadGraph(vector<vector<int>>{{NO_EDGE, 1}, {NO_EDGE, NO_EDGE}}, Storage::BITSET);
+    CHECK_THROWS_AS(g3 * 2, std::logic_error);
+
+    // an expression where a Graph is needed
+    CHECK(((g1 + g1) * g2).getGraph() == (Graph(g1 * 2) * g2).getGraph());
+    stringstream ss;
+    ss << g1 - g1;
+    CHECK(ss.str() == "[X, X, X],\n[X, X, X],\n[X, X, X]");
+
+    // a temporary graph is moved into the expression, so the expression can be kept after the statement
+    auto make = [&graph1]() {
+        Graph temporary;
+        temporary.loadGraph(graph1);
+        return temporary;
+    };
+    auto kept = make() * 2 + g1;
+    Graph fromKept = kept;
+    CHECK(fromKept.getGraph() == (g1 * 3).getGraph());
+    auto negated = -make();
+    CHECK(Graph(negated).getGraph()[0][2] == 2);
+
+    // the queries and the comparisons of Graph work on expressions
+    CHECK((g1 * 2).getNumVertices() == 3);
+    CHECK((g1 - g1).getNumEdges() == 0);
+    CHECK((g1 * 2).getEdgeWeight(1, 2) == 6);
+    CHECK((g1 * 2).isHaveNegativeEdgeWeight() == true);
+    Graph empty = g1 - g1;
+    Graph doubled = g1 * 2;
+    CHECK((g1 * 2) == g1 + g1);
+    CHECK((g1 != g1 * 2) == (g1 != doubled));
+    CHECK(((g1 - g1) < g1) == (empty < g1));
+    CHECK(((g1 - g1) < g1) == true);
+    CHECK(((g1 - g1) <= g1 * 2) == (empty <= doubled));
+    CHECK((g1 >= (g1 - g1)) == (g1 >= empty));
+    CHECK(((g1 - g1) > g1) == (empty > g1));
+}
+
+TEST_CASE("power") {
+    Graph g;
+    vector<vector<int>> triangle = {
+        // clang-format off
+        {NO_EDGE, 1,       1      },
+        {1,       NO_EDGE, 1      },
+        {1,       1,       NO_EDGE}
+        // clang-format on
+    };
+    g.loadGraph(triangle);
+
+    CHECK(g.power(1).getGraph() == triangle);
+    CHECK(g.power(2).getGraph() == (g * g).getGraph());
+
+    // the number of walks of length 3 between two different vertices of a triangle is 3 (g * g * g clears the diagonal after every product)
+    vector<vector<int>> expected = {
+        // clang-format off
+        {NO_EDGE, 3,       3      },
+        {3,       NO_EDGE, 3      },
+        {3,       3,       NO_EDGE}
+        // clang-format on
+    };
+    CHECK(g.power(3).getGraph() == expected);
+    CHECK(g.power(3).isWeightedGraph() == true);
+
+    // the number of walks of length k in a triangle between two different vertices is (2^k - (-1)^k) / 3
+    CHECK(g.power(10).getGraph()[0][1] == 341);
+    CHECK(g.power(11).getGraph()[2][0] == 683);
+
+    // weighted directed graph - compare with products that keep the diagonal
+    vector<vector<int>> graph = {
+        // clang-format off
+        {NO_EDGE, 2,       NO_EDGE, -1     },
+        {NO_EDGE, NO_EDGE, 3,       NO_EDGE},
+        {1,       NO_EDGE, NO_EDGE, 2      },
+        {NO_EDGE, 1,       NO_EDGE, NO_EDGE}
+        // clang-format on
+    };
+    g.loadGraph(graph);
+    vector<vector<int>> walks = graph;
+    for (int k = 2; k <= 5; k++) {
+        vector<vector<int>> next(4, vector<int>(4, 0));
+        for (size_t i = 0; i < 4; i++) {
+            for (size_t j = 0; j < 4; j++) {
+                for (size_t l = 0; l < 4; l++) {
+                    next[i][j] += walks[i][l] * graph[l][j];
+                }
+            }
+        }
+        walks = next;
+    }
+    for (size_t i = 0; i < 4; i++) {
+        walks[i][i] = NO_EDGE;
+    }
+    CHECK(g.power(5).getGraph() == walks);
+
+    CHECK_THROWS_AS(g.power(0), std::invalid_argument);
+    g.loadGraph(graph, Storage::SPARSE);
+    CHECK_THROWS_AS(g.power(2), std::logic_error);
+}
+
+TEST_CASE("reachabilityPower") {
+    Graph g;
+
+    // a directed cycle of 4 vertices: there is a walk of length k from u to (u + k) % 4
+    g.loadEdges(4, {{0, 1, 5}, {1, 2, -3}, {2, 3, 1}, {3, 0, 2}});
+    Graph reach = g.reachabilityPower(2);
+    CHECK(reach.getStorage() == Storage::BITSET);
+    CHECK(reach.isWeightedGraph() == false);
+    CHECK(reach.getNumEdges() == 2);  // 0<->2 and 1<->3
+    CHECK(reach.isDirectedGraph() == false);
+    CHECK(reach.getBits().test(0, 2) == true);
+    CHECK(reach.getBits().test(3, 1) == true);
+    CHECK(reach.getBits().test(0, 1) == false);
+
+    // after 4 edges every walk is back at its start, and the diagonal is NO_EDGE
+    CHECK(g.reachabilityPower(4).getNumEdges() == 0);
+    CHECK(g.reachabilityPower(5).getBits() == g.reachabilityPower(1).getBits());
+    CHECK(g.reachabilityPower(1).getBits().test(1, 2) == true);
+
+    // the same edges as power(k) on a graph with non-negative weights, in all the storages
+    vector<vector<int>> graph(70, vector<int>(70, NO_EDGE));
+    for (size_t i = 0; i < 70; i++) {
+        graph[i][(i * 3 + 1) % 70] = 1;
+        graph[i][(i + 7) % 70] = 2;
+    }
+    g.loadGraph(graph);
+    Matrix walks(g.power(6).getGraph());
+    for (Storage storage : {Storage::DENSE, Storage::SPARSE}) {
+        g.loadGraph(graph, storage);
+        reach = g.reachabilityPower(6);
+        bool same = true;
+        for (size_t i = 0; i < 70; i++) {
+            for (size_t j = 0; j < 70; j++) {
+                same = same && reach.getBits().test(i, j) == (walks[i][j] != NO_EDGE);
+            }
+        }
+        CHECK(same);
+    }
+
+    CHECK_THROWS_AS(g.reachabilityPower(0), std::invalid_argument);
+}
+
+TEST_CASE("minPlus") {
+    // the distance product of two matrices with negative and infinite cells, compared with the simple product
+    size_t n = 37;
+    Matrix a(n, Matrix::NO_PATH);
+    Matrix b(n, Matrix::NO_PATH);
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < n; j++) {
+            if ((i + 2 * j) % 3 != 0) {
+                a[i][j] = (int)((i * 5 + j) % 11) - 3;
+            }
+            if ((i * j) % 4 != 1) {
+                b[i][j] = (int)((i + j * 3) % 13) - 2;
+            }
+        }
+    }
+
+    Matrix result;
+    minPlus(a, b, &result);
+    bool same = true;
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < n; j++) {
+            int expected = Matrix::NO_PATH;
+            for (size_t k = 0; k < n; k++) {
+                if (a[i][k] != Matrix::NO_PATH && b[k][j] != Matrix::NO_PATH) {
+                    expected = std::min(expected, a[i][k] + b[k][j]);
+                }
+            }
+            same = same && result[i][j] == expected;
+        }
+    }
+    CHECK(same);
+
+    // a row with no finite cells gives a row of NO_PATH
+    for (size_t j = 0; j < n; j++) {
+        a[0][j] = Matrix::NO_PATH;
+    }
+    minPlus(a, b, &result);
+    CHECK(std::all_of(result[0].begin(), result[0].end(), [](int cell) { return cell == Matrix::NO_PATH; }));
+
+    CHECK_THROWS_AS(minPlus(a, Matrix(n + 1), &result), std::invalid_argument);
+    CHECK_THROWS_AS(minPlus(a, b, &a), std::invalid_argument);
+}
+
 TEST_CASE("==") {
     SUBCASE("undirected graph") {
         SUBCASE("simple equal graphs") {
@@ -1488,4 +2529,81 @@ TEST_CASE("<<") {
 
         CHECK(ss.str() == expected);
     }
+
+    SUBCASE("a big graph in all the storages") {
+        // more than one block of text, with the longest numbers
+        size_t n = 700;
+        vector<vector<int>> graph(n, vector<int>(n, NO_EDGE));
+        vector<vector<int>> unweighted = graph;
+        for (size_t i = 0; i < n; i++) {
+            for (size_t j = 0; j < n; j++) {
+                if (i != j && (i * 7 + j * 3) % 5 == 0) {
+                    graph[i][j] = (i + j) % 11 == 0 ? std::numeric_limits<int>::min() : (int)(i * 31 + j) - 9000;
+                    unweighted[i][j] = 1;
+                }
+            }
+        }
+        graph[0][1] = std::numeric_limits<int>::max();
+
+        for (const vector<vector<int>>& matrix : {graph, unweighted}) {
+            stringstream expected;  // the format of printAdjMat, with the operators of the stream
+            for (size_t i = 0; i < n; i++) {
+                expected << "[";
+                for (size_t j = 0; j < n; j++) {
+                    if (matrix[i][j] != NO_EDGE) {
+                        expected << matrix[i][j];
+                    } else {
+                        expected << "X";
+                    }
+                    expected << (j != n - 1 ? ", " : "");
+                }
+                expected << (i != n - 1 ? "],\n" : "]");
+            }
+
+            for (Storage storage : {Storage::DENSE, Storage::SPARSE, Storage::BITSET}) {
+                if (storage == Storage::BITSET && matrix == graph) {
+                    continue;
+                }
+                Graph g;
+                g.loadGraph(matrix, storage);
+                stringstream ss;
+                ss << g;
+                CHECK(ss.str() == expected.str());
+            }
+        }
+    }
+}
+
+TEST_CASE("printEdges") {
+    Graph g;
+    g.loadEdges(4, {{2, 0, 4}, {0, 3, -1}, {0, 1, 2}, {3, 2, 1}}, Storage::DENSE);
+    stringstream ss;
+    g.printEdges(ss);
+    CHECK(ss.str() == "0 1 2\n0 3 -1\n2 0 4\n3 2 1\n");
+
+    g.loadEdges(3, {{0, 1, 1}, {1, 0, 1}}, Storage::BITSET);
+    ss.str("");
+    g.printEdges(ss);
+    CHECK(ss.str() == "0 1 1\n1 0 1\n");
+
+    g.loadEdges(0, {});
+    ss.str("");
+    g.printEdges(ss);
+    CHECK(ss.str().empty());
+
+    // the output of printEdges can be loaded with loadEdgeList
+    const char* path = "GraphTest.txt";
+    g.loadEdges(300, {});
+    for (size_t u = 0; u < 300; u++) {
+        g.setEdge(u, (u * 17 + 1) % 300, (int)u - 150 == 0 ? 1 : (int)u - 150);
+    }
+    {
+        std::ofstream out(path);
+        g.printEdges(out);
+    }
+    Graph loaded;
+    loaded.loadEdgeList(path);
+    CHECK(loaded.getCSR().targets == g.getCSR().targets);
+    CHECK(loaded.getCSR().weights == g.getCSR().weights);
+    std::remove(path);
 }
\ No newline at end of file
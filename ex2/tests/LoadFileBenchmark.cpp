@@ -0,0 +1,110 @@
+/**
+ * @author Shay Gali
+ * @link shay.gali@msmail.ariel.ac.il
+ *
+ * the startup time of a big graph: parsing a text edge list with operator>> (then loadEdges), Graph::loadEdgeList on the same file
+ * (std::from_chars on all the cores, straight into the storage), and Graph::loadFile on the binary file of the same graph (mmap, nothing is parsed).
+ * the loaded graphs are compared to the original graphs.
+ *
+ * usage: ./LoadFileBenchmark [|V| of the sparse graph]   (default 1000000, with 8 edges per vertex)
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../graph/Graph.hpp"
+#include "Benchmark.hpp"
+
+using namespace shayg;
+using std::string;
+using std::vector;
+
+// random directed graph with `degree` out edges for every vertex, weights in [1, 100]
+vector<Edge> randomEdges(size_t n, size_t degree, bench::Random* random) {
+    vector<Edge> edges;
+    vector<bool> used(n, false);
+    vector<size_t> row;
+    for (size_t u = 0; u < n; u++) {
+        row.clear();
+        while (row.size() < degree && row.size() + 1 < n) {
+            size_t v = random->below(n);
+            if (v != u && !used[v]) {
+                used[v] = true;
+                row.push_back(v);
+            }
+        }
+        for (size_t v : row) {
+            used[v] = false;
+            edges.push_back({u, v, (int)random->below(100) + 1});
+        }
+    }
+    return edges;
+}
+
+void writeText(const string& path, size_t n, const vector<Edge>& edges) {
+    std::ofstream out(path);
+    out << "# " << n << " " << edges.size() << "\n";  // a comment for loadEdgeList
+    for (const Edge& e : edges) {
+        out << e.from << " " << e.to << " " << e.weight << "\n";
+    }
+}
+
+// the old way to start - read the text file and load the edges
+Graph parseText(const string& path, Storage storage) {
+    std::ifstream in(path);
+    char hash = 0;
+    size_t n = 0;
+    size_t count = 0;
+    in >> hash >> n >> count;
+    vector<Edge> edges(count);
+    for (Edge& e : edges) {
+        in >> e.from >> e.to >> e.weight;
+    }
+    Graph g;
+    g.loadEdges(n, edges, storage);
+    return g;
+}
+
+bool sameGraph(const Graph& a, const Graph& b) {
+    return a.getNumEdges() == b.getNumEdges() && a.isDirectedGraph() == b.isDirectedGraph() && a.getCSR().offsets == b.getCSR().offsets &&
+           a.getCSR().targets == b.getCSR().targets && a.getCSR().weights == b.getCSR().weights;
+}
+
+int main(int argc, char** argv) {
+    size_t sparseVertices = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    bench::Random random;
+    const string textPath = "LoadFileBenchmark.txt";
+    const string binaryPath = "LoadFileBenchmark.bin";
+    bool allSame = true;
+
+    std::cout << "graph\t\t\toperator>> (ms)\tloadEdgeList (ms)\tloadFile (ms)" << std::endl;
+    struct Case {
+        const char* name;
+        size_t n;
+        size_t degree;
+        Storage storage;
+    };
+    for (Case c : {Case{"dense 4096 x 4096", 4096, 2048, Storage::DENSE}, Case{"sparse |E| = 8|V|", sparseVertices, 8, Storage::SPARSE}}) {
+        vector<Edge> edges = randomEdges(c.n, c.degree, &random);
+        writeText(textPath, c.n, edges);
+        Graph original;
+        original.loadEdges(c.n, edges, c.storage);
+        original.saveFile(binaryPath);
+
+        Graph parsed;
+        Graph streamed;
+        Graph loaded;
+        double textMs = bench::bestOf(1, [&]() { parsed = parseText(textPath, c.storage); });
+        double streamMs = bench::bestOf(3, [&]() { streamed.loadEdgeList(textPath, c.storage); });
+        double fileMs = bench::bestOf(3, [&]() { loaded.loadFile(binaryPath); });
+        bool same = sameGraph(parsed, original) && sameGraph(streamed, original) && sameGraph(loaded, original);
+        allSame &= same;
+        std::cout << c.name << "\t" << textMs << "\t\t" << streamMs << "\t\t\t" << fileMs << (same ? "" : "\tDIFFERENT GRAPHS") << std::endl;
+    }
+    std::remove(textPath.c_str());
+    std::remove(binaryPath.c_str());
+    return allSame ? 0 : 1;
+}
@@ -0,0 +1,83 @@
+/**
+ * @author Shay Gali
+ * @link shay.gali@msmail.ariel.ac.il
+ *
+ * Graph::operator* (blocked, AVX2 and multithreaded) against the old implementation
+ * (i-j-k loop on vector<vector<int>> with a NO_EDGE check in the inner loop).
+ * the results of the two implementations are compared on every size.
+ *
+ * usage: ./MultiplyBenchmark [max |V|]   (default 2048 - the old implementation takes a few seconds on this size)
+ */
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "../graph/Graph.hpp"
+#include "Benchmark.hpp"
+
+using namespace shayg;
+using std::vector;
+
+// the old Graph::operator*
+vector<vector<int>> multiplyOld(const vector<vector<int>>& adjMat, const vector<vector<int>>& other) {
+    size_t n = adjMat.size();
+    vector<vector<int>> result(n, vector<int>(n, NO_EDGE));
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < n; j++) {
+            if (i == j) {  // the diagonal of the matrix must be NO_EDGE
+                continue;
+            }
+            int sum = 0;
+            for (size_t k = 0; k < n; k++) {
+                if (adjMat[i][k] != NO_EDGE && other[k][j] != NO_EDGE) {
+                    sum += adjMat[i][k] * other[k][j];
+                }
+            }
+            result[i][j] = sum != 0 ? sum : NO_EDGE;
+        }
+    }
+    return result;
+}
+
+// random directed graph with the given density (in percent) and weights in [-9, 9]
+vector<vector<int>> randomGraph(size_t n, size_t density, bench::Random* random) {
+    vector<vector<int>> graph(n, vector<int>(n, NO_EDGE));
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < n; j++) {
+            if (i != j && random->below(100) < density) {
+                graph[i][j] = (int)random->below(19) - 9;
+            }
+        }
+    }
+    return graph;
+}
+
+int main(int argc, char** argv) {
+    size_t maxVertices = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2048;
+    bench::Random random;
+
+    std::cout << "threads: " << std::thread::hardware_concurrency() << std::endl;
+    std::cout << "|V|\tdensity\told (ms)\tnew (ms)\tspeedup" << std::endl;
+    for (size_t n = 256; n <= maxVertices; n *= 2) {
+        for (size_t density : {size_t{5}, size_t{50}}) {
+            vector<vector<int>> mat1 = randomGraph(n, density, &random);
+            vector<vector<int>> mat2 = randomGraph(n, density, &random);
+            Graph g1;
+            Graph g2;
+            g1.loadGraph(mat1);
+            g2.loadGraph(mat2);
+
+            vector<vector<int>> expected;
+            Graph product;
+            double oldMs = bench::bestOf(1, [&]() { expected = multiplyOld(mat1, mat2); });
+            double newMs = bench::bestOf(3, [&]() { product = g1 * g2; });
+            if (product.getGraph() != expected) {
+                std::cerr << "the results are different on |V| = " << n << std::endl;
+                return 1;
+            }
+            std::cout << n << "\t" << density << "%\t" << oldMs << "\t\t" << newMs << "\t\t" << oldMs / newMs << "x" << std::endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,91 @@
+/**
+ * @author Shay Gali
+ * @link shay.gali@msmail.ariel.ac.il
+ *
+ * the time of one Algorithms::shortestPath query (random src and dest) in the three search modes: the full BFS/Dijkstra tree of src,
+ * the early exit when dest is settled, and the bidirectional search. the early exit paths are compared to the full paths,
+ * and the lengths of the bidirectional paths are compared to the lengths of the full paths.
+ *
+ * usage: ./PathQueryBenchmark [|V|] [queries]   (default 1000000 vertices with 4 out edges, 20 queries)
+ */
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../algorithms/Algorithms.hpp"
+#include "../graph/Graph.hpp"
+#include "Benchmark.hpp"
+
+using namespace shayg;
+using std::string;
+using std::vector;
+using Mode = Algorithms::SearchMode;
+
+// random directed graph with 4 out edges for every vertex, weights in [1, maxWeight]
+vector<Edge> randomEdges(size_t n, int maxWeight, bench::Random* random) {
+    vector<Edge> edges;
+    vector<bool> used(n, false);
+    vector<size_t> row;
+    for (size_t u = 0; u < n; u++) {
+        row.clear();
+        while (row.size() < 4 && row.size() + 1 < n) {
+            size_t v = random->below(n);
+            if (v != u && !used[v]) {
+                used[v] = true;
+                row.push_back(v);
+            }
+        }
+        for (size_t v : row) {
+            used[v] = false;
+            edges.push_back({u, v, (int)random->below((size_t)maxWeight) + 1});
+        }
+    }
+    return edges;
+}
+
+// the length of a path in the format of shortestPath
+long pathLength(const Graph& g, const string& path) {
+    std::istringstream in(path);
+    long length = 0;
+    size_t u = 0;
+    size_t v = 0;
+    in >> u;
+    while (in.ignore(2) >> v) {
+        length += g.getEdgeWeight(u, v);
+        u = v;
+    }
+    return length;
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    size_t queries = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 20;
+    bench::Random random;
+    bool allSame = true;
+
+    std::cout << "graph\t\tfull (ms)\tearly exit (ms)\tbidirectional (ms)\tspeedup" << std::endl;
+    for (int maxWeight : {1, 100, 1000000}) {
+        Graph g;
+        g.loadEdges(n, randomEdges(n, maxWeight, &random), Storage::SPARSE);
+
+        double totals[3] = {0, 0, 0};
+        for (size_t q = 0; q < queries; q++) {
+            size_t src = random.below(n);
+            size_t dest = random.below(n);
+            string paths[3];
+            Mode modes[3] = {Mode::FULL, Mode::EARLY_EXIT, Mode::BIDIRECTIONAL};
+            for (size_t m = 0; m < 3; m++) {
+                totals[m] += bench::bestOf(1, [&]() { paths[m] = Algorithms::shortestPath(g, src, dest, modes[m]); });
+            }
+            allSame &= paths[1] == paths[0] && pathLength(g, paths[2]) == pathLength(g, paths[0]);
+        }
+        std::cout << (maxWeight == 1 ? "unweighted" : "weights 1.." + std::to_string(maxWeight)) << "\t" << totals[0] / queries << "\t\t"
+                  << totals[1] / queries << "\t\t" << totals[2] / queries << "\t\t\t" << totals[0] / totals[2] << "x" << std::endl;
+    }
+    if (!allSame) {
+        std::cerr << "the paths are different" << std::endl;
+    }
+    return allSame ? 0 : 1;
+}
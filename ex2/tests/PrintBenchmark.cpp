@@ -0,0 +1,88 @@
+/**
+ * @author Shay Gali
+ * @link shay.gali@msmail.ariel.ac.il
+ *
+ * Graph::printAdjMat (std::to_chars into a buffer, written in blocks) against the old implementation
+ * (operator<< on every cell and every separator). the two outputs are compared on every size.
+ * the text is written to /dev/null, so the time is the formatting and not the disk.
+ *
+ * usage: ./PrintBenchmark [max |V|]   (default 8192)
+ */
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "../graph/Graph.hpp"
+#include "Benchmark.hpp"
+
+using namespace shayg;
+using std::vector;
+
+// the old Graph::printAdjMat
+void printOld(const Matrix& mat, std::ostream& out) {
+    size_t n = mat.size();
+    for (size_t i = 0; i < n; i++) {
+        out << "[";
+        for (size_t j = 0; j < n; j++) {
+            if (mat[i][j] != NO_EDGE) {
+                out << mat[i][j];
+            } else {
+                out << "X";
+            }
+            if (j != n - 1) {
+                out << ", ";
+            }
+        }
+        if (i != n - 1) {
+            out << "]," << '\n';
+        } else {
+            out << "]";
+        }
+    }
+}
+
+// random directed graph with half of the cells set, weights in [-999, 999]
+vector<vector<int>> randomGraph(size_t n, bench::Random* random) {
+    vector<vector<int>> graph(n, vector<int>(n, NO_EDGE));
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < n; j++) {
+            if (i != j && random->below(2) == 0) {
+                graph[i][j] = (int)random->below(1999) - 999;
+            }
+        }
+    }
+    return graph;
+}
+
+int main(int argc, char** argv) {
+    size_t maxVertices = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 8192;
+    bench::Random random;
+    std::ofstream null("/dev/null");
+
+    std::cout << "threads: " << std::thread::hardware_concurrency() << std::endl;
+    std::cout << "|V|\told (ms)\tnew (ms)\tspeedup" << std::endl;
+    for (size_t n = 1024; n <= maxVertices; n *= 2) {
+        Graph g;
+        g.loadGraph(randomGraph(n, &random));
+
+        // the outputs are compared on the smallest size (a string of the biggest matrix takes too much memory)
+        if (n == 1024) {
+            std::ostringstream oldText;
+            std::ostringstream newText;
+            printOld(g.getGraph(), oldText);
+            g.printAdjMat(newText);
+            if (oldText.str() != newText.str()) {
+                std::cerr << "the outputs are different on |V| = " << n << std::endl;
+                return 1;
+            }
+        }
+
+        double oldMs = bench::bestOf(1, [&]() { printOld(g.getGraph(), null); });
+        double newMs = bench::bestOf(3, [&]() { g.printAdjMat(null); });
+        std::cout << n << "\t" << oldMs << "\t\t" << newMs << "\t\t" << oldMs / newMs << "x" << std::endl;
+    }
+    return 0;
+}
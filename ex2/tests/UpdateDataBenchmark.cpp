@@ -0,0 +1,86 @@
+/**
+ * @author Shay Gali
+ * @link shay.gali@msmail.ariel.ac.il
+ *
+ * The matrix scan of Graph::updateData (count the edges, check the weights and check if the matrix is symmetric),
+ * on the old layout (vector<vector<int>>, one allocation per row) and on the flat Matrix layout.
+ *
+ * usage: ./UpdateDataBenchmark [max |V|]   (default 16384 - needs ~2GB of memory for the two matrices)
+ */
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "../graph/Graph.hpp"
+#include "Benchmark.hpp"
+
+using namespace shayg;
+using std::vector;
+
+struct ScanResult {
+    size_t numEdges;
+    bool isDirected;
+    bool isWeighted;
+    bool haveNegativeEdgeWeight;
+};
+
+// the scan of the old updateData, on vector<vector<int>>
+ScanResult scanNested(const vector<vector<int>>& adjMat) {
+    ScanResult res{0, false, false, false};
+    for (size_t i = 0; i < adjMat.size(); i++) {
+        for (size_t j = 0; j < adjMat.size(); j++) {
+            if (adjMat[i][j] != NO_EDGE) {
+                res.numEdges++;
+                res.isWeighted |= adjMat[i][j] != 1;
+                res.haveNegativeEdgeWeight |= adjMat[i][j] < 0;
+                res.isDirected |= adjMat[i][j] != adjMat[j][i];
+            }
+        }
+    }
+    return res;
+}
+
+// the same scan on the flat matrix - the rows are read with a pointer, and the symmetry check reads the transposed cell with the stride
+ScanResult scanFlat(const Matrix& adjMat) {
+    ScanResult res{0, false, false, false};
+    const int* cells = adjMat.data();
+    size_t stride = adjMat.stride();
+    for (size_t i = 0; i < adjMat.size(); i++) {
+        const int* row = cells + i * stride;
+        for (size_t j = 0; j < adjMat.size(); j++) {
+            if (row[j] != NO_EDGE) {
+                res.numEdges++;
+                res.isWeighted |= row[j] != 1;
+                res.haveNegativeEdgeWeight |= row[j] < 0;
+                res.isDirected |= row[j] != cells[j * stride + i];
+            }
+        }
+    }
+    return res;
+}
+
+int main(int argc, char** argv) {
+    size_t maxVertices = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 16384;
+    bench::Random random;
+
+    std::cout << "|V|\tnested (ms)\tflat (ms)\tspeedup" << std::endl;
+    for (size_t n = 1024; n <= maxVertices; n *= 2) {
+        // random undirected graph with ~10% density
+        Matrix flat(n, NO_EDGE);
+        for (size_t i = 0; i < n; i++) {
+            for (size_t j = i + 1; j < n; j++) {
+                if (random.below(10) == 0) {
+                    int weight = (int)random.below(100) + 1;
+                    flat[i][j] = weight;
+                    flat[j][i] = weight;
+                }
+            }
+        }
+        vector<vector<int>> nested = flat;
+
+        double nestedMs = bench::bestOf(3, [&]() { bench::keep(scanNested(nested)); });
+        double flatMs = bench::bestOf(3, [&]() { bench::keep(scanFlat(flat)); });
+        std::cout << n << "\t" << nestedMs << "\t\t" << flatMs << "\t\t" << nestedMs / flatMs << "x" << std::endl;
+    }
+    return 0;
+}
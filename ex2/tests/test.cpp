@@ -2,10 +2,16 @@
  * @author Shay Gali
  * @link shay.gali@msmail.ariel.ac.il
  */
+#include <algorithm>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <queue>
 #include <sstream>
 #include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
 #include "../algorithms/Algorithms.hpp"
@@ -744,7 +750,7 @@ TEST_CASE("Test negativeCycle for directed graph") {
     };
 
     g.loadGraph(graph2);
-    CHECK(Algorithms::negativeCycle(g) == "3->4->2->3");
+    CHECK(Algorithms::negativeCycle(g) == "2->3->4->2");
 }
 
 TEST_CASE("Test negativeCycle for undirected graph") {
@@ -765,3 +771,1032 @@ TEST_CASE("Test negativeCycle for undirected graph") {
     g.loadGraph(graph1);
     CHECK(Algorithms::negativeCycle(g) == "No negative cycle");
 }
+
+TEST_CASE("Test algorithms on sparse graph") {
+    Graph g;
+
+    /*
+    0-->1-->2-->3, 3-->1 and 4 is not connected
+    */
+    vector<Edge> edges = {{0, 1, 1}, {1, 2, 1}, {2, 3, 1}, {3, 1, 1}};
+    g.loadEdges(5, edges);
+    CHECK(Algorithms::isConnected(g) == false);
+    CHECK(Algorithms::shortestPath(g, 0, 3) == "0->1->2->3");
+    CHECK(Algorithms::shortestPath(g, 0, 4) == "-1");
+    CHECK(Algorithms::isContainsCycle(g) == "1->2->3->1");
+    CHECK(Algorithms::isBipartite(g) == "The graph is not bipartite");
+
+    edges.push_back({4, 0, 1});
+    g.loadEdges(5, edges);
+    CHECK(Algorithms::isConnected(g) == true);
+
+    // weighted graph - dijkstra
+    g.loadEdges(4, {{0, 1, 100}, {0, 2, 30}, {2, 3, 25}, {3, 1, 1}});
+    CHECK(Algorithms::shortestPath(g, 0, 1) == "0->2->3->1");
+    CHECK(Algorithms::isBipartite(g) == "The graph is bipartite: A={0,3}, B={1,2}");
+
+    // negative weights - bellman-ford
+    g.loadEdges(3, {{0, 1, -1}, {1, 2, -1}, {2, 0, 1}});
+    CHECK(Algorithms::negativeCycle(g) == "0->1->2->0");
+    g.loadEdges(3, {{0, 1, -1}, {1, 2, -1}, {2, 0, 3}});
+    CHECK(Algorithms::negativeCycle(g) == "No negative cycle");
+    CHECK(Algorithms::shortestPath(g, 0, 2) == "0->1->2");
+}
+
+TEST_CASE("Test algorithms on bitset graph") {
+    Graph g;
+
+    /*
+    0-->1-->2-->3, 3-->1 and 4 is not connected
+    */
+    vector<Edge> edges = {{0, 1, 1}, {1, 2, 1}, {2, 3, 1}, {3, 1, 1}};
+    g.loadEdges(5, edges, Storage::BITSET);
+    CHECK(Algorithms::isConnected(g) == false);
+    CHECK(Algorithms::shortestPath(g, 0, 3) == "0->1->2->3");
+    CHECK(Algorithms::shortestPath(g, 0, 4) == "-1");
+    CHECK(Algorithms::isContainsCycle(g) == "1->2->3->1");
+    CHECK(Algorithms::isBipartite(g) == "The graph is not bipartite");
+    CHECK(Algorithms::negativeCycle(g) == "No negative cycle");
+
+    edges.push_back({4, 0, 1});
+    g.loadEdges(5, edges, Storage::BITSET);
+    CHECK(Algorithms::isConnected(g) == true);
+
+    // the same results as the dense graph
+    vector<vector<int>> graph = {
+        // clang-format off
+        {NO_EDGE, 1,       NO_EDGE, 1,       NO_EDGE},
+        {1,       NO_EDGE, 1,       NO_EDGE, NO_EDGE},
+        {NO_EDGE, 1,       NO_EDGE, 1,       1      },
+        {1,       NO_EDGE, 1,       NO_EDGE, NO_EDGE},
+        {NO_EDGE, NO_EDGE, 1,       NO_EDGE, NO_EDGE}
+        // clang-format on
+    };
+    Graph dense;
+    dense.loadGraph(graph);
+    g.loadGraph(graph, Storage::BITSET);
+    CHECK(Algorithms::isConnected(g) == Algorithms::isConnected(dense));
+    CHECK(Algorithms::shortestPath(g, 0, 4) == Algorithms::shortestPath(dense, 0, 4));
+    CHECK(Algorithms::isContainsCycle(g) == Algorithms::isContainsCycle(dense));
+    CHECK(Algorithms::isBipartite(g) == Algorithms::isBipartite(dense));
+
+    // a long chain (more than one word in a row) - no cycle, and the path goes through all the vertices
+    vector<Edge> chain;
+    for (size_t i = 0; i + 1 < 200; i++) {
+        chain.push_back({i, i + 1, 1});
+        chain.push_back({i + 1, i, 1});
+    }
+    g.loadEdges(200, chain, Storage::BITSET);
+    CHECK(Algorithms::isConnected(g) == true);
+    CHECK(Algorithms::isContainsCycle(g) == "-1");
+    CHECK(Algorithms::shortestPath(g, 0, 199).size() > 199 * 3);
+    CHECK(Algorithms::isBipartite(g).rfind("The graph is bipartite: A={0,2,4,", 0) == 0);
+
+    chain.push_back({199, 0, 1});
+    chain.push_back({0, 199, 1});
+    g.loadEdges(200, chain, Storage::BITSET);
+    CHECK(Algorithms::isContainsCycle(g) != "-1");
+    CHECK(Algorithms::shortestPath(g, 0, 199) == "0->199");
+}
+
+TEST_CASE("Test allPairsShortestPaths") {
+    Graph g;
+
+    vector<vector<int>> graph = {
+        // clang-format off
+        {NO_EDGE, 4,       1,       NO_EDGE, NO_EDGE},
+        {NO_EDGE, NO_EDGE, NO_EDGE, 1,       NO_EDGE},
+        {NO_EDGE, 2,       NO_EDGE, 5,       NO_EDGE},
+        {NO_EDGE, NO_EDGE, NO_EDGE, NO_EDGE, 3      },
+        {NO_EDGE, NO_EDGE, NO_EDGE, NO_EDGE, NO_EDGE}
+        // clang-format on
+    };
+    g.loadGraph(graph);
+    Algorithms::DistanceTable table = Algorithms::allPairsShortestPaths(g);
+    CHECK(table.size() == 5);
+    CHECK(table.distance(0, 4) == 7);
+    CHECK(table.path(0, 4) == "0->2->1->3->4");
+    CHECK(table.pathVertices(2, 4) == vector<size_t>{2, 1, 3, 4});
+    CHECK(table.path(3, 3) == "3");
+    CHECK(table.distance(4, 0) == INF);
+    CHECK(table.hasPath(4, 0) == false);
+    CHECK(table.path(4, 0) == "-1");
+    CHECK(table.pathVertices(4, 0).empty());
+    for (size_t u = 0; u < 5; u++) {
+        for (size_t v = 0; v < 5; v++) {
+            CHECK(table.path(u, v) == Algorithms::shortestPath(g, u, v));
+        }
+    }
+    CHECK_THROWS_AS(table.distance(0, 5), std::invalid_argument);
+
+    // negative edges without a negative cycle, in sparse storage
+    g.loadEdges(4, {{0, 1, 5}, {0, 2, 2}, {2, 1, -4}, {1, 3, 1}});
+    table = Algorithms::allPairsShortestPaths(g);
+    CHECK(table.distance(0, 3) == -1);
+    CHECK(table.path(0, 3) == "0->2->1->3");
+
+    // unweighted graph in bitset storage
+    g.loadEdges(4, {{0, 1, 1}, {1, 2, 1}, {2, 3, 1}, {3, 0, 1}}, Storage::BITSET);
+    table = Algorithms::allPairsShortestPaths(g);
+    CHECK(table.distance(1, 0) == 3);
+    CHECK(table.path(2, 1) == "2->3->0->1");
+
+    // negative cycle
+    g.loadEdges(3, {{0, 1, -1}, {1, 2, -1}, {2, 0, 1}});
+    CHECK_THROWS_AS(Algorithms::allPairsShortestPaths(g), Algorithms::NegativeCycleException);
+
+    // undirected graph with a negative edge
+    g.loadGraph({{NO_EDGE, -1}, {-1, NO_EDGE}});
+    CHECK_THROWS_AS(Algorithms::allPairsShortestPaths(g), std::invalid_argument);
+
+    // a bigger graph (more than one block of Floyd-Warshall) - compare with the simple Floyd-Warshall, and check the weights of the paths
+    size_t n = 150;
+    graph.assign(n, vector<int>(n, NO_EDGE));
+    for (size_t i = 0; i < n; i++) {
+        graph[i][(i + 1) % n] = 10;
+        graph[i][(i * 7 + 3) % n] = (int)(i % 9) + 1;
+        graph[i][i] = NO_EDGE;
+    }
+    vector<vector<long>> expected(n, vector<long>(n, INF));
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < n; j++) {
+            if (graph[i][j] != NO_EDGE) {
+                expected[i][j] = graph[i][j];
+            }
+        }
+        expected[i][i] = 0;
+    }
+    for (size_t k = 0; k < n; k++) {
+        for (size_t i = 0; i < n; i++) {
+            for (size_t j = 0; j < n; j++) {
+                expected[i][j] = std::min(expected[i][j], expected[i][k] + expected[k][j]);
+            }
+        }
+    }
+
+    g.loadGraph(graph);
+    table = Algorithms::allPairsShortestPaths(g);
+    bool sameDistances = true;
+    bool validPaths = true;
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < n; j++) {
+            sameDistances = sameDistances && table.distance(i, j) == expected[i][j];
+            vector<size_t> path = table.pathVertices(i, j);
+            long weight = 0;
+            for (size_t p = 0; p + 1 < path.size(); p++) {
+                weight += graph[path[p]][path[p + 1]];
+            }
+            validPaths = validPaths && path.front() == i && path.back() == j && weight == expected[i][j];
+        }
+    }
+    CHECK(sameDistances);
+    CHECK(validPaths);
+}
+
+/**
+ * @brief the old dijkstra (a binary heap of (distance, vertex) with duplicates) and the path from src to dest, in the format of shortestPath
+ */
+string referenceDijkstraPath(const Graph& g, size_t src, size_t dest) {
+    size_t n = g.getNumVertices();
+    vector<int> distances(n, INF);
+    vector<int> parents(n, -1);
+    std::priority_queue<std::pair<int, size_t>, vector<std::pair<int, size_t>>, std::greater<std::pair<int, size_t>>> pq;
+    distances[src] = 0;
+    pq.push({0, src});
+    while (!pq.empty()) {
+        size_t u = pq.top().second;
+        pq.pop();
+        for (auto [v, weight] : g.neighbors(u)) {
+            if (distances[u] + weight < distances[v]) {
+                distances[v] = distances[u] + weight;
+                parents[v] = (int)u;
+                pq.push({distances[v], v});
+            }
+        }
+    }
+    if (src == dest) {
+        return std::to_string(src);
+    }
+    if (distances[dest] == INF) {
+        return "-1";
+    }
+    string path = std::to_string(dest);
+    for (int parent = parents[dest]; parent != -1; parent = parents[(size_t)parent]) {
+        path.insert(0, std::to_string(parent) + "->");
+    }
+    return path;
+}
+
+TEST_CASE("Test shortestPath with small and large weights") {
+    // the small weights use Dial's buckets, the large weights use the lazy heap - both must give the same paths as the old dijkstra
+    // (also when there are many shortest paths, like in a grid with weights 1 and 2)
+    Graph g;
+    for (int maxWeight : {2, 9, 255, 100000}) {
+        size_t n = 400;
+        vector<Edge> edges;
+        for (size_t u = 0; u < n; u++) {
+            auto row = edges.end() - edges.begin();
+            for (size_t k = 1; k <= 4; k++) {
+                size_t v = (u * 37 + k * k * 101) % n;
+                if (v != u && std::none_of(edges.begin() + row, edges.end(), [v](const Edge& e) { return e.to == v; })) {
+                    edges.push_back({u, v, (int)((u * 131 + k * 17) % (size_t)maxWeight) + 1});
+                }
+            }
+        }
+        g.loadEdges(n, edges);
+
+        bool samePaths = true;
+        for (size_t src : {size_t{0}, size_t{17}, size_t{399}}) {
+            for (size_t dest = 0; dest < n; dest++) {
+                samePaths = samePaths && Algorithms::shortestPath(g, src, dest) == referenceDijkstraPath(g, src, dest);
+            }
+        }
+        CHECK(samePaths);
+    }
+
+    // a 20x20 grid, with weights 1 and 2 and with weights 50000 and 100000 (the same ties in the heap)
+    size_t side = 20;
+    for (int scale : {1, 50000}) {
+        vector<Edge> grid;
+        for (size_t r = 0; r < side; r++) {
+            for (size_t c = 0; c < side; c++) {
+                size_t u = r * side + c;
+                int weight = ((int)((r + c) % 2) + 1) * scale;
+                if (c + 1 < side) {
+                    grid.push_back({u, u + 1, weight});
+                    grid.push_back({u + 1, u, weight});
+                }
+                if (r + 1 < side) {
+                    grid.push_back({u, u + side, weight});
+                    grid.push_back({u + side, u, weight});
+                }
+            }
+        }
+        g.loadEdges(side * side, grid, Storage::DENSE);
+        bool samePaths = true;
+        for (size_t dest = 0; dest < side * side; dest++) {
+            samePaths = samePaths && Algorithms::shortestPath(g, 0, dest) == referenceDijkstraPath(g, 0, dest);
+        }
+        CHECK(samePaths);
+    }
+}
+
+/**
+ * @brief the length of a path in the format of shortestPath, -1 if one of its edges is not in the graph
+ */
+long pathLength(const Graph& g, const string& path) {
+    vector<size_t> vertices;
+    std::istringstream in(path);
+    size_t v = 0;
+    while (in >> v) {
+        vertices.push_back(v);
+        in.ignore(2);  // "->"
+    }
+    long length = 0;
+    for (size_t i = 1; i < vertices.size(); i++) {
+        int weight = g.getEdgeWeight(vertices[i - 1], vertices[i]);
+        if (weight == NO_EDGE) {
+            return -1;
+        }
+        length += weight;
+    }
+    return length;
+}
+
+TEST_CASE("Test shortestPath search modes") {
+    using Mode = Algorithms::SearchMode;
+    Graph g;
+
+    // early exit gives the same path as the full search, the bidirectional search gives a path with the same length
+    for (bool directed : {true, false}) {
+        for (int maxWeight : {1, 9, 100000}) {
+            size_t n = 300;
+            vector<Edge> edges;
+            for (size_t u = 0; u < n; u++) {
+                for (size_t k = 1; k <= 2; k++) {
+                    size_t v = (u * 53 + k * 97 + 11) % n;
+                    if (v != u && (directed || u < v)) {
+                        int weight = (int)((u * 7 + v * 13) % (size_t)maxWeight) + 1;
+                        edges.push_back({u, v, weight});
+                        if (!directed) {
+                            edges.push_back({v, u, weight});
+                        }
+                    }
+                }
+            }
+            g.loadEdges(n, edges);
+
+            bool sameEarlyExit = true;
+            bool sameLength = true;
+            for (size_t src : {size_t{0}, size_t{5}, size_t{150}}) {
+                for (size_t dest = 0; dest < n; dest++) {
+                    string full = Algorithms::shortestPath(g, src, dest, Mode::FULL);
+                    string bidirectional = Algorithms::shortestPath(g, src, dest, Mode::BIDIRECTIONAL);
+                    sameEarlyExit = sameEarlyExit && Algorithms::shortestPath(g, src, dest) == full;
+                    bool sameEnds = bidirectional.rfind(std::to_string(src), 0) == 0 &&
+                                    bidirectional.substr(bidirectional.rfind('>') + 1) == std::to_string(dest);
+                    sameLength = sameLength && (full == "-1" ? bidirectional == "-1" : sameEnds && pathLength(g, bidirectional) == pathLength(g, full));
+                }
+            }
+            CHECK(sameEarlyExit);
+            CHECK(sameLength);
+        }
+    }
+
+    // a path where the two searches meet in the middle, and a vertex that can't be reached
+    vector<vector<int>> chain = {
+        {0, 1, 0, 0, 0, 0},
+        {0, 0, 1, 0, 0, 0},
+        {0, 0, 0, 1, 0, 0},
+        {0, 0, 0, 0, 1, 0},
+        {0, 0, 0, 0, 0, 0},
+        {1, 0, 0, 0, 0, 0}};
+    for (Storage storage : {Storage::DENSE, Storage::SPARSE, Storage::BITSET}) {
+        g.loadGraph(chain, storage);
+        for (Mode mode : {Mode::FULL, Mode::EARLY_EXIT, Mode::BIDIRECTIONAL}) {
+            CHECK(Algorithms::shortestPath(g, 0, 4, mode) == "0->1->2->3->4");
+            CHECK(Algorithms::shortestPath(g, 5, 3, mode) == "5->0->1->2->3");
+            CHECK(Algorithms::shortestPath(g, 4, 0, mode) == "-1");
+            CHECK(Algorithms::shortestPath(g, 2, 2, mode) == "2");
+        }
+    }
+    chain[1][2] = 5;
+    chain[3][4] = 2;
+    g.loadGraph(chain);
+    CHECK(Algorithms::shortestPath(g, 5, 4, Mode::BIDIRECTIONAL) == "5->0->1->2->3->4");
+    CHECK(Algorithms::shortestPath(g, 3, 5, Mode::BIDIRECTIONAL) == "-1");
+
+    // negative weights always use Bellman-Ford
+    chain[2][3] = -3;
+    g.loadGraph(chain);
+    CHECK(Algorithms::shortestPath(g, 0, 4, Mode::BIDIRECTIONAL) == "0->1->2->3->4");
+}
+
+TEST_CASE("Test aStar") {
+    // a 30x30 grid, the point of the vertex r * 30 + c is (c, r) and the weights are in [1, 4] (at least the length of the edge)
+    size_t side = 30;
+    vector<Algorithms::Point> points;
+    vector<Edge> edges;
+    for (size_t r = 0; r < side; r++) {
+        for (size_t c = 0; c < side; c++) {
+            size_t u = r * side + c;
+            points.push_back({(double)c, (double)r});
+            for (size_t v : {c + 1 < side ? u + 1 : u, r + 1 < side ? u + side : u}) {
+                if (v != u && (u * 7 + v) % 11 != 0) {  // a few edges are missing
+                    int weight = (int)((u * 31 + v * 17) % 4) + 1;
+                    edges.push_back({u, v, weight});
+                    edges.push_back({v, u, weight});
+                }
+            }
+        }
+    }
+    Graph g;
+    g.loadEdges(side * side, edges);
+
+    Algorithms::Heuristic zero = [](size_t, size_t) { return 0; };
+    Algorithms::Heuristic euclidean = Algorithms::euclideanHeuristic(points);
+    Algorithms::Heuristic manhattan = Algorithms::manhattanHeuristic(points);
+    CHECK(euclidean(0, side * side - 1) == 41);
+    CHECK(manhattan(0, side * side - 1) == 58);
+
+    bool sameAsDijkstra = true;
+    bool sameLength = true;
+    for (size_t src : {size_t{0}, size_t{445}}) {
+        for (size_t dest = 0; dest < side * side; dest++) {
+            string dijkstraPath = Algorithms::shortestPath(g, src, dest);
+            sameAsDijkstra = sameAsDijkstra && Algorithms::aStar(g, src, dest, zero) == dijkstraPath;  // a zero heuristic is Dijkstra
+            for (const Algorithms::Heuristic* heuristic : {&euclidean, &manhattan}) {
+                string path = Algorithms::aStar(g, src, dest, *heuristic);
+                sameLength = sameLength && path.rfind(std::to_string(src), 0) == 0 && pathLength(g, path) == pathLength(g, dijkstraPath);
+            }
+        }
+    }
+    CHECK(sameAsDijkstra);
+    CHECK(sameLength);
+
+    // unweighted, unreachable and errors
+    vector<vector<int>> graph = {
+        {0, 1, 0, 0},
+        {1, 0, 1, 0},
+        {0, 1, 0, 0},
+        {0, 0, 0, 0}};
+    vector<Algorithms::Point> line = {{0, 0}, {1, 0}, {2, 0}, {3, 0}};
+    for (Storage storage : {Storage::DENSE, Storage::SPARSE, Storage::BITSET}) {
+        g.loadGraph(graph, storage);
+        CHECK(Algorithms::aStar(g, 0, 2, Algorithms::euclideanHeuristic(line)) == "0->1->2");
+        CHECK(Algorithms::aStar(g, 1, 1, Algorithms::euclideanHeuristic(line)) == "1");
+        CHECK(Algorithms::aStar(g, 0, 3, Algorithms::euclideanHeuristic(line)) == "-1");
+    }
+    CHECK_THROWS_AS(Algorithms::aStar(g, 0, 4, zero), std::invalid_argument);
+    graph[0][1] = -1;
+    g.loadGraph(graph);
+    CHECK_THROWS_AS(Algorithms::aStar(g, 0, 2, zero), std::invalid_argument);
+}
+
+TEST_CASE("Test shortestPath and negativeCycle with a few negative edges") {
+    // a random graph with positive edges in both directions and a few negative edges from a small vertex to a bigger one,
+    // so every cycle has a positive edge of at least 50 and a negative edge of at most -9 - there are no negative cycles
+    size_t n = 300;
+    vector<Edge> edges;
+    for (size_t u = 0; u < n; u++) {
+        for (size_t k = 1; k <= 3; k++) {
+            size_t v = (u * 71 + k * 29 + 3) % n;
+            if (v != u && std::none_of(edges.begin(), edges.end(), [u, v](const Edge& e) { return e.from == u && e.to == v; })) {
+                int weight = u < v && (u + k) % 7 == 0 ? -(int)((u + v) % 9) - 1 : (int)((u * 3 + v) % 50) + 50;
+                edges.push_back({u, v, weight});
+            }
+        }
+    }
+    Graph g;
+    g.loadEdges(n, edges);
+    CHECK(g.isHaveNegativeEdgeWeight());
+
+    // the distances of Bellman-Ford in rounds over all the edges
+    vector<long> distances(n, INF);
+    distances[0] = 0;
+    for (size_t round = 0; round + 1 < n; round++) {
+        for (const Edge& e : edges) {
+            if (distances[e.from] != INF && distances[e.from] + e.weight < distances[e.to]) {
+                distances[e.to] = distances[e.from] + e.weight;
+            }
+        }
+    }
+    bool sameDistances = true;
+    for (size_t dest = 1; dest < n; dest++) {
+        string path = Algorithms::shortestPath(g, 0, dest);
+        sameDistances = sameDistances && (distances[dest] == INF ? path == "-1" : pathLength(g, path) == distances[dest]);
+    }
+    CHECK(sameDistances);
+    CHECK(Algorithms::negativeCycle(g) == "No negative cycle");
+
+    // a negative cycle at the end of a long chain
+    vector<Edge> chain;
+    for (size_t u = 0; u + 1 < n; u++) {
+        chain.push_back({u, u + 1, 1});
+    }
+    chain.push_back({n - 1, n - 4, -5});
+    g.loadEdges(n, chain);
+    std::ostringstream cycle;
+    cycle << n - 4 << "->" << n - 3 << "->" << n - 2 << "->" << n - 1 << "->" << n - 4;
+    CHECK(Algorithms::negativeCycle(g) == cycle.str());
+    CHECK(Algorithms::shortestPath(g, 0, n - 1) == "Graph contains a negative-weight cycle");
+}
+
+TEST_CASE("Test shortestPath with Johnson's potentials") {
+    Graph g;
+    vector<vector<int>> graph = {
+        // clang-format off
+        {NO_EDGE, 4,       2,       NO_EDGE, NO_EDGE},
+        {NO_EDGE, NO_EDGE, NO_EDGE, 2,       NO_EDGE},
+        {NO_EDGE, -1,      NO_EDGE, 6,       NO_EDGE},
+        {NO_EDGE, NO_EDGE, NO_EDGE, NO_EDGE, -3     },
+        {NO_EDGE, NO_EDGE, NO_EDGE, NO_EDGE, NO_EDGE}
+        // clang-format on
+    };
+    g.loadGraph(graph);
+    CHECK(g.getPotentials() == nullptr);
+
+    // the first query computes the potentials, the next queries use them
+    CHECK(Algorithms::shortestPath(g, 0, 4) == "0->2->1->3->4");
+    std::shared_ptr<const vector<int>> potentials = g.getPotentials();
+    CHECK((potentials != nullptr && potentials->size() == 5));
+    CHECK(Algorithms::shortestPath(g, 2, 4) == "2->1->3->4");
+    CHECK(Algorithms::shortestPath(g, 0, 3, Algorithms::SearchMode::FULL) == "0->2->1->3");
+    CHECK(Algorithms::shortestPath(g, 4, 0) == "-1");
+    CHECK(Algorithms::negativeCycle(g) == "No negative cycle");
+    CHECK(g.getPotentials() == potentials);
+
+    // a change of the graph drops the potentials
+    g.setEdge(1, 3, 10);
+    CHECK(g.getPotentials() == nullptr);
+    CHECK(Algorithms::shortestPath(g, 0, 4) == "0->2->3->4");
+
+    // a negative cycle that 3 can't reach - the paths from 3 are still defined
+    g.setEdge(1, 0, -2);
+    CHECK(Algorithms::negativeCycle(g) == "0->2->1->0");
+    CHECK((g.getPotentials() != nullptr && g.getPotentials()->empty()));
+    CHECK(Algorithms::shortestPath(g, 3, 4) == "3->4");
+    CHECK(Algorithms::shortestPath(g, 0, 4) == "Graph contains a negative-weight cycle");
+}
+
+TEST_CASE("Test concurrent queries on one graph") {
+    // the queries on a const graph read and set the cached potentials from all the threads at once
+    vector<vector<int>> graph = {
+        // clang-format off
+        {NO_EDGE, 4,       2,       NO_EDGE, NO_EDGE},
+        {NO_EDGE, NO_EDGE, NO_EDGE, 2,       NO_EDGE},
+        {NO_EDGE, -1,      NO_EDGE, 6,       NO_EDGE},
+        {NO_EDGE, NO_EDGE, NO_EDGE, NO_EDGE, -3     },
+        {NO_EDGE, NO_EDGE, NO_EDGE, NO_EDGE, NO_EDGE}
+        // clang-format on
+    };
+    vector<vector<int>> cycle = graph;
+    cycle[1][0] = -2;  // the negative cycle 0->2->1->0
+
+    for (size_t round = 0; round < 50; round++) {
+        Graph g;
+        Graph withCycle;
+        g.loadGraph(graph);
+        withCycle.loadGraph(cycle);
+        const Graph& reader = g;
+        const Graph& cycleReader = withCycle;
+
+        vector<size_t> wrong(4, 0);
+        vector<std::thread> threads;
+        for (size_t t = 0; t < wrong.size(); t++) {
+            threads.emplace_back([&reader, &cycleReader, &wrong, t]() {
+                for (size_t i = 0; i < 20; i++) {
+                    wrong[t] += (size_t)(Algorithms::shortestPath(reader, 0, 4) != "0->2->1->3->4");
+                    wrong[t] += (size_t)(Algorithms::negativeCycle(reader) != "No negative cycle");
+                    wrong[t] += (size_t)(Algorithms::negativeCycle(cycleReader) != "0->2->1->0");
+                    wrong[t] += (size_t)(Algorithms::shortestPath(cycleReader, 3, 4) != "3->4");
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        CHECK(std::count(wrong.begin(), wrong.end(), 0) == (std::ptrdiff_t)wrong.size());
+        CHECK((g.getPotentials() != nullptr && g.getPotentials()->size() == 5));
+        CHECK((withCycle.getPotentials() != nullptr && withCycle.getPotentials()->empty()));
+    }
+}
+
+// the shortest unweighted path from src to dest where the parent of every vertex is its smallest in neighbor in the previous level
+string referenceBfsPath(const Graph& g, size_t src, size_t dest) {
+    vector<int> distances(g.getNumVertices(), INF);
+    std::queue<size_t> q;
+    distances[src] = 0;
+    q.push(src);
+    while (!q.empty()) {
+        size_t u = q.front();
+        q.pop();
+        for (Neighbor neighbor : g.neighbors(u)) {
+            if (distances[neighbor.vertex] == INF) {
+                distances[neighbor.vertex] = distances[u] + 1;
+                q.push(neighbor.vertex);
+            }
+        }
+    }
+    if (distances[dest] == INF) {
+        return "-1";
+    }
+    string path = std::to_string(dest);
+    for (size_t v = dest; v != src;) {
+        for (Neighbor neighbor : g.inNeighbors(v)) {
+            if (distances[neighbor.vertex] == distances[v] - 1) {
+                v = neighbor.vertex;
+                break;
+            }
+        }
+        path = std::to_string(v) + "->" + path;
+    }
+    return path;
+}
+
+TEST_CASE("Test level synchronous BFS") {
+    Graph g;
+
+    // two paths of the same length to 5 - the parent of a vertex is the smallest vertex of the previous level (3 and not 4)
+    vector<vector<int>> graph = {
+        // clang-format off
+        {0, 1, 1, 0, 0, 0},
+        {0, 0, 0, 0, 1, 0},
+        {0, 0, 0, 1, 0, 0},
+        {0, 0, 0, 0, 0, 1},
+        {0, 0, 0, 0, 0, 1},
+        {0, 0, 0, 0, 0, 0}
+        // clang-format on
+    };
+    for (Storage storage : {Storage::DENSE, Storage::SPARSE, Storage::BITSET}) {
+        g.loadGraph(graph, storage);
+        CHECK(Algorithms::shortestPath(g, 0, 5) == "0->2->3->5");
+        CHECK(Algorithms::shortestPath(g, 0, 5, Algorithms::SearchMode::FULL) == "0->2->3->5");
+        CHECK(Algorithms::isConnected(g) == true);
+        CHECK(Algorithms::isBipartite(g) == "The graph is bipartite: A={0,3,4}, B={1,2,5}");
+    }
+
+    // a grid is bipartite (the color of (r, c) is the parity of r + c)
+    size_t side = 200;
+    size_t n = side * side;
+    vector<Edge> edges;
+    for (size_t r = 0; r < side; r++) {
+        for (size_t c = 0; c < side; c++) {
+            size_t u = r * side + c;
+            if (c + 1 < side) {
+                edges.push_back({u, u + 1, 1});
+                edges.push_back({u + 1, u, 1});
+            }
+            if (r + 1 < side) {
+                edges.push_back({u, u + side, 1});
+                edges.push_back({u + side, u, 1});
+            }
+        }
+    }
+    g.loadEdges(n, edges, Storage::SPARSE);
+    CHECK(Algorithms::isConnected(g) == true);
+    string corner = Algorithms::shortestPath(g, 0, n - 1);
+    CHECK(pathLength(g, corner) == (long)(2 * side - 2));
+    CHECK(corner.rfind("0->1->2->", 0) == 0);  // the smallest parents first go along the first row
+    string expected = "The graph is bipartite: A={0,2,4,";
+    CHECK(Algorithms::isBipartite(g).rfind(expected, 0) == 0);
+
+    // an edge inside a level, and a vertex that can't be reached
+    edges.push_back({0, side + 1, 1});
+    edges.push_back({side + 1, 0, 1});
+    g.loadEdges(n, edges, Storage::SPARSE);
+    CHECK(Algorithms::isBipartite(g) == "The graph is not bipartite");
+    CHECK(Algorithms::shortestPath(g, 0, side + 1) == "0->" + std::to_string(side + 1));
+    g.loadEdges(n + 1, edges, Storage::SPARSE);
+    CHECK(Algorithms::isConnected(g) == false);
+    CHECK(Algorithms::shortestPath(g, 0, n) == "-1");
+
+    // one direction of the grid - every vertex is reached from 0, but 0 is not reached from any vertex
+    vector<Edge> forward;
+    for (const Edge& e : edges) {
+        if (e.from < e.to) {
+            forward.push_back(e);
+        }
+    }
+    g.loadEdges(n, forward, Storage::SPARSE);
+    CHECK(Algorithms::isConnected(g) == true);
+    CHECK(Algorithms::shortestPath(g, n - 1, 0) == "-1");
+    g.loadEdges(n + 1, forward, Storage::SPARSE);
+    CHECK(Algorithms::isConnected(g) == false);
+
+    // a random graph with a small diameter - the big levels are bottom-up
+    for (bool directed : {true, false}) {
+        n = 20000;
+        edges.clear();
+        for (size_t u = 0; u < n; u++) {
+            for (size_t k = 1; k <= 3; k++) {
+                size_t v = (u * 7919 + k * 104729) % n;
+                if (v != u && (directed || u < v)) {
+                    edges.push_back({u, v, 1});
+                    if (!directed) {
+                        edges.push_back({v, u, 1});
+                    }
+                }
+            }
+        }
+        g.loadEdges(n, edges, Storage::SPARSE);
+        bool same = true;
+        for (size_t dest = 0; dest < n; dest += 97) {
+            same = same && Algorithms::shortestPath(g, 3, dest) == referenceBfsPath(g, 3, dest);
+        }
+        CHECK(same);
+    }
+}
+
+TEST_CASE("Test stronglyConnectedComponents") {
+    Graph g;
+
+    // {0, 1, 2} -> {3, 4} -> {5}, and {0, 1, 2} -> {5}
+    vector<vector<int>> graph = {
+        // clang-format off
+        {0, 1, 0, 0, 0, 0},
+        {0, 0, 1, 1, 0, 0},
+        {1, 0, 0, 0, 0, 1},
+        {0, 0, 0, 0, 1, 0},
+        {0, 0, 0, 1, 0, 1},
+        {0, 0, 0, 0, 0, 0}
+        // clang-format on
+    };
+    for (Storage storage : {Storage::DENSE, Storage::SPARSE, Storage::BITSET}) {
+        g.loadGraph(graph, storage);
+        Algorithms::Components components = Algorithms::stronglyConnectedComponents(g);
+        CHECK(components.count() == 3);
+        CHECK(components.component == vector<size_t>{0, 0, 0, 1, 1, 2});
+        CHECK(components.sizes == vector<size_t>{3, 2, 1});
+        CHECK(components.condensation.offsets == vector<size_t>{0, 2, 3, 3});
+        CHECK(components.condensation.targets == vector<size_t>{1, 2, 2});
+        CHECK(components.condensation.weights == vector<int>{1, 1, 1});
+        CHECK(Algorithms::isConnected(g) == true);
+    }
+
+    // two sources - 6 reaches {3, 4} and {5}, but not {0, 1, 2}
+    vector<Edge> edges = {{0, 1, 1}, {1, 2, 1}, {1, 3, 1}, {2, 0, 1}, {2, 5, 1}, {3, 4, 1}, {4, 3, 1}, {4, 5, 1}, {6, 3, 1}, {6, 4, 1}};
+    g.loadEdges(7, edges);
+    Algorithms::Components components = Algorithms::stronglyConnectedComponents(g);
+    CHECK(components.count() == 4);
+    CHECK(components.component[6] < components.component[3]);
+    CHECK(components.condensation.weights[components.condensation.offsets[components.component[6]]] == 2);  // 6->3 and 6->4
+    CHECK(Algorithms::isConnected(g) == false);
+
+    // an undirected graph - the connected components, no edges between them
+    g.loadEdges(5, {{0, 1, 1}, {1, 0, 1}, {3, 4, 1}, {4, 3, 1}});
+    components = Algorithms::stronglyConnectedComponents(g);
+    CHECK(components.count() == 3);
+    CHECK(components.component[0] == components.component[1]);
+    CHECK(components.component[3] == components.component[4]);
+    CHECK(components.condensation.targets.empty());
+
+    // a path of 200000 vertices is one DFS path (no recursion). with an edge back to 0 it is one component
+    size_t n = 200000;
+    edges.clear();
+    for (size_t v = 0; v + 1 < n; v++) {
+        edges.push_back({v, v + 1, 1});
+    }
+    g.loadEdges(n, edges, Storage::SPARSE);
+    components = Algorithms::stronglyConnectedComponents(g);
+    CHECK(components.count() == n);
+    CHECK((components.component[0] == 0 && components.component[n - 1] == n - 1));
+    CHECK(Algorithms::isConnected(g) == true);
+    edges.push_back({n - 1, 0, 1});
+    g.loadEdges(n, edges, Storage::SPARSE);
+    components = Algorithms::stronglyConnectedComponents(g);
+    CHECK(components.count() == 1);
+    CHECK(components.sizes[0] == n);
+
+    Graph empty;
+    CHECK(Algorithms::stronglyConnectedComponents(empty).count() == 0);
+}
+
+TEST_CASE("Test connectedComponents") {
+    Graph g;
+
+    // {0, 2}, {1, 3, 4}, {5}
+    vector<vector<int>> graph = {
+        // clang-format off
+        {0, 0, 1, 0, 0, 0},
+        {0, 0, 0, 1, 0, 0},
+        {1, 0, 0, 0, 0, 0},
+        {0, 1, 0, 0, 1, 0},
+        {0, 0, 0, 1, 0, 0},
+        {0, 0, 0, 0, 0, 0}
+        // clang-format on
+    };
+    for (Storage storage : {Storage::DENSE, Storage::SPARSE, Storage::BITSET}) {
+        g.loadGraph(graph, storage);
+        Algorithms::Components components = Algorithms::connectedComponents(g);
+        CHECK(components.component == vector<size_t>{0, 1, 0, 1, 1, 2});
+        CHECK(components.sizes == vector<size_t>{2, 3, 1});
+        CHECK(components.condensation.targets.empty());
+        CHECK(Algorithms::isConnected(g) == false);
+    }
+
+    // in a directed graph the direction is ignored: 0 and 1 are in the same component, but not strongly connected
+    g.loadEdges(3, {{1, 0, 1}, {2, 1, 1}});
+    CHECK(Algorithms::connectedComponents(g).count() == 1);
+    CHECK(Algorithms::stronglyConnectedComponents(g).count() == 3);
+
+    // in an undirected graph the connected components are the strongly connected components
+    size_t n = 20000;
+    vector<Edge> edges;
+    for (size_t u = 0; u < n; u += 2) {
+        size_t v = (u * 7919 + 104729) % n;
+        if (v != u && v % 2 == 0) {
+            edges.push_back({u, v, 1});
+            edges.push_back({v, u, 1});
+        }
+    }
+    std::sort(edges.begin(), edges.end(), [](const Edge& a, const Edge& b) { return a.from < b.from || (a.from == b.from && a.to < b.to); });
+    edges.erase(std::unique(edges.begin(), edges.end(), [](const Edge& a, const Edge& b) { return a.from == b.from && a.to == b.to; }), edges.end());
+    g.loadEdges(n, edges, Storage::SPARSE);
+    Algorithms::Components components = Algorithms::connectedComponents(g);
+    Algorithms::Components strong = Algorithms::stronglyConnectedComponents(g);
+    CHECK(components.count() == strong.count());
+    bool same = true;
+    for (size_t u = 0; u < n; u++) {
+        for (Neighbor neighbor : g.neighbors(u)) {
+            same = same && components.component[u] == components.component[neighbor.vertex];
+        }
+        same = same && components.component[u] <= u;  // the components are numbered by their smallest vertex
+    }
+    CHECK(same);
+}
+
+TEST_CASE("Test IncrementalComponents") {
+    Algorithms::IncrementalComponents components(6);
+    CHECK(components.count() == 6);
+    CHECK(components.connected(0, 0) == true);
+    CHECK(components.connected(0, 1) == false);
+
+    components.addEdges({{0, 1, 1}, {2, 3, 1}, {1, 0, 1}});
+    CHECK(components.count() == 4);
+    CHECK(components.connected(1, 0) == true);
+    CHECK(components.connected(1, 2) == false);
+
+    components.addEdges({{5, 3, 1}, {1, 3, 1}});
+    CHECK(components.count() == 2);
+    CHECK(components.connected(0, 5) == true);
+    CHECK(components.components().component == vector<size_t>{0, 0, 0, 0, 1, 0});
+    CHECK(components.components().sizes == vector<size_t>{5, 1});
+
+    // a batch with a vertex that is not in the graph adds nothing
+    bool thrown = false;
+    try {
+        components.addEdges({{4, 0, 1}, {4, 6, 1}});
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    CHECK(thrown);
+    CHECK(components.count() == 2);
+    CHECK(components.connected(4, 0) == false);
+
+    // start from a graph, then add a big batch
+    Graph g;
+    size_t n = 100000;
+    vector<Edge> edges;
+    for (size_t v = 0; v + 2 < n; v += 2) {
+        edges.push_back({v, v + 2, 1});  // the even vertices
+    }
+    g.loadEdges(n, edges, Storage::SPARSE);
+    Algorithms::IncrementalComponents chain(g);
+    CHECK(chain.count() == n / 2 + 1);
+    edges.clear();
+    for (size_t v = 1; v + 2 < n; v += 2) {
+        edges.push_back({v + 2, v, 1});  // the odd vertices
+    }
+    chain.addEdges(edges);
+    CHECK(chain.count() == 2);
+    chain.addEdges({{n - 1, 0, 1}});
+    CHECK(chain.count() == 1);
+    CHECK(chain.components().sizes == vector<size_t>{n});
+}
+
+// true if the vertices are a cycle of the graph: v1, ..., v1 with an edge between every two vertices
+bool isCycleOf(const Graph& g, const vector<size_t>& cycle) {
+    if (cycle.size() < 3 || cycle.front() != cycle.back()) {
+        return false;
+    }
+    for (size_t i = 1; i < cycle.size(); i++) {
+        if (g.getEdgeWeight(cycle[i - 1], cycle[i]) == NO_EDGE) {
+            return false;
+        }
+    }
+    return true;
+}
+
+TEST_CASE("Test findCycle on deep graphs") {
+    Graph g;
+
+    // a path of 200000 vertices is one DFS path - the old recursive DFS overflowed the stack
+    size_t n = 200000;
+    vector<Edge> edges;
+    for (size_t v = 0; v + 1 < n; v++) {
+        edges.push_back({v, v + 1, 1});
+    }
+    g.loadEdges(n, edges, Storage::SPARSE);
+    CHECK(Algorithms::isContainsCycle(g) == "-1");
+    CHECK(Algorithms::findCycleParallel(g).empty());
+    edges.push_back({n - 1, 0, 1});
+    g.loadEdges(n, edges, Storage::SPARSE);
+    vector<size_t> cycle = Algorithms::findCycle(g);
+    CHECK(cycle.size() == n + 1);
+    CHECK(isCycleOf(g, cycle));
+    CHECK(Algorithms::findCycleParallel(g) == cycle);
+
+    // the same path in an undirected graph
+    edges.pop_back();
+    for (size_t v = 0; v + 1 < n; v++) {
+        edges.push_back({v + 1, v, 1});
+    }
+    g.loadEdges(n, edges, Storage::SPARSE);
+    CHECK(Algorithms::findCycle(g).empty());
+    edges.push_back({n - 1, 0, 1});
+    edges.push_back({0, n - 1, 1});
+    g.loadEdges(n, edges, Storage::SPARSE);
+    CHECK(isCycleOf(g, Algorithms::findCycle(g)));
+
+    // a random DAG - the edges go from a smaller position to a bigger one in a shuffled order of the vertices
+    n = 50000;
+    vector<size_t> order(n);
+    for (size_t i = 0; i < n; i++) {
+        order[i] = (i * 7919) % n;  // 7919 is a prime that doesn't divide n
+    }
+    edges.clear();
+    for (size_t i = 0; i + 1 < n; i++) {
+        edges.push_back({order[i], order[i + 1], 1});  // the order itself is a path, so the edge back below closes a cycle
+        for (size_t k = 1; k <= 3; k++) {
+            size_t j = i + 2 + (i * 31 + k * 17) % 1000;
+            if (j < n) {
+                edges.push_back({order[i], order[j], 1});
+            }
+        }
+    }
+    std::sort(edges.begin(), edges.end(), [](const Edge& a, const Edge& b) { return a.from < b.from || (a.from == b.from && a.to < b.to); });
+    edges.erase(std::unique(edges.begin(), edges.end(), [](const Edge& a, const Edge& b) { return a.from == b.from && a.to == b.to; }), edges.end());
+    g.loadEdges(n, edges, Storage::SPARSE);
+    CHECK(Algorithms::findCycle(g).empty());
+    CHECK(Algorithms::findCycleParallel(g).empty());
+
+    // one edge back from the end of the order to its start closes a cycle
+    edges.push_back({order[n - 1], order[0], 1});
+    g.loadEdges(n, edges, Storage::SPARSE);
+    CHECK(isCycleOf(g, Algorithms::findCycle(g)));
+    CHECK(isCycleOf(g, Algorithms::findCycleParallel(g)));
+
+    // a deep bitset graph
+    n = 5000;
+    vector<vector<int>> chain(n, vector<int>(n, NO_EDGE));
+    for (size_t v = 0; v + 1 < n; v++) {
+        chain[v][v + 1] = 1;
+    }
+    g.loadGraph(chain, Storage::BITSET);
+    CHECK(Algorithms::findCycle(g).empty());
+    chain[n - 1][0] = 1;
+    g.loadGraph(chain, Storage::BITSET);
+    CHECK(Algorithms::findCycleParallel(g).size() == n + 1);
+}
+
+TEST_CASE("Test structured results") {
+    Graph g;
+
+    /*
+    0 --2--> 1 --3--> 2
+    |                 ^
+    +--------9--------+
+    */
+    vector<vector<int>> weighted = {
+        // clang-format off
+        {NO_EDGE, 2,       9      },
+        {NO_EDGE, NO_EDGE, 3      },
+        {NO_EDGE, NO_EDGE, NO_EDGE}
+        // clang-format on
+    };
+    g.loadGraph(weighted);
+    Algorithms::Path path = Algorithms::findShortestPath(g, 0, 2);
+    CHECK(path.exists());
+    CHECK(path.vertices == vector<size_t>{0, 1, 2});
+    CHECK(path.length == 5);
+    path = Algorithms::findShortestPath(g, 1, 1);
+    CHECK((path.vertices == vector<size_t>{1} && path.length == 0));
+    path = Algorithms::findShortestPath(g, 2, 0);
+    CHECK((!path.exists() && path.length == INF));
+    CHECK(Algorithms::findShortestPathAStar(g, 0, 2, [](size_t, size_t) { return 0; }).vertices == vector<size_t>{0, 1, 2});
+    CHECK(Algorithms::findShortestPathAStar(g, 0, 2, [](size_t, size_t) { return 0; }).length == 5);
+
+    // the string functions format the same results
+    for (size_t src = 0; src < 3; src++) {
+        for (size_t dest = 0; dest < 3; dest++) {
+            path = Algorithms::findShortestPath(g, src, dest);
+            string expected = "-1";
+            for (size_t i = 0; i < path.vertices.size(); i++) {
+                expected = (i == 0 ? "" : expected + "->") + std::to_string(path.vertices[i]);
+            }
+            CHECK(Algorithms::shortestPath(g, src, dest) == expected);
+        }
+    }
+
+    // a negative cycle is an exception, and shortestPath returns its message
+    vector<vector<int>> negative = {
+        // clang-format off
+        {NO_EDGE, -1,      NO_EDGE},
+        {NO_EDGE, NO_EDGE, -1     },
+        {1,       NO_EDGE, NO_EDGE}
+        // clang-format on
+    };
+    g.loadGraph(negative);
+    bool thrown = false;
+    try {
+        Algorithms::findShortestPath(g, 0, 2);
+    } catch (const Algorithms::NegativeCycleException& e) {
+        thrown = true;
+        CHECK(e.cycle == vector<size_t>{0, 1, 2, 0});
+    }
+    CHECK(thrown);
+    CHECK(Algorithms::shortestPath(g, 0, 2) == "Graph contains a negative-weight cycle");
+    CHECK(Algorithms::findNegativeCycle(g) == vector<size_t>{0, 1, 2, 0});
+    g.loadGraph(weighted);
+    CHECK(Algorithms::findNegativeCycle(g).empty());
+
+    // the sets of a bipartite graph, in increasing order
+    vector<vector<int>> square = {
+        // clang-format off
+        {NO_EDGE, 1,       NO_EDGE, 1      },
+        {1,       NO_EDGE, 1,       NO_EDGE},
+        {NO_EDGE, 1,       NO_EDGE, 1      },
+        {1,       NO_EDGE, 1,       NO_EDGE}
+        // clang-format on
+    };
+    for (Storage storage : {Storage::DENSE, Storage::SPARSE, Storage::BITSET}) {
+        g.loadGraph(square, storage);
+        Algorithms::Bipartition sets = Algorithms::findBipartition(g);
+        CHECK(sets.bipartite);
+        CHECK(sets.setA == vector<size_t>{0, 2});
+        CHECK(sets.setB == vector<size_t>{1, 3});
+        CHECK(Algorithms::isBipartite(g) == "The graph is bipartite: A={0,2}, B={1,3}");
+    }
+    square[0][2] = 1;
+    square[2][0] = 1;
+    g.loadGraph(square);
+    Algorithms::Bipartition sets = Algorithms::findBipartition(g);
+    CHECK((!sets.bipartite && sets.setA.empty() && sets.setB.empty()));
+    g.loadGraph(vector<vector<int>>{});
+    CHECK(Algorithms::findBipartition(g).bipartite);
+
+    // a path of 200000 vertices - the path and its string are built in O(path length)
+    size_t n = 200000;
+    vector<Edge> edges;
+    for (size_t v = 0; v + 1 < n; v++) {
+        edges.push_back({v, v + 1, 1});
+    }
+    g.loadEdges(n, edges, Storage::SPARSE);
+    path = Algorithms::findShortestPath(g, 0, n - 1);
+    CHECK(path.vertices.size() == n);
+    CHECK(path.length == (int)n - 1);
+    string text = Algorithms::shortestPath(g, 0, n - 1);
+    CHECK((size_t)std::count(text.begin(), text.end(), '>') == n - 1);
+    CHECK(text.substr(text.size() - 14) == "199998->199999");
+}